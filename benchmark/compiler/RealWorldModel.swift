@@ -0,0 +1,157 @@
+//===--- RealWorldModel.swift ---------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// The model layer of a typical app: value types decoded from loosely typed
+// data, protocol extensions, closures and collection transformations.
+
+public enum JSON {
+  case null
+  case bool(Bool)
+  case number(Double)
+  case string(String)
+  case array([JSON])
+  case object([String: JSON])
+
+  public subscript(key: String) -> JSON? {
+    if case .object(let dict) = self {
+      return dict[key]
+    }
+    return nil
+  }
+
+  public var stringValue: String? {
+    if case .string(let s) = self { return s }
+    return nil
+  }
+
+  public var doubleValue: Double? {
+    if case .number(let n) = self { return n }
+    return nil
+  }
+
+  public var arrayValue: [JSON] {
+    if case .array(let a) = self { return a }
+    return []
+  }
+}
+
+public enum DecodingError : Error {
+  case missingKey(String)
+  case typeMismatch(String)
+}
+
+public protocol Decodable {
+  init(json: JSON) throws
+}
+
+extension Decodable {
+  public static func decodeArray(_ json: JSON) throws -> [Self] {
+    return try json.arrayValue.map { try Self(json: $0) }
+  }
+}
+
+func require<T>(_ json: JSON, _ key: String,
+                _ transform: (JSON) -> T?) throws -> T {
+  guard let value = json[key] else {
+    throw DecodingError.missingKey(key)
+  }
+  guard let result = transform(value) else {
+    throw DecodingError.typeMismatch(key)
+  }
+  return result
+}
+
+public struct Address : Decodable {
+  public var street: String
+  public var city: String
+  public var zip: String?
+
+  public init(json: JSON) throws {
+    street = try require(json, "street") { $0.stringValue }
+    city = try require(json, "city") { $0.stringValue }
+    zip = json["zip"]?.stringValue
+  }
+}
+
+public struct LineItem : Decodable {
+  public var sku: String
+  public var quantity: Int
+  public var unitPrice: Double
+
+  public var total: Double { return Double(quantity) * unitPrice }
+
+  public init(json: JSON) throws {
+    sku = try require(json, "sku") { $0.stringValue }
+    quantity = try require(json, "quantity") { $0.doubleValue.map { Int($0) } }
+    unitPrice = try require(json, "unit_price") { $0.doubleValue }
+  }
+}
+
+public struct Order : Decodable {
+  public enum Status : String {
+    case pending, shipped, delivered, cancelled
+  }
+
+  public var id: String
+  public var status: Status
+  public var items: [LineItem]
+  public var shippingAddress: Address
+  public var notes: [String]
+
+  public init(json: JSON) throws {
+    id = try require(json, "id") { $0.stringValue }
+    status = try require(json, "status") {
+      $0.stringValue.flatMap { Status(rawValue: $0) }
+    }
+    items = try LineItem.decodeArray(json["items"] ?? .array([]))
+    shippingAddress = try Address(json: json["shipping_address"] ?? .null)
+    notes = (json["notes"]?.arrayValue ?? []).flatMap { $0.stringValue }
+  }
+
+  public var subtotal: Double {
+    return items.reduce(0) { $0 + $1.total }
+  }
+
+  public func tax(rate: Double) -> Double {
+    return (subtotal * rate * 100).rounded() / 100
+  }
+}
+
+public struct OrderSummary {
+  public var countByStatus: [Order.Status: Int] = [:]
+  public var revenue = 0.0
+  public var topSKUs: [(sku: String, quantity: Int)] = []
+
+  public init(orders: [Order]) {
+    var quantities: [String: Int] = [:]
+    for order in orders where order.status != .cancelled {
+      countByStatus[order.status] = (countByStatus[order.status] ?? 0) + 1
+      revenue += order.subtotal + order.tax(rate: 0.0825)
+      for item in order.items {
+        quantities[item.sku] = (quantities[item.sku] ?? 0) + item.quantity
+      }
+    }
+    topSKUs = quantities.sorted {
+      $0.value > $1.value || ($0.value == $1.value && $0.key < $1.key)
+    }.prefix(10).map { (sku: $0.key, quantity: $0.value) }
+  }
+
+  public var report: String {
+    let statuses = countByStatus.sorted { $0.key.rawValue < $1.key.rawValue }
+      .map { "\($0.key.rawValue): \($0.value)" }
+      .joined(separator: ", ")
+    let skus = topSKUs.enumerated()
+      .map { "\($0.offset + 1). \($0.element.sku) x\($0.element.quantity)" }
+      .joined(separator: "\n")
+    return "Revenue: \(revenue)\nOrders: \(statuses)\n\(skus)"
+  }
+}
@@ -15,6 +15,8 @@
 
 import argparse
 import csv
+import json
+import math
 import sys
 
 TESTNAME = 1
@@ -74,6 +76,12 @@ PAIN_DETAIL = """
 RATIO_MIN = None
 RATIO_MAX = None
 
+# The smallest number of samples on each side for which a change is tested for
+# significance; with fewer samples only the ranges of the results are compared.
+# With three samples on each side, even fully separated samples have a
+# two-sided p-value of 0.1, so no change could ever be significant.
+MIN_SAMPLES_FOR_SIGNIFICANCE = 4
+
 
 def main():
     global RATIO_MIN
@@ -110,6 +118,9 @@ def main():
                         help='Name of the old branch', default="OLD_MIN")
     parser.add_argument('--delta-threshold',
                         help='delta threshold', default="0.05")
+    parser.add_argument('--significance',
+                        help='p-value below which a change in the samples ' +
+                        'of a JSON result is significant', default="0.05")
 
     args = parser.parse_args()
 
@@ -119,33 +130,12 @@ def main():
     new_branch = args.new_branch
     old_branch = args.old_branch
 
-    old_data = csv.reader(open(old_file))
-    new_data = csv.reader(open(new_file))
-
     RATIO_MIN = 1 - float(args.delta_threshold)
     RATIO_MAX = 1 + float(args.delta_threshold)
+    significance = float(args.significance)
 
-    for row in old_data:
-        if (len(row) > 7 and row[MIN].isdigit()):
-            if row[TESTNAME] in old_results:
-                if old_results[row[TESTNAME]] > int(row[MIN]):
-                    old_results[row[TESTNAME]] = int(row[MIN])
-                if old_max_results[row[TESTNAME]] < int(row[MAX]):
-                    old_max_results[row[TESTNAME]] = int(row[MAX])
-            else:
-                old_results[row[TESTNAME]] = int(row[MIN])
-                old_max_results[row[TESTNAME]] = int(row[MAX])
-
-    for row in new_data:
-        if (len(row) > 7 and row[MIN].isdigit()):
-            if row[TESTNAME] in new_results:
-                if int(new_results[row[TESTNAME]]) > int(row[MIN]):
-                    new_results[row[TESTNAME]] = int(row[MIN])
-                if new_max_results[row[TESTNAME]] < int(row[MAX]):
-                    new_max_results[row[TESTNAME]] = int(row[MAX])
-            else:
-                new_results[row[TESTNAME]] = int(row[MIN])
-                new_max_results[row[TESTNAME]] = int(row[MAX])
+    old_samples = read_results(old_file, old_results, old_max_results)
+    new_samples = read_results(new_file, new_results, new_max_results)
 
     ratio_total = 0
     for key in new_results.keys():
@@ -155,13 +145,11 @@ def main():
             delta = (((float(new_results[key] + 0.001) /
                       (old_results[key] + 0.001)) - 1) * 100)
             delta_list[key] = round(delta, 2)
-            if ((old_results[key] < new_results[key] and
-                new_results[key] < old_max_results[key]) or
-                (new_results[key] < old_results[key] and
-                    old_results[key] < new_max_results[key])):
-                    unknown_list[key] = "(?)"
-            else:
-                    unknown_list[key] = ""
+            unknown_list[key] = "(?)" if is_uncertain(
+                old_results[key], new_results[key],
+                old_max_results[key], new_max_results[key],
+                old_samples.get(key, []), new_samples.get(key, []),
+                significance) else ""
 
     (complete_perf_list,
      increased_perf_list,
@@ -269,6 +257,91 @@ def main():
             sys.exit(1)
 
 
+def read_results(file_name, results, max_results):
+    """
+    Read the MIN and MAX of each test in a benchmark log into `results` and
+    `max_results`, keeping the best and worst of repeated runs. The log is
+    either the delimited output of a benchmark driver or its `--json` output.
+    Returns the samples of each test, which only JSON logs have.
+    """
+    samples = {}
+    with open(file_name) as f:
+        contents = f.read()
+
+    if contents.lstrip().startswith('{'):
+        rows = []
+        for test in json.loads(contents)['tests']:
+            samples.setdefault(test['name'], []).extend(test['samples'])
+            rows.append([test['number'], test['name'], len(test['samples']),
+                         test['min'], test['max']])
+    else:
+        rows = [row for row in csv.reader(contents.splitlines())
+                if len(row) > 7 and row[MIN].isdigit()]
+
+    for row in rows:
+        name = row[TESTNAME]
+        if name in results:
+            if results[name] > int(row[MIN]):
+                results[name] = int(row[MIN])
+            if max_results[name] < int(row[MAX]):
+                max_results[name] = int(row[MAX])
+        else:
+            results[name] = int(row[MIN])
+            max_results[name] = int(row[MAX])
+    return samples
+
+
+def is_uncertain(old_min, new_min, old_max, new_max, old_samples, new_samples,
+                 significance):
+    """
+    Return whether the change from the old to the new result of a test may be
+    noise. With enough samples on both sides, that is when the Mann-Whitney U
+    test does not find the change significant; otherwise, it is when the new
+    minimum falls within the old range of results or the other way around.
+    """
+    if (len(old_samples) >= MIN_SAMPLES_FOR_SIGNIFICANCE and
+            len(new_samples) >= MIN_SAMPLES_FOR_SIGNIFICANCE):
+        return mann_whitney_p_value(old_samples, new_samples) >= significance
+    return ((old_min < new_min and new_min < old_max) or
+            (new_min < old_min and old_min < new_max))
+
+
+def mann_whitney_p_value(old, new):
+    """
+    Return the two-sided p-value of the Mann-Whitney U test for the samples
+    `old` and `new`, using the normal approximation of the U statistic. The
+    test makes no assumption about the distribution of the samples, which is
+    usually skewed by noise from the rest of the system.
+    """
+    ranked = sorted([(v, 0) for v in old] + [(v, 1) for v in new])
+    # Tied values share the average of their ranks.
+    ranks = [0.0] * len(ranked)
+    tie_correction = 0.0
+    i = 0
+    while i < len(ranked):
+        j = i
+        while j + 1 < len(ranked) and ranked[j + 1][0] == ranked[i][0]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[k] = (i + j) / 2.0 + 1
+        ties = j - i + 1
+        tie_correction += ties ** 3 - ties
+        i = j + 1
+
+    n1 = len(old)
+    n2 = len(new)
+    n = n1 + n2
+    rank_sum = sum(r for r, (_, side) in zip(ranks, ranked) if side == 0)
+    u = rank_sum - n1 * (n1 + 1) / 2.0
+    mean = n1 * n2 / 2.0
+    variance = n1 * n2 / 12.0 * ((n + 1) - tie_correction / (n * (n - 1)))
+    if variance <= 0:
+        return 1.0
+    # Apply a continuity correction towards the mean.
+    z = max(abs(u - mean) - 0.5, 0) / math.sqrt(variance)
+    return math.erfc(z / math.sqrt(2))
+
+
 def convert_to_html(ratio_list, old_results, new_results, delta_list,
                     unknown_list, old_branch, new_branch, changes_only):
     (complete_perf_list,
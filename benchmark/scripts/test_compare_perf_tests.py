@@ -0,0 +1,54 @@
+# test_compare_perf_tests.py - compare_perf_tests unit tests -*- python -*-
+#
+# This source file is part of the Swift.org open source project
+#
+# Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+# Licensed under Apache License v2.0 with Runtime Library Exception
+#
+# See http://swift.org/LICENSE.txt for license information
+# See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+
+import unittest
+
+from compare_perf_tests import is_uncertain
+from compare_perf_tests import mann_whitney_p_value
+
+
+class MannWhitneyTestCase(unittest.TestCase):
+
+    def test_identical_samples_are_not_significant(self):
+        self.assertEqual(mann_whitney_p_value([5, 5, 5, 5], [5, 5, 5, 5]),
+                         1.0)
+
+    def test_separated_samples_of_four_are_significant(self):
+        self.assertLess(mann_whitney_p_value([10, 11, 12, 13],
+                                             [20, 21, 22, 23]), 0.05)
+
+    def test_interleaved_samples_are_not_significant(self):
+        self.assertGreater(mann_whitney_p_value([10, 12, 14, 16],
+                                                [11, 13, 15, 17]), 0.05)
+
+
+class IsUncertainTestCase(unittest.TestCase):
+
+    def test_separated_samples_of_three_are_a_change(self):
+        # Three samples are too few for the U test, so the ranges decide.
+        self.assertFalse(is_uncertain(10, 20, 12, 22,
+                                      [10, 11, 12], [20, 21, 22], 0.05))
+
+    def test_overlapping_samples_of_three_are_uncertain(self):
+        self.assertTrue(is_uncertain(10, 11, 15, 16,
+                                     [10, 12, 15], [11, 14, 16], 0.05))
+
+    def test_separated_samples_of_four_are_a_change(self):
+        self.assertFalse(is_uncertain(10, 20, 13, 23,
+                                      [10, 11, 12, 13], [20, 21, 22, 23],
+                                      0.05))
+
+    def test_interleaved_samples_of_four_are_uncertain(self):
+        self.assertTrue(is_uncertain(10, 11, 16, 17,
+                                     [10, 12, 14, 16], [11, 13, 15, 17],
+                                     0.05))
+
+if __name__ == '__main__':
+    unittest.main()
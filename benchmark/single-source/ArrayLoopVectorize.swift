@@ -0,0 +1,82 @@
+//===--- ArrayLoopVectorize.swift -----------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test measures the throughput of simple numeric loops over arrays which
+// only vectorize if the optimizer removes (or hoists) all bounds checks and
+// uniqueness checks from the loop body.
+import TestsUtils
+
+let VectorSize = 4096
+
+@inline(never)
+func saxpy(_ y: inout [Float], _ a: Float, _ x: [Float], _ n: Int) {
+  for i in 0..<n {
+    y[i] = a * x[i] + y[i]
+  }
+}
+
+@inline(never)
+func scaleNonNegative(_ y: inout [Float], _ x: [Float], _ n: Int) {
+  for i in 0..<n {
+    // The checks of this conditional access can't be hoisted out of the loop
+    // as the access is not executed in every iteration. They are only removed
+    // in the O_ABCVERSIONED configuration, which versions the loop.
+    if x[i] >= 0 {
+      y[i] = x[i] * 0.5
+    }
+  }
+}
+
+@inline(never)
+func sumBuffer(_ x: UnsafeBufferPointer<Float>) -> Float {
+  var sum: Float = 0
+  for i in 0..<x.count {
+    sum += x[i]
+  }
+  return sum
+}
+
+@inline(never)
+public func run_ArrayLoopVectorizeSaxpy(_ N: Int) {
+  let x = [Float](repeating: 1, count: VectorSize)
+  var y = [Float](repeating: 0, count: VectorSize)
+  for _ in 1...100*N {
+    saxpy(&y, 2, x, VectorSize)
+  }
+  CheckResults(y[17] == Float(200*N),
+               "Incorrect results in ArrayLoopVectorizeSaxpy")
+}
+
+@inline(never)
+public func run_ArrayLoopVectorizeConditional(_ N: Int) {
+  var x = [Float](repeating: 2, count: VectorSize)
+  for i in stride(from: 0, to: VectorSize, by: 3) {
+    x[i] = -1
+  }
+  var y = [Float](repeating: 0, count: VectorSize)
+  for _ in 1...100*N {
+    scaleNonNegative(&y, x, VectorSize)
+  }
+  CheckResults(y[0] == 0 && y[1] == 1,
+               "Incorrect results in ArrayLoopVectorizeConditional")
+}
+
+@inline(never)
+public func run_ArrayLoopVectorizeBufferSum(_ N: Int) {
+  let x = [Float](repeating: 1, count: VectorSize)
+  var sum: Float = 0
+  for _ in 1...100*N {
+    sum += x.withUnsafeBufferPointer { sumBuffer($0) }
+  }
+  CheckResults(sum == Float(100*N*VectorSize),
+               "Incorrect results in ArrayLoopVectorizeBufferSum")
+}
@@ -10,7 +10,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#if os(Linux)
+import Glibc
+#else
 import Darwin
+#endif
 
 struct BenchResults {
   var delim: String  = ","
@@ -20,15 +24,32 @@ struct BenchResults {
   var mean: UInt64 = 0
   var sd: UInt64 = 0
   var median: UInt64 = 0
+  /// The median absolute deviation of the samples from their median.
+  var mad: UInt64 = 0
+  /// The half-width of the 95% confidence interval of the mean.
+  var ci95: UInt64 = 0
+  /// The peak resident set size of the process after the test ran, in bytes.
+  var maxRSS: UInt64 = 0
+  /// The number of iterations in each sample.
+  var numIters: UInt = 0
+  var samples = [UInt64]()
   init() {}
-  init(delim: String, sampleCount: UInt64, min: UInt64, max: UInt64, mean: UInt64, sd: UInt64, median: UInt64) {
+  init(delim: String, samples: [UInt64], numIters: UInt, maxRSS: UInt64) {
+    let (mean, sd) = internalMeanSD(samples)
+    let median = internalMedian(samples)
+
     self.delim = delim
-    self.sampleCount = sampleCount
-    self.min = min
-    self.max = max
+    self.sampleCount = UInt64(samples.count)
+    self.min = samples.min()!
+    self.max = samples.max()!
     self.mean = mean
     self.sd = sd
     self.median = median
+    self.mad = internalMAD(samples, median: median)
+    self.ci95 = internalConfidenceInterval(sd: sd, count: samples.count)
+    self.maxRSS = maxRSS
+    self.numIters = numIters
+    self.samples = samples
 
     // Sanity the bounds of our results
     precondition(self.min <= self.max, "min should always be <= max")
@@ -41,7 +62,33 @@ struct BenchResults {
 
 extension BenchResults : CustomStringConvertible {
   var description: String {
-     return "\(sampleCount)\(delim)\(min)\(delim)\(max)\(delim)\(mean)\(delim)\(sd)\(delim)\(median)"
+     return "\(sampleCount)\(delim)\(min)\(delim)\(max)\(delim)\(mean)\(delim)\(sd)\(delim)\(median)\(delim)\(maxRSS)"
+  }
+}
+
+/// Returns `s` as a JSON string literal.
+func jsonString(_ s: String) -> String {
+  var result = "\""
+  for c in s.unicodeScalars {
+    switch c {
+    case "\"": result += "\\\""
+    case "\\": result += "\\\\"
+    case "\n": result += "\\n"
+    default: result.unicodeScalars.append(c)
+    }
+  }
+  return result + "\""
+}
+
+extension BenchResults {
+  /// The results as a JSON object, for consumption by compare_perf_tests.py.
+  func jsonDescription(index: Int, name: String) -> String {
+    let sampleList = samples.map { String($0) }.joined(separator: ", ")
+    return "{\"number\": \(index), \"name\": \(jsonString(name)), " +
+      "\"num_iters\": \(numIters), \"samples\": [\(sampleList)], " +
+      "\"min\": \(min), \"max\": \(max), \"mean\": \(mean), \"sd\": \(sd), " +
+      "\"median\": \(median), \"mad\": \(mad), \"ci95\": \(ci95), " +
+      "\"max_rss\": \(maxRSS)}"
   }
 }
 
@@ -88,6 +135,13 @@ struct TestConfig {
   /// The number of samples we should take of each test.
   var numSamples: Int = 1
 
+  /// The number of untimed iterations to run before calibrating and sampling
+  /// a test, so that caches and lazily initialized state are warm.
+  var numWarmupIters: Int = 1
+
+  /// Should the results be printed as JSON rather than as delimited text?
+  var json: Bool = false
+
   /// Is verbose output enabled?
   var verbose: Bool = false
 
@@ -104,7 +158,8 @@ struct TestConfig {
   mutating func processArguments() -> TestAction {
     let validOptions = [
       "--iter-scale", "--num-samples", "--num-iters",
-      "--verbose", "--delim", "--run-all", "--list", "--sleep"
+      "--num-warmup-iters", "--verbose", "--delim", "--run-all", "--list",
+      "--sleep", "--json"
     ]
     let maybeBenchArgs: Arguments? = parseArgs(validOptions)
     if maybeBenchArgs == nil {
@@ -131,6 +186,17 @@ struct TestConfig {
       numSamples = Int(x)!
     }
 
+    if let x = benchArgs.optionalArgsMap["--num-warmup-iters"] {
+      guard let v = Int(x), v >= 0 else {
+        return .Fail("--num-warmup-iters requires a non-negative integer value")
+      }
+      numWarmupIters = v
+    }
+
+    if let _ = benchArgs.optionalArgsMap["--json"] {
+      json = true
+    }
+
     if let _ = benchArgs.optionalArgsMap["--verbose"] {
       verbose = true
       print("Verbose")
@@ -217,6 +283,32 @@ func internalMedian(_ inputs: [UInt64]) -> UInt64 {
   return inputs.sorted()[inputs.count / 2]
 }
 
+/// Returns the median absolute deviation of `inputs`, which unlike the
+/// standard deviation is not skewed by a few outlying samples.
+func internalMAD(_ inputs: [UInt64], median: UInt64) -> UInt64 {
+  return internalMedian(inputs.map { $0 > median ? $0 - median : median - $0 })
+}
+
+/// Two-sided 95% critical values of Student's t-distribution, indexed by the
+/// number of degrees of freedom minus one.
+let tDistribution95: [Double] = [
+  12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+  2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+  2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+]
+
+/// Returns the half-width of the 95% confidence interval of the mean of
+/// `count` samples with standard deviation `sd`.
+func internalConfidenceInterval(sd: UInt64, count: Int) -> UInt64 {
+  if count < 2 {
+    return 0
+  }
+  let degreesOfFreedom = count - 1
+  let t = degreesOfFreedom <= tDistribution95.count
+    ? tDistribution95[degreesOfFreedom - 1] : 1.960
+  return UInt64(t * Double(sd) / sqrt(Double(count)))
+}
+
 #if SWIFT_RUNTIME_ENABLE_LEAK_CHECKER
 
 @_silgen_name("swift_leaks_startTrackingObjects")
@@ -227,27 +319,84 @@ func stopTrackingObjects(_: UnsafeMutableRawPointer) -> Int
 #endif
 
 class SampleRunner {
+#if os(Linux)
+  // Glibc imports RUSAGE_SELF as an enum case rather than as an integer.
+  let rusageSelf = __rusage_who_t(0)
+#else
+  let rusageSelf = RUSAGE_SELF
   var info = mach_timebase_info_data_t(numer: 0, denom: 0)
+#endif
   init() {
+#if !os(Linux)
     mach_timebase_info(&info)
+#endif
+  }
+
+  /// Returns the value of a monotonic clock in nanoseconds.
+  func now() -> UInt64 {
+#if os(Linux)
+    var ts = timespec(tv_sec: 0, tv_nsec: 0)
+    clock_gettime(CLOCK_MONOTONIC, &ts)
+    return UInt64(ts.tv_sec) * 1_000_000_000 + UInt64(ts.tv_nsec)
+#else
+    return mach_absolute_time() * UInt64(info.numer) / UInt64(info.denom)
+#endif
   }
+
+  /// Returns the peak resident set size of the process in bytes.
+  func maxRSS() -> UInt64 {
+    var usage = rusage()
+    if getrusage(rusageSelf, &usage) != 0 {
+      return 0
+    }
+#if os(Linux)
+    // Linux reports the size in kilobytes.
+    return UInt64(usage.ru_maxrss) * 1024
+#else
+    return UInt64(usage.ru_maxrss)
+#endif
+  }
+
   func run(_ name: String, fn: (Int) -> Void, num_iters: UInt) -> UInt64 {
     // Start the timer.
 #if SWIFT_RUNTIME_ENABLE_LEAK_CHECKER
     var str = name
     startTrackingObjects(UnsafeMutableRawPointer(str._core.startASCII))
 #endif
-    let start_ticks = mach_absolute_time()
+    let start = now()
     fn(Int(num_iters))
     // Stop the timer.
-    let end_ticks = mach_absolute_time()
+    let end = now()
 #if SWIFT_RUNTIME_ENABLE_LEAK_CHECKER
     stopTrackingObjects(UnsafeMutableRawPointer(str._core.startASCII))
 #endif
+    return end - start
+  }
+}
 
-    // Compute the spent time and the scaling factor.
-    let elapsed_ticks = end_ticks - start_ticks
-    return elapsed_ticks * UInt64(info.numer) / UInt64(info.denom)
+/// The shortest run that calibration trusts to estimate the time of a single
+/// iteration, in nanoseconds. Shorter runs are dominated by timer resolution.
+let minCalibrationTime: UInt64 = 10_000_000
+
+/// Returns the number of iterations of `fn` that take about
+/// `timePerSample` nanoseconds, doubling the iteration count until a run is
+/// long enough to be measured reliably.
+func calibrateNumIters(_ name: String, _ fn: (Int) -> Void,
+                       _ sampler: SampleRunner, timePerSample: UInt64,
+                       verbose: Bool) -> UInt {
+  var numIters: UInt = 1
+  while true {
+    let elapsed = sampler.run(name, fn: fn, num_iters: numIters)
+    if elapsed >= minCalibrationTime || elapsed >= timePerSample ||
+       numIters >= UInt(Int.max / 2) {
+      let scale = Double(timePerSample) / Double(Swift.max(elapsed, 1))
+      let result = Swift.max(1, UInt(Double(numIters) * scale))
+      if verbose {
+        print("    Calibrated to \(result) iterations per sample.")
+      }
+      return result
+    }
+    numIters *= 2
   }
 }
 
@@ -261,47 +410,48 @@ func runBench(_ name: String, _ fn: (Int) -> Void, _ c: TestConfig) -> BenchResu
   }
 
   let sampler = SampleRunner()
-  for s in 0..<c.numSamples {
-    let time_per_sample: UInt64 = 1_000_000_000 * UInt64(c.iterationScale)
-
-    var scale : UInt
-    var elapsed_time : UInt64 = 0
-    if c.fixedNumIters == 0 {
-      elapsed_time = sampler.run(name, fn: fn, num_iters: 1)
-      scale = UInt(time_per_sample / elapsed_time)
-    } else {
-      // Compute the scaling factor if a fixed c.fixedNumIters is not specified.
-      scale = c.fixedNumIters
-    }
+  for _ in 0..<c.numWarmupIters {
+    fn(1)
+  }
 
-    // Rerun the test with the computed scale factor.
-    if scale > 1 {
-      if c.verbose {
-        print("    Measuring with scale \(scale).")
-      }
-      elapsed_time = sampler.run(name, fn: fn, num_iters: scale)
-    } else {
-      scale = 1
+  // Calibrate once, so that all samples run the same number of iterations.
+  let time_per_sample: UInt64 = 1_000_000_000 * UInt64(c.iterationScale)
+  let scale: UInt
+  if c.fixedNumIters == 0 {
+    scale = calibrateNumIters(name, fn, sampler,
+                              timePerSample: time_per_sample,
+                              verbose: c.verbose)
+  } else {
+    scale = c.fixedNumIters
+  }
+
+  for s in 0..<c.numSamples {
+    if c.verbose {
+      print("    Measuring with scale \(scale).")
     }
-    // save result in microseconds or k-ticks
+    let elapsed_time = sampler.run(name, fn: fn, num_iters: scale)
+    // save result in microseconds
     samples[s] = elapsed_time / UInt64(scale) / 1000
     if c.verbose {
       print("    Sample \(s),\(samples[s])")
     }
   }
 
-  let (mean, sd) = internalMeanSD(samples)
-
   // Return our benchmark results.
-  return BenchResults(delim: c.delim, sampleCount: UInt64(samples.count),
-                      min: samples.min()!, max: samples.max()!,
-                      mean: mean, sd: sd, median: internalMedian(samples))
+  let results = BenchResults(delim: c.delim, samples: samples, numIters: scale,
+                             maxRSS: sampler.maxRSS())
+  if c.verbose {
+    print("    Median \(results.median), MAD \(results.mad), " +
+          "mean \(results.mean) +/- \(results.ci95) (95% CI)")
+  }
+  return results
 }
 
 func printRunInfo(_ c: TestConfig) {
   if c.verbose {
     print("--- CONFIG ---")
     print("NumSamples: \(c.numSamples)")
+    print("NumWarmupIters: \(c.numWarmupIters)")
     print("Verbose: \(c.verbose)")
     print("IterScale: \(c.iterationScale)")
     if c.fixedNumIters != 0 {
@@ -320,9 +470,33 @@ func printRunInfo(_ c: TestConfig) {
   }
 }
 
+/// Runs the tests and prints their results as a JSON object:
+///
+///   {"unit": "us", "tests": [{"number": 1, "name": "Ackermann", ...}, ...]}
+///
+/// Unlike the delimited output, this includes every sample, so that results
+/// can be compared with a significance test.
+func runBenchmarksJSON(_ c: TestConfig) {
+  print("{\"unit\": \"us\", \"tests\": [")
+  var first = true
+  for t in c.tests where t.run {
+    let results = runBench(t.name, t.f, c)
+    print((first ? "  " : ", ") + results.jsonDescription(index: t.index,
+                                                          name: t.name))
+    fflush(stdout)
+    first = false
+  }
+  print("]}")
+}
+
 func runBenchmarks(_ c: TestConfig) {
+  if c.json {
+    runBenchmarksJSON(c)
+    return
+  }
+
   let units = "us"
-  print("#\(c.delim)TEST\(c.delim)SAMPLES\(c.delim)MIN(\(units))\(c.delim)MAX(\(units))\(c.delim)MEAN(\(units))\(c.delim)SD(\(units))\(c.delim)MEDIAN(\(units))")
+  print("#\(c.delim)TEST\(c.delim)SAMPLES\(c.delim)MIN(\(units))\(c.delim)MAX(\(units))\(c.delim)MEAN(\(units))\(c.delim)SD(\(units))\(c.delim)MEDIAN(\(units))\(c.delim)MAX_RSS(B)")
   var SumBenchResults = BenchResults()
   SumBenchResults.sampleCount = 0
 
@@ -340,6 +514,7 @@ func runBenchmarks(_ c: TestConfig) {
     SumBenchResults.min += results.min
     SumBenchResults.max += results.max
     SumBenchResults.mean += results.mean
+    SumBenchResults.maxRSS = max(SumBenchResults.maxRSS, results.maxRSS)
     SumBenchResults.sampleCount += 1
     // Don't accumulate SD and Median, as simple sum isn't valid for them.
     // TODO: Compute SD and Median for total results as well.
@@ -27,6 +27,7 @@ import Array2D
 import ArrayAppend
 import ArrayInClass
 import ArrayLiteral
+import ArrayLoopVectorize
 import ArrayOfGenericPOD
 import ArrayOfGenericRef
 import ArrayOfPOD
@@ -119,6 +120,9 @@ precommitTests = [
   "ArrayAppendRepeatCol": run_ArrayAppendRepeatCol,
   "ArrayInClass": run_ArrayInClass,
   "ArrayLiteral": run_ArrayLiteral,
+  "ArrayLoopVectorizeBufferSum": run_ArrayLoopVectorizeBufferSum,
+  "ArrayLoopVectorizeConditional": run_ArrayLoopVectorizeConditional,
+  "ArrayLoopVectorizeSaxpy": run_ArrayLoopVectorizeSaxpy,
   "ArrayOfGenericPOD": run_ArrayOfGenericPOD,
   "ArrayOfGenericRef": run_ArrayOfGenericRef,
   "ArrayOfPOD": run_ArrayOfPOD,
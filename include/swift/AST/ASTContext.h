@@ -60,6 +60,7 @@ namespace swift {
   class FuncDecl;
   class InFlightDiagnostic;
   class LazyResolver;
+  class MemoryStats;
   class PatternBindingDecl;
   class PatternBindingInitializer;
   class SourceLoc;
@@ -703,6 +704,17 @@ public:
   /// \brief Returns memory used exclusively by constraint solver.
   size_t getSolverMemory() const;
 
+  /// \brief Returns true if a constraint solver arena is active, i.e. if
+  /// some constraint system has not been destroyed yet.
+  bool hasActiveConstraintSolver() const;
+
+  /// \brief Returns the most memory used by any constraint solver so far.
+  size_t getPeakSolverMemory() const;
+
+  /// Adds the memory used by this ASTContext's allocators, and by its
+  /// largest uniquing tables, to \p stats.
+  void collectMemoryStats(MemoryStats &stats) const;
+
   /// Complain if @objc or dynamic is used without importing Foundation.
   void diagnoseAttrsRequiringFoundation(SourceFile &SF);
 
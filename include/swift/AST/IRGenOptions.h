@@ -125,6 +125,11 @@ public:
   /// (includes alloc_stack allocations).
   unsigned StackPromotionSizeLimit = 1024;
 
+  /// The minimum explosion size of a non-trivial loadable type for which
+  /// copies and destroys are emitted as calls to a shared helper function
+  /// instead of inline. Zero disables outlining.
+  unsigned ValueOperationOutliningThreshold = 0;
+
   /// Emit code to verify that static and runtime type layout are consistent for
   /// the given type names.
   SmallVector<StringRef, 1> VerifyTypeLayoutNames;
@@ -161,6 +166,11 @@ public:
   /// Enable use of the swiftcall calling convention.
   unsigned UseSwiftCall : 1;
 
+  /// Free the body of each SIL function as soon as its IR has been emitted,
+  /// so that the SIL and the LLVM IR of a whole module are never resident at
+  /// the same time. The SIL module must not be used after IRGen.
+  unsigned ReleaseSILDuringIRGen : 1;
+
   /// List of backend command-line options for -embed-bitcode.
   std::vector<uint8_t> CmdArgs;
 
@@ -177,7 +187,8 @@ public:
         PrintInlineTree(false), EmbedMode(IRGenEmbedMode::None),
         HasValueNamesSetting(false), ValueNames(false),
         EnableReflectionMetadata(true), EnableReflectionNames(true),
-        UseIncrementalLLVMCodeGen(true), UseSwiftCall(false), CmdArgs(),
+        UseIncrementalLLVMCodeGen(true), UseSwiftCall(false),
+        ReleaseSILDuringIRGen(false), CmdArgs(),
         SanitizeCoverage(llvm::SanitizerCoverageOptions()) {}
 
   /// Gets the name of the specified output filename.
@@ -214,6 +214,20 @@ public:
     llvm_unreachable("unimplemented");
   }
 
+  /// Populates the given vector with the members of \p IDC named \p name,
+  /// without loading the rest of its members.
+  ///
+  /// The implementation should \em not add the members to \p IDC.
+  ///
+  /// \returns false if the loader cannot look up members by name, in which
+  /// case the caller should fall back to loadAllMembers().
+  virtual bool
+  loadNamedMembers(const IterableDeclContext *IDC, Identifier name,
+                   uint64_t contextData,
+                   SmallVectorImpl<ValueDecl *> &members) {
+    return false;
+  }
+
   /// Populates the given vector with all conformances for \p D.
   ///
   /// The implementation should \em not call setConformances on \p D.
@@ -223,6 +237,18 @@ public:
     llvm_unreachable("unimplemented");
   }
 
+  /// Populates the given vector with the conformances of \p D to
+  /// \p protocol, without loading its other conformances.
+  ///
+  /// \returns false if the loader cannot look up conformances by protocol,
+  /// in which case the caller should fall back to loadAllConformances().
+  virtual bool
+  loadConformancesTo(const Decl *D, uint64_t contextData,
+                     ProtocolDecl *protocol,
+                     SmallVectorImpl<ProtocolConformance *> &conformances) {
+    return false;
+  }
+
   /// Populates the given vector with all conformances for \p D.
   virtual void
   finishNormalConformance(NormalProtocolConformance *conformance,
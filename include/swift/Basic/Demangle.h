@@ -71,6 +71,48 @@ struct DemangleOptions {
 class Node;
 typedef std::shared_ptr<Node> NodePointer;
 
+class NodeArena;
+
+/// Allocates \p Size bytes in \p Arena.
+void *allocateInNodeArena(NodeArena *Arena, size_t Size, size_t Alignment);
+
+/// The allocator for the children of a node: they live in the arena of the
+/// node, or on the heap if the node was not created in an arena.
+template <typename T>
+class NodeAllocator {
+  NodeArena *Arena;
+
+  template <typename U> friend class NodeAllocator;
+
+public:
+  typedef T value_type;
+
+  explicit NodeAllocator(NodeArena *Arena) : Arena(Arena) {}
+  template <typename U>
+  NodeAllocator(const NodeAllocator<U> &Other) : Arena(Other.Arena) {}
+
+  T *allocate(size_t n) {
+    if (!Arena)
+      return static_cast<T *>(::operator new(n * sizeof(T)));
+    return static_cast<T *>(allocateInNodeArena(Arena, n * sizeof(T),
+                                                alignof(T)));
+  }
+  void deallocate(T *p, size_t n) {
+    // Arena memory is reclaimed all at once.
+    if (!Arena)
+      ::operator delete(p);
+  }
+
+  template <typename U>
+  bool operator==(const NodeAllocator<U> &Other) const {
+    return Arena == Other.Arena;
+  }
+  template <typename U>
+  bool operator!=(const NodeAllocator<U> &Other) const {
+    return Arena != Other.Arena;
+  }
+};
+
 enum class FunctionSigSpecializationParamKind : unsigned {
   // Option Flags use bits 0-5. This give us 6 bits implying 64 entries to
   // work with.
@@ -82,6 +124,7 @@ enum class FunctionSigSpecializationParamKind : unsigned {
   ClosureProp = 5,
   BoxToValue = 6,
   BoxToStack = 7,
+  ExistentialToGeneric = 8,
 
   // Option Set Flags use bits 6-31. This gives us 26 bits to use for option
   // flags.
@@ -157,19 +200,21 @@ private:
     IndexType IndexPayload;
   };
 
-  // FIXME: use allocator.
-  typedef std::vector<NodePointer> NodeVector;
+  typedef std::vector<NodePointer, NodeAllocator<NodePointer>> NodeVector;
   NodeVector Children;
 
-  Node(Kind k)
-      : NodeKind(k), NodePayloadKind(PayloadKind::None) {
+  Node(Kind k, NodeArena *arena = nullptr)
+      : NodeKind(k), NodePayloadKind(PayloadKind::None),
+        Children(NodeAllocator<NodePointer>(arena)) {
   }
-  Node(Kind k, std::string &&t)
-      : NodeKind(k), NodePayloadKind(PayloadKind::Text) {
+  Node(Kind k, std::string &&t, NodeArena *arena = nullptr)
+      : NodeKind(k), NodePayloadKind(PayloadKind::Text),
+        Children(NodeAllocator<NodePointer>(arena)) {
     new (&TextPayload) std::string(std::move(t));
   }
-  Node(Kind k, IndexType index)
-      : NodeKind(k), NodePayloadKind(PayloadKind::Index) {
+  Node(Kind k, IndexType index, NodeArena *arena = nullptr)
+      : NodeKind(k), NodePayloadKind(PayloadKind::Index),
+        Children(NodeAllocator<NodePointer>(arena)) {
     IndexPayload = index;
   }
   Node(const Node &) = delete;
@@ -367,6 +412,64 @@ struct NodeFactory {
   static NodePointer create(Node::Kind K, const char (&Text)[N]) {
     return NodePointer(new Node(K, llvm::StringRef(Text)));
   }
+
+  /// Create nodes in \p Arena instead of on the heap. The arena is kept alive
+  /// as long as any node that was created in it.
+  static NodePointer create(const std::shared_ptr<NodeArena> &Arena,
+                            Node::Kind K);
+  static NodePointer create(const std::shared_ptr<NodeArena> &Arena,
+                            Node::Kind K, Node::IndexType Index);
+  static NodePointer create(const std::shared_ptr<NodeArena> &Arena,
+                            Node::Kind K, llvm::StringRef Text);
+  static NodePointer create(const std::shared_ptr<NodeArena> &Arena,
+                            Node::Kind K, std::string &&Text);
+  template <size_t N>
+  static NodePointer create(const std::shared_ptr<NodeArena> &Arena,
+                            Node::Kind K, const char (&Text)[N]) {
+    return create(Arena, K, llvm::StringRef(Text));
+  }
+
+private:
+  template <typename... Args>
+  static NodePointer createInArena(const std::shared_ptr<NodeArena> &Arena,
+                                   Args &&... args);
+};
+
+/// A context for demangling many symbols in a row.
+///
+/// The nodes of the trees demangled through a context are allocated in an
+/// arena. Once all trees that were handed out have been destroyed, the arena
+/// is reset and reused, so that demangling a symbol usually doesn't need to
+/// allocate any memory for its nodes.
+///
+/// A context must not be used from multiple threads at the same time. The
+/// trees it returns can be used and destroyed on any thread.
+class Context {
+  std::shared_ptr<NodeArena> Arena;
+
+  const std::shared_ptr<NodeArena> &getArena();
+
+public:
+  Context();
+  Context(const Context &) = delete;
+  Context &operator=(const Context &) = delete;
+  ~Context();
+
+  NodePointer
+  demangleSymbolAsNode(llvm::StringRef MangledName,
+                       const DemangleOptions &Options = DemangleOptions());
+
+  NodePointer
+  demangleTypeAsNode(llvm::StringRef MangledName,
+                     const DemangleOptions &Options = DemangleOptions());
+
+  std::string
+  demangleSymbolAsString(llvm::StringRef MangledName,
+                         const DemangleOptions &Options = DemangleOptions());
+
+  std::string
+  demangleTypeAsString(llvm::StringRef MangledName,
+                       const DemangleOptions &Options = DemangleOptions());
 };
 
   /// A class for printing to a std::string.
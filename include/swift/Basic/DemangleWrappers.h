@@ -43,6 +43,11 @@ NodePointer
 demangleSymbolAsNode(StringRef MangledName,
                      const DemangleOptions &Options = DemangleOptions());
 
+/// Like demangleSymbolAsNode(), but allocates the nodes in \p Ctx.
+NodePointer
+demangleSymbolAsNode(swift::Demangle::Context &Ctx, StringRef MangledName,
+                     const DemangleOptions &Options = DemangleOptions());
+
 std::string nodeToString(NodePointer Root,
                          const DemangleOptions &Options = DemangleOptions());
 
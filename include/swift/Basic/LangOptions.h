@@ -156,6 +156,14 @@ namespace swift {
     /// Should we use \c ASTScope-based resolution for unqualified name lookup?
     bool EnableASTScopeLookup = false;
 
+    /// Should member lookups into types from serialized modules load only
+    /// the members with the name being looked up?
+    bool EnableNamedLazyMemberLoading = false;
+
+    /// Should conformances of types from serialized modules be loaded one
+    /// protocol at a time, as they are looked up?
+    bool EnableLazyConformanceLoading = false;
+
     /// Whether to use the import as member inference system
     ///
     /// When importing a global, try to infer whether we can import it as a
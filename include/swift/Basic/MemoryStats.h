@@ -0,0 +1,91 @@
+//===--- MemoryStats.h - Memory used by a compilation -----------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines MemoryStats, which collects the memory used by the
+// allocators of a compilation and by the process at the end of each phase,
+// and prints it as JSON for -print-memory-stats.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_BASIC_MEMORYSTATS_H
+#define SWIFT_BASIC_MEMORYSTATS_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace swift {
+
+class MemoryStats {
+public:
+  /// The memory used by the process at the end of a compilation phase.
+  struct Phase {
+    std::string Name;
+    /// The bytes allocated with malloc that have not been freed.
+    uint64_t HeapInUse;
+    /// The peak resident set size of the process so far.
+    uint64_t PeakRSS;
+  };
+
+  /// The memory owned by one of the allocators of the compiler.
+  struct Arena {
+    std::string Name;
+    uint64_t Bytes;
+  };
+
+  /// A table of uniqued entities, such as the types of one kind.
+  struct Table {
+    std::string Name;
+    uint64_t Entries;
+    uint64_t Bytes;
+  };
+
+private:
+  std::vector<Phase> Phases;
+  std::vector<Arena> Arenas;
+  std::vector<Table> Tables;
+
+public:
+  /// Records the memory used by the process at the end of the phase \p name.
+  void recordPhase(StringRef name);
+
+  void addArena(StringRef name, uint64_t bytes) {
+    Arenas.push_back({name, bytes});
+  }
+
+  void addTable(StringRef name, uint64_t entries, uint64_t bytes) {
+    Tables.push_back({name, entries, bytes});
+  }
+
+  ArrayRef<Phase> getPhases() const { return Phases; }
+  ArrayRef<Arena> getArenas() const { return Arenas; }
+  ArrayRef<Table> getTables() const { return Tables; }
+
+  /// Prints the statistics as a JSON object, with the \p maxTables largest
+  /// tables.
+  void print(raw_ostream &OS, unsigned maxTables = 10) const;
+
+  /// Returns the number of bytes allocated with malloc and not yet freed, or
+  /// 0 if that isn't known on this platform.
+  static uint64_t getHeapInUse();
+
+  /// Returns the peak resident set size of the process in bytes, or 0 if
+  /// that isn't known on this platform.
+  static uint64_t getPeakResidentSetSize();
+};
+
+} // end namespace swift
+
+#endif // SWIFT_BASIC_MEMORYSTATS_H
@@ -289,6 +289,10 @@ public:
   bool isDelayedFunctionBodyParsing() const {
     return FrontendOpts.DelayedFunctionBodyParsing;
   }
+
+  bool isDelayedNonPrimaryFunctionBodyParsing() const {
+    return FrontendOpts.DelayNonPrimaryFunctionBodyParsing;
+  }
 };
 
 /// A class which manages the state and execution of the compiler.
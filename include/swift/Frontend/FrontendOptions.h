@@ -115,9 +115,18 @@ public:
   /// The path to which we should output fixits as source edits.
   std::string FixitsOutputPath;
 
+  /// The path of the index store to which we should write index data for the
+  /// compiled source files.
+  std::string IndexStorePath;
+
   /// Arguments which should be passed in immediate mode.
   std::vector<std::string> ImmediateArgv;
 
+  /// The directory in which immediate mode caches the object code it
+  /// compiles, so that running an unchanged script again skips LLVM code
+  /// generation. If empty, nothing is cached.
+  std::string ImmediateObjectCachePath;
+
   /// \brief A list of arguments to forward to LLVM's option processing; this
   /// should only be used for debugging and experimental features.
   std::vector<std::string> LLVMArgs;
@@ -188,6 +197,11 @@ public:
   /// until the end of all files.
   bool DelayedFunctionBodyParsing = false;
 
+  /// Indicates whether function bodies in files other than the primary file
+  /// should only be parsed when they are needed, e.g. because they can be
+  /// inlined.
+  bool DelayNonPrimaryFunctionBodyParsing = true;
+
   /// Indicates whether or not an import statement can pick up a Swift source
   /// file (as opposed to a module file).
   bool EnableSourceImport = false;
@@ -223,6 +237,10 @@ public:
   /// termination.
   bool PrintStats = false;
 
+  /// Indicates whether or not the frontend should print the memory used by
+  /// each allocator and compilation phase upon termination.
+  bool PrintMemoryStats = false;
+
   /// Indicates whether or not the Clang importer should print statistics upon
   /// termination.
   bool PrintClangStats = false;
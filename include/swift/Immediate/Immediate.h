@@ -18,6 +18,8 @@
 #ifndef SWIFT_IMMEDIATE_IMMEDIATE_H
 #define SWIFT_IMMEDIATE_IMMEDIATE_H
 
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/Optional.h"
 #include <string>
 #include <vector>
 
@@ -33,11 +35,34 @@ namespace swift {
   using ProcessCmdLine = std::vector<std::string>;
   
 
+  /// Attempt to run the script identified by the given compiler instance
+  /// from the object code cached in \p ObjectCachePath by an earlier run.
+  ///
+  /// This is called before the script is parsed. The cache is keyed by
+  /// \p CompilerArgs and the contents of the script, and an entry is only
+  /// used if the modules the script imported when it was cached are
+  /// unchanged. On a hit, the script is run without type checking, SILGen,
+  /// IRGen or LLVM code generation.
+  ///
+  /// \return the result returned from main(), or None if the script is not in
+  /// the cache
+  Optional<int> RunCachedImmediately(CompilerInstance &CI,
+                                     const ProcessCmdLine &CmdLine,
+                                     IRGenOptions &IRGenOpts,
+                                     const std::string &ObjectCachePath,
+                                     ArrayRef<const char *> CompilerArgs);
+
   /// Attempt to run the script identified by the given compiler instance.
   ///
+  /// If \p ObjectCachePath is not empty, the object code compiled for the
+  /// script is written to that directory, for RunCachedImmediately() to find
+  /// on the next run.
+  ///
   /// \return the result returned from main(), if execution succeeded
   int RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
-                     IRGenOptions &IRGenOpts, const SILOptions &SILOpts);
+                     IRGenOptions &IRGenOpts, const SILOptions &SILOpts,
+                     const std::string &ObjectCachePath,
+                     ArrayRef<const char *> CompilerArgs);
 
   void runREPL(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
                bool ParseStdlib);
@@ -0,0 +1,58 @@
+//===--- IndexRecord.h - Index data persistence -----------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// The index store is a directory with two kinds of files:
+//
+// - A *record* holds the symbol occurrences of a single source file. Its name
+//   contains a hash of its contents, so a record that didn't change since the
+//   last compilation is not written again, and clients can tell which records
+//   changed by their names alone.
+//
+// - A *unit* describes a single compilation (keyed by its output file): the
+//   module, the records of the source files that were indexed and the modules
+//   they depend on. A unit is only rewritten if its contents changed.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_INDEX_INDEXRECORD_H
+#define SWIFT_INDEX_INDEXRECORD_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace swift {
+class DiagnosticEngine;
+class ModuleDecl;
+class SourceFile;
+
+namespace index {
+
+/// Index \p primarySourceFile and write its record, and the unit for the
+/// compilation identified by \p indexUnitToken, to the index store at
+/// \p indexStorePath.
+///
+/// \returns true if there was an error, which has been diagnosed.
+bool indexAndRecord(SourceFile *primarySourceFile, StringRef indexUnitToken,
+                    StringRef indexStorePath, DiagnosticEngine &diags);
+
+/// Index all source files of \p module and write their records, and the unit
+/// for the compilation identified by \p indexUnitToken, to the index store at
+/// \p indexStorePath.
+///
+/// \returns true if there was an error, which has been diagnosed.
+bool indexAndRecord(ModuleDecl *module, StringRef indexUnitToken,
+                    StringRef indexStorePath, DiagnosticEngine &diags);
+
+} // end namespace index
+} // end namespace swift
+
+#endif // SWIFT_INDEX_INDEXRECORD_H
@@ -296,6 +296,28 @@ public:
 private:
   std::vector<ReflectionInfo> ReflectionInfos;
 
+  /// The number of images in ReflectionInfos whose sections have been added
+  /// to the indexes below.
+  size_t NumIndexedReflectionInfos = 0;
+
+  /// Field descriptors, by mangled type name.
+  std::unordered_map<std::string, const FieldDescriptor *> FieldDescriptors;
+
+  /// Builtin type descriptors, by mangled type name.
+  std::unordered_map<std::string, const BuiltinTypeDescriptor *>
+    BuiltinTypeDescriptors;
+
+  /// Associated type descriptors, by mangled conforming type name.
+  std::unordered_map<std::string, std::vector<const AssociatedTypeDescriptor *>>
+    AssociatedTypeDescriptors;
+
+  /// Capture descriptors, by their address in the remote process.
+  std::unordered_map<uintptr_t, const CaptureDescriptor *> CaptureDescriptors;
+
+  /// Adds the sections of any images added since the last lookup to the
+  /// descriptor indexes, so that each section is only walked once.
+  void indexReflectionInfos();
+
 public:
   TypeConverter &getTypeConverter() { return TC; }
 
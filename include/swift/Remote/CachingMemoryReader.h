@@ -0,0 +1,182 @@
+//===--- CachingMemoryReader.h - Block cache over a MemoryReader -*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares an implementation of MemoryReader that caches the
+//  memory read through another MemoryReader in fixed-size blocks.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_REMOTE_CACHINGMEMORYREADER_H
+#define SWIFT_REMOTE_CACHINGMEMORYREADER_H
+
+#include "swift/Remote/MemoryReader.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace swift {
+namespace remote {
+
+/// An implementation of MemoryReader which reads the memory of the remote
+/// process a block at a time through another MemoryReader and keeps the
+/// most recently used blocks.
+///
+/// Walking the heap reads the same metadata and type descriptors over and
+/// over, each with many small reads; with this reader, each block is read
+/// once. The cache assumes the memory does not change, as in a core file or
+/// a suspended process; call clear() after the remote process has run.
+class CachingMemoryReader final : public MemoryReader {
+  struct Block {
+    uint64_t Address;
+    std::vector<uint8_t> Bytes;
+  };
+
+  std::shared_ptr<MemoryReader> Underlying;
+  const uint64_t BlockSize;
+  const size_t MaxBlocks;
+
+  /// The cached blocks, most recently used first.
+  std::list<Block> Blocks;
+  std::unordered_map<uint64_t, std::list<Block>::iterator> BlocksByAddress;
+
+  uint8_t PointerSize = 0;
+  uint8_t SizeSize = 0;
+
+  uint64_t NumHits = 0;
+  uint64_t NumMisses = 0;
+
+  /// Returns the cached block starting at \p blockAddress, reading it if
+  /// needed, or null if it can't be read in full.
+  const Block *getBlock(uint64_t blockAddress) {
+    auto found = BlocksByAddress.find(blockAddress);
+    if (found != BlocksByAddress.end()) {
+      ++NumHits;
+      Blocks.splice(Blocks.begin(), Blocks, found->second);
+      return &Blocks.front();
+    }
+
+    ++NumMisses;
+    std::vector<uint8_t> bytes(BlockSize);
+    if (!Underlying->readBytes(RemoteAddress(blockAddress), bytes.data(),
+                               BlockSize))
+      return nullptr;
+
+    if (Blocks.size() == MaxBlocks) {
+      BlocksByAddress.erase(Blocks.back().Address);
+      Blocks.pop_back();
+    }
+    Blocks.push_front({blockAddress, std::move(bytes)});
+    BlocksByAddress[blockAddress] = Blocks.begin();
+    return &Blocks.front();
+  }
+
+public:
+  /// Creates a reader that caches up to \p maxBlocks blocks of
+  /// \p blockSize bytes, which must be a power of two.
+  explicit CachingMemoryReader(std::shared_ptr<MemoryReader> underlying,
+                               uint64_t blockSize = 4096,
+                               size_t maxBlocks = 4096)
+    : Underlying(std::move(underlying)), BlockSize(blockSize),
+      MaxBlocks(maxBlocks) {
+    assert(BlockSize != 0 && (BlockSize & (BlockSize - 1)) == 0 &&
+           "block size must be a power of two");
+    assert(MaxBlocks != 0 && "must cache at least one block");
+  }
+
+  uint8_t getPointerSize() override {
+    if (!PointerSize)
+      PointerSize = Underlying->getPointerSize();
+    return PointerSize;
+  }
+
+  uint8_t getSizeSize() override {
+    if (!SizeSize)
+      SizeSize = Underlying->getSizeSize();
+    return SizeSize;
+  }
+
+  RemoteAddress getSymbolAddress(const std::string &name) override {
+    return Underlying->getSymbolAddress(name);
+  }
+
+  bool readBytes(RemoteAddress address, uint8_t *dest,
+                 uint64_t size) override {
+    uint64_t addr = address.getAddressData();
+    uint64_t end = addr + size;
+    if (end < addr)
+      return false;
+
+    while (addr != end) {
+      uint64_t blockAddress = addr & ~(BlockSize - 1);
+      uint64_t offset = addr - blockAddress;
+      uint64_t count = std::min(BlockSize - offset, end - addr);
+
+      auto block = getBlock(blockAddress);
+      if (!block) {
+        // The block extends into memory that can't be read, such as the end
+        // of a mapping; read just the rest of the request directly.
+        return Underlying->readBytes(RemoteAddress(addr), dest, end - addr);
+      }
+
+      std::memcpy(dest, block->Bytes.data() + offset, count);
+      dest += count;
+      addr += count;
+    }
+    return true;
+  }
+
+  bool readString(RemoteAddress address, std::string &dest) override {
+    std::string result;
+    uint64_t addr = address.getAddressData();
+    while (true) {
+      uint64_t blockAddress = addr & ~(BlockSize - 1);
+      auto block = getBlock(blockAddress);
+      if (!block)
+        return Underlying->readString(address, dest);
+
+      auto begin = block->Bytes.data() + (addr - blockAddress);
+      auto blockEnd = block->Bytes.data() + BlockSize;
+      auto nul = static_cast<const uint8_t *>(
+                   std::memchr(begin, 0, blockEnd - begin));
+      if (nul) {
+        result.append(reinterpret_cast<const char *>(begin), nul - begin);
+        dest = std::move(result);
+        return true;
+      }
+
+      result.append(reinterpret_cast<const char *>(begin), blockEnd - begin);
+      addr = blockAddress + BlockSize;
+    }
+  }
+
+  /// Discards all of the cached memory.
+  void clear() {
+    Blocks.clear();
+    BlocksByAddress.clear();
+  }
+
+  /// The number of reads of a block that were found in the cache.
+  uint64_t getNumHits() const { return NumHits; }
+
+  /// The number of reads of a block that went to the underlying reader.
+  uint64_t getNumMisses() const { return NumMisses; }
+};
+
+} // end namespace remote
+} // end namespace swift
+
+#endif // SWIFT_REMOTE_CACHINGMEMORYREADER_H
@@ -1003,12 +1003,16 @@ class ApplyInstBase<Impl, Base, false> : public Base {
 
   /// The number of tail-allocated substitutions, allocated after the operand
   /// list's tail allocation.
-  unsigned NumSubstitutions: 31;
+  unsigned NumSubstitutions: 30;
 
   /// Used for apply_inst instructions: true if the called function has an
   /// error result but is not actually throwing.
   bool NonThrowing: 1;
 
+  /// Used for partial_apply instructions: true if the closure context can be
+  /// allocated on the stack (the final decision is in IRGen).
+  bool OnStack: 1;
+
   /// The number of call arguments as required by the callee.
   unsigned NumCallArguments;
 
@@ -1032,7 +1036,7 @@ protected:
                 As... baseArgs)
       : Base(kind, DebugLoc, baseArgs...), SubstCalleeType(substCalleeType),
         NumSubstitutions(substitutions.size()), NonThrowing(false),
-        NumCallArguments(args.size()),
+        OnStack(false), NumCallArguments(args.size()),
         Operands(this, args, TypeDependentOperands, callee) {
     static_assert(sizeof(Impl) == sizeof(*this),
         "subclass has extra storage, cannot use TailAllocatedOperandList");
@@ -1054,6 +1058,10 @@ protected:
   void setNonThrowing(bool isNonThrowing) { NonThrowing = isNonThrowing; }
   
   bool isNonThrowingApply() const { return NonThrowing; }
+
+  void setOnStack(bool isOnStack) { OnStack = isOnStack; }
+
+  bool isOnStack() const { return OnStack; }
   
 public:
   /// The operand number of the first argument.
@@ -1318,6 +1326,10 @@ public:
 
 /// PartialApplyInst - Represents the creation of a closure object by partial
 /// application of a function value.
+///
+/// A partial_apply with the [stack] attribute allocates its closure context on
+/// the stack. The context is deallocated by a dealloc_ref [stack] at the end of
+/// its lifetime.
 class PartialApplyInst
     : public ApplyInstBase<PartialApplyInst, SILInstruction> {
   friend SILBuilder;
@@ -1342,6 +1354,11 @@ public:
     return getType().castTo<SILFunctionType>();
   }
 
+  /// Returns true if the closure context can be allocated on the stack.
+  bool canAllocOnStack() const { return isOnStack(); }
+
+  void setStackAllocatable() { setOnStack(true); }
+
   static bool classof(const ValueBase *V) {
     return V->getKind() == ValueKind::PartialApplyInst;
   }
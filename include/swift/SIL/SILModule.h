@@ -592,6 +592,9 @@ public:
   /// Deallocate memory of an instruction.
   void deallocateInst(SILInstruction *I);
 
+  /// Returns the number of bytes owned by the module's internal allocator.
+  size_t getAllocatedMemory() const { return BPA.getTotalMemory(); }
+
   /// \brief Looks up the llvm intrinsic ID and type for the builtin function.
   ///
   /// \returns Returns llvm::Intrinsic::not_intrinsic if the function is not an
@@ -190,11 +190,14 @@ protected:
       if (FRI && FRI->getReferencedFunction() == Inst->getFunction()) {
         FRI = Builder.createFunctionRef(getOpLocation(Inst->getLoc()),
                                         &Builder.getFunction());
-        Builder.createPartialApply(getOpLocation(Inst->getLoc()), FRI,
-                                   getOpType(Inst->getSubstCalleeSILType()),
-                                   ArrayRef<Substitution>(),
-                                   Args,
-                                   getOpType(Inst->getType()));
+        auto *N =
+          Builder.createPartialApply(getOpLocation(Inst->getLoc()), FRI,
+                                     getOpType(Inst->getSubstCalleeSILType()),
+                                     ArrayRef<Substitution>(),
+                                     Args,
+                                     getOpType(Inst->getType()));
+        if (Inst->canAllocOnStack())
+          N->setStackAllocatable();
         return;
       }
     }
@@ -204,10 +207,12 @@ protected:
       TempSubstList.push_back(asImpl().getOpSubstitution(Sub));
     }
     
-    Builder.createPartialApply(
+    auto *N = Builder.createPartialApply(
       getOpLocation(Inst->getLoc()), getOpValue(CalleeVal),
         getOpType(Inst->getSubstCalleeSILType()), TempSubstList, Args,
         getOpType(Inst->getType()));
+    if (Inst->canAllocOnStack())
+      N->setStackAllocatable();
   }
 
   void visitWitnessMethodInst(WitnessMethodInst *Inst) {
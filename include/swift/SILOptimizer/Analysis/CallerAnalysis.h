@@ -19,7 +19,7 @@
 #include "swift/SIL/SILModule.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
-#include "llvm/ADT/SmallSet.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/TinyPtrVector.h"
 
 namespace swift {
@@ -50,7 +50,7 @@ public:
     /// A list of all the functions this function calls or partially applies.
     llvm::SetVector<SILFunction *> Callees;
     /// A list of all the callers this function has.
-    llvm::SmallSet<SILFunction *, 4> Callers;
+    llvm::SmallSetVector<SILFunction *, 4> Callers;
 
     /// The number of partial applied arguments of this function.
     ///
@@ -67,6 +67,11 @@ public:
       return !Callers.empty();
     }
 
+    /// Returns the functions which call this function.
+    ArrayRef<SILFunction *> getCallers() const {
+      return Callers.getArrayRef();
+    }
+
     /// Returns non zero if this function is partially applied anywhere.
     ///
     /// The return value is the minimum number of partially applied arguments.
@@ -52,6 +52,10 @@ struct ArgumentDescriptor {
   /// This parameter is owned to guaranteed.
   bool OwnedToGuaranteed;
 
+  /// This existential parameter is converted to a generic parameter which is
+  /// constrained to the existential's protocol.
+  bool ExistentialToGeneric;
+
   /// Is this parameter an indirect result?
   bool IsIndirectResult;
 
@@ -79,7 +83,7 @@ struct ArgumentDescriptor {
   ArgumentDescriptor(SILArgument *A)
       : Arg(A), PInfo(Arg->getKnownParameterInfo()), Index(A->getIndex()),
         Decl(A->getDecl()), IsEntirelyDead(false), Explode(false),
-        OwnedToGuaranteed(false),
+        OwnedToGuaranteed(false), ExistentialToGeneric(false),
         IsIndirectResult(A->isIndirectResult()),
         CalleeRelease(), CalleeReleaseInThrowBlock(),
         ProjTree(A->getModule(), A->getType()) {}
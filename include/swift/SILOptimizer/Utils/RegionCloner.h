@@ -0,0 +1,80 @@
+//===--- RegionCloner.h - Clone single entry CFG regions --------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+///
+/// This file defines a cloner for single entry, multiple exit regions of a
+/// function's CFG. Loop transformations use it to create a second version of
+/// a loop nest that can then be specialized under a hoisted predicate.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_SILOPTIMIZER_UTILS_REGIONCLONER_H
+#define SWIFT_SILOPTIMIZER_UTILS_REGIONCLONER_H
+
+#include "swift/SIL/SILCloner.h"
+#include "swift/SILOptimizer/Analysis/DominanceAnalysis.h"
+#include "swift/SILOptimizer/Utils/SILSSAUpdater.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+
+namespace swift {
+
+/// Clone a single exit multiple exit region starting at basic block and ending
+/// in a set of basic blocks. Updates the dominator tree with the cloned blocks.
+/// However, the client needs to update the dominator of the exit blocks.
+class RegionCloner : public SILCloner<RegionCloner> {
+  DominanceInfo &DomTree;
+  SILBasicBlock *StartBB;
+  SmallPtrSet<SILBasicBlock *, 16> OutsideBBs;
+
+  friend class SILVisitor<RegionCloner>;
+  friend class SILCloner<RegionCloner>;
+
+public:
+  RegionCloner(SILBasicBlock *EntryBB,
+               SmallVectorImpl<SILBasicBlock *> &ExitBlocks, DominanceInfo &DT)
+      : SILCloner<RegionCloner>(*EntryBB->getParent()), DomTree(DT),
+        StartBB(EntryBB), OutsideBBs(ExitBlocks.begin(), ExitBlocks.end()) {}
+
+  /// Clone the region and return the cloned start block.
+  SILBasicBlock *cloneRegion();
+
+  llvm::MapVector<SILBasicBlock *, SILBasicBlock *> &getBBMap() { return BBMap; }
+
+  /// Return the clone of the instruction \p Orig, or null if \p Orig is not
+  /// part of the cloned region.
+  SILInstruction *getClonedInstruction(SILInstruction *Orig) const {
+    auto It = InstructionMap.find(Orig);
+    if (It == InstructionMap.end())
+      return nullptr;
+    return It->second;
+  }
+
+protected:
+  /// Clone the dominator tree from the original region to the cloned region.
+  void fixDomTreeNodes(DominanceInfoNode *OrigNode);
+
+  SILValue remapValue(SILValue V);
+
+  void postProcess(SILInstruction *Orig, SILInstruction *Cloned) {
+    SILCloner<RegionCloner>::postProcess(Orig, Cloned);
+  }
+
+  /// Update SSA form for values that are used outside the region.
+  void updateSSAForValue(SILBasicBlock *OrigBB, SILValue V,
+                         SILSSAUpdater &SSAUp);
+
+  void updateSSAForm();
+};
+
+} // end swift namespace
+
+#endif
@@ -293,6 +293,18 @@ private:
 
   std::unique_ptr<SerializedObjCMethodTable> ObjCMethods;
 
+  class RecordNameTableInfo;
+  using SerializedRecordNameTable =
+    llvm::OnDiskIterableChainedHashTable<RecordNameTableInfo>;
+
+  /// Maps the members record of a nominal type or extension and a name to the
+  /// members with that name.
+  std::unique_ptr<SerializedRecordNameTable> DeclMemberNames;
+
+  /// Maps the conformance list of a nominal type or extension and a protocol
+  /// name to the offsets of the conformances to protocols with that name.
+  std::unique_ptr<SerializedRecordNameTable> ConformancesByProtocol;
+
   llvm::DenseMap<const ValueDecl *, Identifier> PrivateDiscriminatorsByValue;
 
   TinyPtrVector<Decl *> ImportDecls;
@@ -404,6 +416,11 @@ private:
   std::unique_ptr<ModuleFile::SerializedObjCMethodTable>
   readObjCMethodTable(ArrayRef<uint64_t> fields, StringRef blobData);
 
+  /// Read an on-disk table keyed by decls block record and name, stored in
+  /// index_block::RecordNameTableLayout format.
+  std::unique_ptr<ModuleFile::SerializedRecordNameTable>
+  readRecordNameTable(ArrayRef<uint64_t> fields, StringRef blobData);
+
   /// Reads the index block, which contains global tables.
   ///
   /// Returns false if there was an error.
@@ -646,10 +663,19 @@ public:
   virtual void loadAllMembers(Decl *D,
                               uint64_t contextData) override;
 
+  virtual bool loadNamedMembers(const IterableDeclContext *IDC,
+                                Identifier name, uint64_t contextData,
+                                SmallVectorImpl<ValueDecl *> &members) override;
+
   virtual void
   loadAllConformances(const Decl *D, uint64_t contextData,
                     SmallVectorImpl<ProtocolConformance*> &Conforms) override;
 
+  virtual bool
+  loadConformancesTo(const Decl *D, uint64_t contextData,
+                     ProtocolDecl *protocol,
+                     SmallVectorImpl<ProtocolConformance*> &Conforms) override;
+
   virtual TypeLoc loadAssociatedTypeDefault(const AssociatedTypeDecl *ATD,
                                             uint64_t contextData) override;
 
@@ -54,7 +54,7 @@ const uint16_t VERSION_MAJOR = 0;
 /// in source control, you should also update the comment to briefly
 /// describe what change you made. The content of this comment isn't important;
 /// it just ensures a conflict if two people change the module format.
-const uint16_t VERSION_MINOR = 283; // Last change: witness markers removed
+const uint16_t VERSION_MINOR = 287; // Last change: record name table layout
 
 using DeclID = PointerEmbeddedInt<unsigned, 31>;
 using DeclIDField = BCFixed<31>;
@@ -1452,6 +1452,15 @@ namespace index_block {
     NORMAL_CONFORMANCE_OFFSETS,
 
     PRECEDENCE_GROUPS,
+
+    /// The member name index, which maps a nominal type or extension and a
+    /// member name to the members with that name.
+    DECL_MEMBER_NAMES,
+
+    /// The conformance protocol index, which maps the conformance list of a
+    /// nominal type or extension and a protocol name to the conformances
+    /// to protocols with that name.
+    CONFORMANCES_BY_PROTOCOL,
   };
 
   using OffsetsLayout = BCGenericRecordLayout<
@@ -1476,6 +1485,14 @@ namespace index_block {
     BCBlob         // map from Objective-C selectors to methods with that selector
   >;
 
+  /// Used for DECL_MEMBER_NAMES and CONFORMANCES_BY_PROTOCOL, whose IDs do
+  /// not fit in the abbreviated record ID of the layouts above.
+  using RecordNameTableLayout = BCGenericRecordLayout<
+    BCFixed<5>,  // record ID
+    BCVBR<16>,   // table offset within the blob (see below)
+    BCBlob       // map from (decls block record, name) to 32-bit values
+  >;
+
   using EntryPointLayout = BCRecordLayout<
     ENTRY_POINT,
     DeclIDField  // the ID of the main class; 0 if there was a main source file
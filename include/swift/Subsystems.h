@@ -120,6 +120,12 @@ namespace swift {
                              PersistentParserState &PersistentState,
                              CodeCompletionCallbacksFactory *Factory);
 
+  /// \brief Parse only the delayed bodies of transparent and inlineable
+  /// functions in \p DC, which may be needed by other files even if the
+  /// file containing them is not type-checked.
+  void performDelayedParsingOfInlinableBodies(
+      DeclContext *DC, PersistentParserState &PersistentState);
+
   /// \brief Lex and return a vector of tokens for the given buffer.
   std::vector<Token> tokenize(const LangOptions &LangOpts,
                               const SourceManager &SM, unsigned BufferID,
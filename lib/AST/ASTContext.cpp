@@ -31,8 +31,10 @@
 #include "swift/AST/RawComment.h"
 #include "swift/AST/TypeCheckerDebugConsumer.h"
 #include "swift/Basic/Fallthrough.h"
+#include "swift/Basic/MemoryStats.h"
 #include "swift/Basic/SourceManager.h"
 #include "swift/Basic/StringExtras.h"
+#include "swift/Basic/Timer.h"
 #include "swift/Parse/Lexer.h" // bad dependency
 #include "clang/AST/Attr.h"
 #include "clang/AST/DeclObjC.h"
@@ -40,13 +42,22 @@
 #include "clang/Lex/Preprocessor.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/SaveAndRestore.h"
 #include <algorithm>
 #include <memory>
 
 using namespace swift;
 
+#define DEBUG_TYPE "ASTContext"
+
+STATISTIC(NumArchetypeBuilderCacheHits,
+          "# of canonical signatures whose archetype builder was reused");
+STATISTIC(NumArchetypeBuilderCacheMisses,
+          "# of archetype builders built for canonical signatures");
+
 LazyResolver::~LazyResolver() = default;
 DelegatingLazyResolver::~DelegatingLazyResolver() = default;
 void ModuleLoader::anchor() {}
@@ -219,6 +230,9 @@ struct ASTContext::Implementation {
   llvm::DenseMap<std::pair<GenericSignature *, ModuleDecl *>,
                  std::unique_ptr<ArchetypeBuilder>> ArchetypeBuilders;
 
+  /// Whether an archetype builder for a canonical signature is being built.
+  bool BuildingArchetypeBuilder = false;
+
   /// The set of property names that show up in the defining module of a
   /// class.
   llvm::DenseMap<std::pair<const ClassDecl *, char>,
@@ -342,6 +356,10 @@ struct ASTContext::Implementation {
   /// \brief The current constraint solver arena, if any.
   std::unique_ptr<ConstraintSolverArena> CurrentConstraintSolverArena;
 
+  /// The most memory used by any constraint solver arena, including its
+  /// allocator, for -print-memory-stats.
+  size_t PeakSolverMemory = 0;
+
   Arena &getArena(AllocationArena arena) {
     switch (arena) {
     case AllocationArena::Permanent:
@@ -373,6 +391,12 @@ ConstraintCheckerArenaRAII(ASTContext &self, llvm::BumpPtrAllocator &allocator)
 }
 
 ConstraintCheckerArenaRAII::~ConstraintCheckerArenaRAII() {
+  // A bump allocator never shrinks, so its size now is its peak.
+  auto &arena = *Self.Impl.CurrentConstraintSolverArena;
+  Self.Impl.PeakSolverMemory =
+    std::max(Self.Impl.PeakSolverMemory,
+             arena.getTotalMemory() + arena.Allocator.getTotalMemory());
+
   Self.Impl.CurrentConstraintSolverArena.reset(
     (ASTContext::Implementation::ConstraintSolverArena *)Data);
 }
@@ -1261,8 +1285,20 @@ ArchetypeBuilder *ASTContext::getOrCreateArchetypeBuilder(
   // Check whether we already have an archetype builder for this
   // signature and module.
   auto known = Impl.ArchetypeBuilders.find({sig, mod});
-  if (known != Impl.ArchetypeBuilders.end())
+  if (known != Impl.ArchetypeBuilders.end()) {
+    ++NumArchetypeBuilderCacheHits;
     return known->second.get();
+  }
+
+  ++NumArchetypeBuilderCacheMisses;
+
+  // Building one archetype builder can build others, e.g. for the protocols
+  // its associated types conform to. Only time the outermost one, because a
+  // timer can't be started again while it is running.
+  Optional<SharedTimer> timer;
+  if (!Impl.BuildingArchetypeBuilder)
+    timer.emplace("Build archetypes for canonical signatures");
+  llvm::SaveAndRestore<bool> building(Impl.BuildingArchetypeBuilder, true);
 
   // Create a new archetype builder with the given signature.
   auto builder = new ArchetypeBuilder(*mod, Diags);
@@ -1530,6 +1566,75 @@ size_t ASTContext::getSolverMemory() const {
   return Size;
 }
 
+bool ASTContext::hasActiveConstraintSolver() const {
+  return Impl.CurrentConstraintSolverArena != nullptr;
+}
+
+size_t ASTContext::getPeakSolverMemory() const {
+  return Impl.PeakSolverMemory;
+}
+
+/// Adds the uniquing table \p name, and the fixed size of the \c T objects it
+/// uniques, to \p stats.
+template <typename T, typename Key, typename Value>
+static void addTable(MemoryStats &stats, StringRef name,
+                     const llvm::DenseMap<Key, Value> &table) {
+  stats.addTable(name, table.size(),
+                 llvm::capacity_in_bytes(table) + table.size() * sizeof(T));
+}
+
+template <typename T>
+static void addTable(MemoryStats &stats, StringRef name,
+                     llvm::FoldingSet<T> &table) {
+  stats.addTable(name, table.size(),
+                 table.capacity() * sizeof(void *) + table.size() * sizeof(T));
+}
+
+void ASTContext::collectMemoryStats(MemoryStats &stats) const {
+  stats.addArena("AST", Impl.Allocator.getTotalMemory());
+  stats.addArena("AST tables", getTotalMemory() -
+                               Impl.Allocator.getTotalMemory() -
+                               getSolverMemory());
+  stats.addArena("Constraint solver (peak)", getPeakSolverMemory());
+
+  auto &arena = Impl.Permanent;
+  addTable<TupleType>(stats, "TupleTypes", arena.TupleTypes);
+  addTable<MetatypeType>(stats, "MetatypeTypes", arena.MetatypeTypes);
+  addTable<ExistentialMetatypeType>(stats, "ExistentialMetatypeTypes",
+                                    arena.ExistentialMetatypeTypes);
+  addTable<FunctionType>(stats, "FunctionTypes", arena.FunctionTypes);
+  addTable<ArraySliceType>(stats, "ArraySliceTypes", arena.ArraySliceTypes);
+  addTable<DictionaryType>(stats, "DictionaryTypes", arena.DictionaryTypes);
+  addTable<OptionalType>(stats, "OptionalTypes", arena.OptionalTypes);
+  addTable<ParenType>(stats, "ParenTypes", arena.ParenTypes);
+  addTable<LValueType>(stats, "LValueTypes", arena.LValueTypes);
+  addTable<InOutType>(stats, "InOutTypes", arena.InOutTypes);
+  addTable<SubstitutedType>(stats, "SubstitutedTypes", arena.SubstitutedTypes);
+  addTable<DependentMemberType>(stats, "DependentMemberTypes",
+                                arena.DependentMemberTypes);
+  addTable<EnumType>(stats, "EnumTypes", arena.EnumTypes);
+  addTable<StructType>(stats, "StructTypes", arena.StructTypes);
+  addTable<ClassType>(stats, "ClassTypes", arena.ClassTypes);
+  addTable<BoundGenericType>(stats, "BoundGenericTypes",
+                             arena.BoundGenericTypes);
+  addTable<ProtocolType>(stats, "ProtocolTypes", arena.ProtocolTypes);
+  addTable<NormalProtocolConformance>(stats, "NormalConformances",
+                                      arena.NormalConformances);
+  addTable<SpecializedProtocolConformance>(stats, "SpecializedConformances",
+                                           arena.SpecializedConformances);
+  addTable<InheritedProtocolConformance>(stats, "InheritedConformances",
+                                         arena.InheritedConformances);
+  addTable<GenericFunctionType>(stats, "GenericFunctionTypes",
+                                Impl.GenericFunctionTypes);
+  addTable<SILFunctionType>(stats, "SILFunctionTypes", Impl.SILFunctionTypes);
+  addTable<ProtocolCompositionType>(stats, "ProtocolCompositionTypes",
+                                    Impl.ProtocolCompositionTypes);
+  addTable<GenericSignature>(stats, "GenericSignatures",
+                             Impl.GenericSignatures);
+  addTable<ArchetypeBuilder>(stats, "ArchetypeBuilders",
+                             Impl.ArchetypeBuilders);
+}
+
 size_t ASTContext::Implementation::Arena::getTotalMemory() const {
   return sizeof(*this) +
     // TupleTypes ?
@@ -17,11 +17,20 @@
 #include "ConformanceLookupTable.h"
 #include "swift/AST/ASTContext.h"
 #include "swift/AST/Decl.h"
+#include "swift/AST/LazyResolver.h"
 #include "swift/AST/Module.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/SaveAndRestore.h"
 
+#define DEBUG_TYPE "Protocol conformance lookup"
+
 using namespace swift;
 
+STATISTIC(NumConformanceListsLoaded,
+          "# of serialized conformance lists loaded in full");
+STATISTIC(NumConformanceListsSearched,
+          "# of serialized conformance lists searched for one protocol");
+
 DeclContext *ConformanceLookupTable::ConformanceSource::getDeclContext() const {
   switch (getKind()) {
   case ConformanceEntryKind::Inherited:
@@ -150,12 +159,9 @@ void ConformanceLookupTable::forEachInStage(ConformanceStage stage,
     lastProcessed.setInt(true);
 
     // If we have conformances we can load, do so.
-    // FIXME: This could be lazier.
     auto loader = nominal->takeConformanceLoader();
     if (loader.first) {
-      SmallVector<ProtocolConformance *, 2> conformances;
-      loader.first->loadAllConformances(nominal, loader.second, conformances);
-      loadAllConformances(nominal, nominal, conformances);
+      loadConformances(nominal, nominal, loader);
     } else if (nominal->getParentSourceFile() && resolver) {
       resolver->resolveDeclSignature(nominal);
     }
@@ -180,12 +186,9 @@ void ConformanceLookupTable::forEachInStage(ConformanceStage stage,
     lastProcessed.setPointer(next);
 
     // If we have conformances we can load, do so.
-    // FIXME: This could be lazier.
     auto loader = next->takeConformanceLoader();
     if (loader.first) {
-      SmallVector<ProtocolConformance *, 2> conformances;
-      loader.first->loadAllConformances(next, loader.second, conformances);
-      loadAllConformances(nominal, next, conformances);
+      loadConformances(nominal, next, loader);
     } else if (next->getParentSourceFile()) {
       if (!resolver) {
         // We have a parsed extension that we can't resolve well enough to
@@ -360,9 +363,9 @@ void ConformanceLookupTable::updateLookupTable(NominalTypeDecl *nominal,
     // conformances.
     updateLookupTable(nominal, ConformanceStage::ExpandedImplied, resolver);
     
-    /// Determine whether any extensions were added that might require
-    /// us to compute conformances again.
-    bool anyChanged = false;
+    /// Determine whether any extensions were added or any conformances
+    /// were loaded that might require us to compute conformances again.
+    bool anyChanged = loadAllLazyConformances(nominal);
     forEachInStage(stage, nominal, resolver,
                    [&](NominalTypeDecl *nominal) {
                      anyChanged = true;
@@ -412,6 +415,71 @@ void ConformanceLookupTable::loadAllConformances(
   }
 }
 
+void ConformanceLookupTable::loadConformances(
+       NominalTypeDecl *nominal,
+       Decl *decl,
+       std::pair<LazyMemberLoader *, uint64_t> loader) {
+  if (nominal->getASTContext().LangOpts.EnableLazyConformanceLoading) {
+    LazyConformanceContexts.push_back({decl, loader.first, loader.second});
+    return;
+  }
+
+  ++NumConformanceListsLoaded;
+  SmallVector<ProtocolConformance *, 2> conformances;
+  loader.first->loadAllConformances(decl, loader.second, conformances);
+  loadAllConformances(nominal, cast<DeclContext>(decl), conformances);
+}
+
+void ConformanceLookupTable::loadLazyConformances(NominalTypeDecl *nominal,
+                                                  ProtocolDecl *protocol) {
+  if (LazyConformanceContexts.empty())
+    return;
+
+  // Loading conformances can add contexts, or look up conformances of this
+  // type, re-entrantly. Note our progress before loading from each context.
+  for (unsigned i = LazyConformancesSearched[protocol];
+       i != LazyConformanceContexts.size();
+       i = LazyConformancesSearched[protocol]) {
+    LazyConformancesSearched[protocol] = i + 1;
+    auto lazy = LazyConformanceContexts[i];
+    if (!lazy.Loader)
+      continue;
+
+    SmallVector<ProtocolConformance *, 2> conformances;
+    if (lazy.Loader->loadConformancesTo(lazy.D, lazy.ContextData, protocol,
+                                        conformances)) {
+      ++NumConformanceListsSearched;
+    } else {
+      // The loader can't search by protocol; load all of the conformances
+      // of this context instead.
+      ++NumConformanceListsLoaded;
+      LazyConformanceContexts[i].Loader = nullptr;
+      lazy.Loader->loadAllConformances(lazy.D, lazy.ContextData,
+                                       conformances);
+    }
+    loadAllConformances(nominal, cast<DeclContext>(lazy.D), conformances);
+  }
+}
+
+bool ConformanceLookupTable::loadAllLazyConformances(NominalTypeDecl *nominal) {
+  if (LazyConformanceContexts.empty())
+    return false;
+
+  auto contexts = std::move(LazyConformanceContexts);
+  LazyConformanceContexts.clear();
+  LazyConformancesSearched.clear();
+  for (const auto &lazy : contexts) {
+    if (!lazy.Loader)
+      continue;
+
+    ++NumConformanceListsLoaded;
+    SmallVector<ProtocolConformance *, 2> conformances;
+    lazy.Loader->loadAllConformances(lazy.D, lazy.ContextData, conformances);
+    loadAllConformances(nominal, cast<DeclContext>(lazy.D), conformances);
+  }
+  return true;
+}
+
 namespace {
   /// Visit the protocols referenced by the given type, which was
   /// uttered at the given location.
@@ -898,14 +966,17 @@ bool ConformanceLookupTable::lookupConformance(
        ProtocolDecl *protocol, 
        LazyResolver *resolver,
        SmallVectorImpl<ProtocolConformance *> &conformances) {
-  // Update to record all explicit and inherited conformances.
+  // Update to record all explicit and inherited conformances, and load
+  // any serialized conformances to this protocol.
   updateLookupTable(nominal, ConformanceStage::Inherited, resolver);
+  loadLazyConformances(nominal, protocol);
 
   // Look for conformances to this protocol.
   auto known = Conformances.find(protocol);
   if (known == Conformances.end()) {
     // If we didn't find anything, expand implied conformances.
     updateLookupTable(nominal, ConformanceStage::ExpandedImplied, resolver);
+    loadLazyConformances(nominal, protocol);
     known = Conformances.find(protocol);
 
     // We didn't find anything.
@@ -934,6 +1005,7 @@ void ConformanceLookupTable::lookupConformances(
   // We need to expand all implied conformances before we can find
   // those conformances that pertain to this declaration context.
   updateLookupTable(nominal, ConformanceStage::ExpandedImplied, resolver);
+  loadAllLazyConformances(nominal);
 
   /// Resolve conformances for each of the protocols to which this
   /// declaration may provide a conformance. Only some of these will
@@ -1002,6 +1074,7 @@ void ConformanceLookupTable::getAllProtocols(
   // We need to expand all implied conformances to find the complete
   // set of protocols to which this nominal type conforms.
   updateLookupTable(nominal, ConformanceStage::ExpandedImplied, resolver);
+  loadAllLazyConformances(nominal);
 
   // Gather all of the protocols.
   for (const auto &conformance : Conformances) {
@@ -85,6 +85,23 @@ class ConformanceLookupTable {
   /// have parsed extensions.
   llvm::SetVector<ExtensionDecl *> DelayedExtensionDecls[NumConformanceStages];
 
+  /// A nominal type or extension from a serialized module whose
+  /// conformances have not been loaded yet.
+  struct LazyConformanceContext {
+    Decl *D;
+    /// The loader, or null if the conformances have been loaded in full.
+    LazyMemberLoader *Loader;
+    uint64_t ContextData;
+  };
+
+  /// The contexts whose conformances are loaded on demand, one protocol at
+  /// a time, when lazy conformance loading is enabled.
+  SmallVector<LazyConformanceContext, 2> LazyConformanceContexts;
+
+  /// The number of entries at the start of \c LazyConformanceContexts that
+  /// have been searched for conformances to each protocol.
+  llvm::DenseMap<ProtocolDecl *, unsigned> LazyConformancesSearched;
+
   struct ConformanceEntry;
 
   /// Describes the "source" of a conformance, indicating where the
@@ -422,6 +439,22 @@ class ConformanceLookupTable {
                            DeclContext *dc,
                            ArrayRef<ProtocolConformance *> conformances);
 
+  /// Load the protocol conformances of the given (serialized) nominal type
+  /// or extension, or defer loading them until they are looked up if lazy
+  /// conformance loading is enabled.
+  void loadConformances(NominalTypeDecl *nominal, Decl *decl,
+                        std::pair<LazyMemberLoader *, uint64_t> loader);
+
+  /// Load the conformances to the given protocol from the contexts whose
+  /// conformances are loaded on demand.
+  void loadLazyConformances(NominalTypeDecl *nominal, ProtocolDecl *protocol);
+
+  /// Load all of the conformances from the contexts whose conformances are
+  /// loaded on demand.
+  ///
+  /// \returns true if there were any such contexts.
+  bool loadAllLazyConformances(NominalTypeDecl *nominal);
+
 public:
   /// Create a new conformance lookup table.
   ConformanceLookupTable(ASTContext &ctx, NominalTypeDecl *nominal,
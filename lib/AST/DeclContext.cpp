@@ -816,6 +816,10 @@ DeclRange IterableDeclContext::getMembers() const {
   return DeclRange(FirstDecl, nullptr);
 }
 
+DeclRange IterableDeclContext::getCurrentMembersWithoutLoading() const {
+  return DeclRange(FirstDecl, nullptr);
+}
+
 /// Add a member to this context.
 void IterableDeclContext::addMember(Decl *member, Decl *Hint) {
   // Add the member to the list of declarations without notification.
@@ -26,10 +26,16 @@
 #include "swift/Basic/SourceManager.h"
 #include "swift/Basic/STLExtras.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/TinyPtrVector.h"
 
+#define DEBUG_TYPE "Name lookup"
+
 using namespace swift;
 
+STATISTIC(NumNamedMemberLookups,
+          "# of direct member lookups that loaded members by name");
+
 void DebuggerClient::anchor() {}
 
 void AccessFilteringDeclConsumer::foundDecl(ValueDecl *D,
@@ -997,6 +1003,11 @@ class swift::MemberLookupTable {
   /// Lookup table mapping names to the set of declarations with that name.
   LookupTable Lookup;
 
+  /// The names whose members have been added by addNamedMembers(), mapped to
+  /// the last extension that was searched for each name (or null if only
+  /// the nominal type itself was).
+  llvm::DenseMap<Identifier, ExtensionDecl *> NamesIncluded;
+
 public:
   /// Create a new member lookup table.
   explicit MemberLookupTable(ASTContext &ctx);
@@ -1007,6 +1018,15 @@ public:
   /// Update a lookup table with members from newly-added extensions.
   void updateLookupTable(NominalTypeDecl *nominal);
 
+  /// Add the members of \p nominal and its extensions named \p name to the
+  /// lookup table, loading lazily-loaded members by name rather than all
+  /// at once.
+  ///
+  /// \returns false if the members of \p nominal cannot be loaded by name,
+  /// in which case nothing was added.
+  bool addNamedMembers(NominalTypeDecl *nominal, Identifier name,
+                       bool ignoreNewExtensions);
+
   /// \brief Add the given member to the lookup table.
   void addMember(Decl *members);
 
@@ -1148,6 +1168,76 @@ void MemberLookupTable::updateLookupTable(NominalTypeDecl *nominal) {
   }
 }
 
+/// Collect the members of \p IDC named \p name.
+///
+/// \returns false if \p IDC has lazily-loaded members and its loader cannot
+/// load them by name.
+static bool collectNamedMembers(const IterableDeclContext *IDC,
+                                Identifier name,
+                                SmallVectorImpl<ValueDecl *> &results) {
+  if (IDC->isLazy()) {
+    if (!IDC->getLoader()->loadNamedMembers(IDC, name,
+                                            IDC->getLoaderContextData(),
+                                            results))
+      return false;
+  }
+
+  // Members that were added directly rather than by the loader.
+  for (auto member : IDC->getCurrentMembersWithoutLoading()) {
+    auto vd = dyn_cast<ValueDecl>(member);
+    if (vd && vd->hasName() && vd->getName() == name)
+      results.push_back(vd);
+  }
+  return true;
+}
+
+bool MemberLookupTable::addNamedMembers(NominalTypeDecl *nominal,
+                                        Identifier name,
+                                        bool ignoreNewExtensions) {
+  // Loading members can look up this name again; note that it is included
+  // up front so that we don't load the same members re-entrantly.
+  SmallVector<ValueDecl *, 4> members;
+  ExtensionDecl *lastSearched = nullptr;
+  auto known = NamesIncluded.find(name);
+  if (known == NamesIncluded.end()) {
+    NamesIncluded[name] = nullptr;
+    if (!collectNamedMembers(nominal, name, members)) {
+      NamesIncluded.erase(name);
+      return false;
+    }
+    ++NumNamedMemberLookups;
+  } else {
+    lastSearched = known->second;
+  }
+
+  if (!ignoreNewExtensions) {
+    (void)nominal->getExtensions();
+
+    // Search each of the extensions that we have not yet searched for this
+    // name, loading all of the members of those that can't be searched by
+    // name.
+    for (auto next = lastSearched
+                       ? lastSearched->NextExtension.getPointer()
+                       : nominal->FirstExtension;
+         next;
+         (lastSearched = next, next = next->NextExtension.getPointer())) {
+      if (collectNamedMembers(next, name, members))
+        continue;
+
+      for (auto member : next->getMembers()) {
+        auto vd = dyn_cast<ValueDecl>(member);
+        if (vd && vd->hasName() && vd->getName() == name)
+          members.push_back(vd);
+      }
+    }
+    NamesIncluded[name] = lastSearched;
+  }
+
+  for (auto member : members)
+    addMember(member);
+  return true;
+}
+
 void MemberLookupTable::destroy() {
   this->~MemberLookupTable();
 }
@@ -1210,16 +1300,33 @@ void NominalTypeDecl::makeMemberVisible(ValueDecl *member) {
 
 ArrayRef<ValueDecl *> NominalTypeDecl::lookupDirect(DeclName name,
                                                     bool ignoreNewExtensions) {
-  // Make sure we have the complete list of members (in this nominal and in all
-  // extensions).
-  if (!ignoreNewExtensions) {
-    for (auto E : getExtensions())
-      (void)E->getMembers();
+  // If the members of this type have not been loaded and walked yet, try to
+  // load only the members with this name.
+  //
+  // Protocols are excluded because loading their members also reads their
+  // default witness tables.
+  auto &ctx = getASTContext();
+  bool loadedByName = false;
+  if (ctx.LangOpts.EnableNamedLazyMemberLoading && hasLazyMembers() &&
+      !LookupTable.getInt() && !isa<ProtocolDecl>(this)) {
+    if (!LookupTable.getPointer())
+      LookupTable.setPointer(new (ctx) MemberLookupTable(ctx));
+    loadedByName = LookupTable.getPointer()->addNamedMembers(
+                     this, name.getBaseName(), ignoreNewExtensions);
   }
 
-  (void)getMembers();
+  if (!loadedByName) {
+    // Make sure we have the complete list of members (in this nominal and in
+    // all extensions).
+    if (!ignoreNewExtensions) {
+      for (auto E : getExtensions())
+        (void)E->getMembers();
+    }
+
+    (void)getMembers();
 
-  prepareLookupTable(ignoreNewExtensions);
+    prepareLookupTable(ignoreNewExtensions);
+  }
 
   // Look for the declarations with this name.
   auto known = LookupTable.getPointer()->find(name);
@@ -84,6 +84,15 @@ swift::demangle_wrappers::demangleSymbolAsNode(llvm::StringRef MangledName,
                                                MangledName.size(), Options);
 }
 
+NodePointer
+swift::demangle_wrappers::demangleSymbolAsNode(swift::Demangle::Context &Ctx,
+                                               llvm::StringRef MangledName,
+                                               const DemangleOptions &Options) {
+  PrettyStackTraceStringAction prettyStackTrace("demangling string",
+                                                MangledName);
+  return Ctx.demangleSymbolAsNode(MangledName, Options);
+}
+
 std::string nodeToString(NodePointer Root,
                          const DemangleOptions &Options) {
   PrettyStackTraceNode trace("printing", Root.get());
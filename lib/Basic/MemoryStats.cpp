@@ -0,0 +1,126 @@
+//===--- MemoryStats.cpp - Memory used by a compilation -------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/MemoryStats.h"
+#include "swift/Basic/JSONSerialization.h"
+#include "llvm/Config/config.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+#if LLVM_ON_UNIX
+#include <sys/resource.h>
+#endif
+
+using namespace swift;
+
+namespace {
+/// The object printed by MemoryStats::print.
+struct Report {
+  uint64_t PeakRSS;
+  std::vector<MemoryStats::Arena> Arenas;
+  std::vector<MemoryStats::Phase> Phases;
+  std::vector<MemoryStats::Table> LargestTables;
+};
+} // end anonymous namespace
+
+namespace swift {
+namespace json {
+template <typename T>
+struct ArrayTraits<std::vector<T>> {
+  static size_t size(Output &out, std::vector<T> &seq) {
+    return seq.size();
+  }
+  static T &element(Output &out, std::vector<T> &seq, size_t index) {
+    return seq[index];
+  }
+};
+
+template <>
+struct ObjectTraits<MemoryStats::Phase> {
+  static void mapping(Output &out, MemoryStats::Phase &value) {
+    out.mapRequired("name", value.Name);
+    out.mapRequired("heap-in-use", value.HeapInUse);
+    out.mapRequired("peak-rss", value.PeakRSS);
+  }
+};
+
+template <>
+struct ObjectTraits<MemoryStats::Arena> {
+  static void mapping(Output &out, MemoryStats::Arena &value) {
+    out.mapRequired("name", value.Name);
+    out.mapRequired("bytes", value.Bytes);
+  }
+};
+
+template <>
+struct ObjectTraits<MemoryStats::Table> {
+  static void mapping(Output &out, MemoryStats::Table &value) {
+    out.mapRequired("name", value.Name);
+    out.mapRequired("entries", value.Entries);
+    out.mapRequired("bytes", value.Bytes);
+  }
+};
+
+template <>
+struct ObjectTraits<Report> {
+  static void mapping(Output &out, Report &value) {
+    out.mapRequired("peak-rss", value.PeakRSS);
+    out.mapRequired("arenas", value.Arenas);
+    out.mapRequired("phases", value.Phases);
+    out.mapRequired("largest-tables", value.LargestTables);
+  }
+};
+} // end namespace json
+} // end namespace swift
+
+void MemoryStats::recordPhase(StringRef name) {
+  Phases.push_back({name, getHeapInUse(), getPeakResidentSetSize()});
+}
+
+void MemoryStats::print(raw_ostream &OS, unsigned maxTables) const {
+  Report report;
+  report.PeakRSS = getPeakResidentSetSize();
+  report.Arenas = Arenas;
+  report.Phases = Phases;
+  report.LargestTables = Tables;
+  std::stable_sort(report.LargestTables.begin(), report.LargestTables.end(),
+                   [](const Table &lhs, const Table &rhs) {
+                     return lhs.Bytes > rhs.Bytes;
+                   });
+  if (report.LargestTables.size() > maxTables)
+    report.LargestTables.resize(maxTables);
+
+  json::Output out(OS);
+  out << report;
+  OS << '\n';
+}
+
+uint64_t MemoryStats::getHeapInUse() {
+  return llvm::sys::Process::GetMallocUsage();
+}
+
+uint64_t MemoryStats::getPeakResidentSetSize() {
+#if LLVM_ON_UNIX
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#if defined(__APPLE__)
+  return usage.ru_maxrss;
+#else
+  // Linux and the BSDs report the size in kilobytes.
+  return uint64_t(usage.ru_maxrss) * 1024;
+#endif
+#else
+  return 0;
+#endif
+}
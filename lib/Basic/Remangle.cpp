@@ -537,6 +537,9 @@ void Remangler::mangleFunctionSignatureSpecializationParam(Node *node) {
   case FunctionSigSpecializationParamKind::BoxToStack:
     Out << "k_";
     return;
+  case FunctionSigSpecializationParamKind::ExistentialToGeneric:
+    Out << "e_";
+    return;
   default:
     if (kindValue &
         unsigned(FunctionSigSpecializationParamKind::Dead))
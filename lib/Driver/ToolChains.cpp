@@ -310,6 +310,9 @@ ToolChain::constructInvocation(const CompileJobAction &job,
 
   context.Args.AddLastArg(Arguments, options::OPT_parse_sil);
 
+  // Index data is only recorded by compile jobs, which see the source files.
+  context.Args.AddLastArg(Arguments, options::OPT_index_store_path);
+
   Arguments.push_back("-module-name");
   Arguments.push_back(context.Args.MakeArgString(context.OI.ModuleName));
 
@@ -167,10 +167,13 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.EmitSortedSIL |= Args.hasArg(OPT_emit_sorted_sil);
 
   Opts.DelayedFunctionBodyParsing |= Args.hasArg(OPT_delayed_function_body_parsing);
+  if (Args.hasArg(OPT_disable_delayed_non_primary_function_body_parsing))
+    Opts.DelayNonPrimaryFunctionBodyParsing = false;
   Opts.EnableTesting |= Args.hasArg(OPT_enable_testing);
   Opts.EnableResilience |= Args.hasArg(OPT_enable_resilience);
 
   Opts.PrintStats |= Args.hasArg(OPT_print_stats);
+  Opts.PrintMemoryStats |= Args.hasArg(OPT_print_memory_stats);
   Opts.PrintClangStats |= Args.hasArg(OPT_print_clang_stats);
   Opts.DebugTimeFunctionBodies |= Args.hasArg(OPT_debug_time_function_bodies);
   Opts.DebugTimeCompilation |= Args.hasArg(OPT_debug_time_compilation);
@@ -378,6 +381,8 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
         Opts.ImmediateArgv.push_back(A->getValue(i));
       }
     }
+    if (const Arg *A = Args.getLastArg(OPT_immediate_object_cache_path))
+      Opts.ImmediateObjectCachePath = A->getValue();
   }
 
   if (TreatAsSIL)
@@ -627,6 +632,10 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     Opts.FixitsOutputPath = A->getValue();
   }
 
+  if (const Arg *A = Args.getLastArg(OPT_index_store_path)) {
+    Opts.IndexStorePath = A->getValue();
+  }
+
   bool IsSIB =
     Opts.RequestedAction == FrontendOptions::EmitSIB ||
     Opts.RequestedAction == FrontendOptions::EmitSIBGen;
@@ -833,6 +842,10 @@ static bool ParseLangArgs(LangOptions &Opts, ArgList &Args,
   }
   
   Opts.EnableASTScopeLookup |= Args.hasArg(OPT_enable_astscope_lookup);
+  Opts.EnableNamedLazyMemberLoading |=
+    Args.hasArg(OPT_enable_named_lazy_member_loading);
+  Opts.EnableLazyConformanceLoading |=
+    Args.hasArg(OPT_enable_lazy_conformance_loading);
   Opts.DebugConstraintSolver |= Args.hasArg(OPT_debug_constraints);
   Opts.IterativeTypeChecker |= Args.hasArg(OPT_iterative_type_checker);
   Opts.DebugGenericSignatures |= Args.hasArg(OPT_debug_generic_signatures);
@@ -1274,6 +1287,15 @@ static bool ParseIRGenArgs(IRGenOptions &Opts, ArgList &Args,
     }
     Opts.StackPromotionSizeLimit = limit;
   }
+  if (const Arg *A = Args.getLastArg(OPT_outline_value_operations_threshold)) {
+    unsigned threshold;
+    if (StringRef(A->getValue()).getAsInteger(10, threshold)) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+      return true;
+    }
+    Opts.ValueOperationOutliningThreshold = threshold;
+  }
 
   if (Args.hasArg(OPT_autolink_force_load))
     Opts.ForceLoadSymbolName = Args.getLastArgValue(OPT_module_link_name);
@@ -1310,6 +1332,8 @@ static bool ParseIRGenArgs(IRGenOptions &Opts, ArgList &Args,
 
   Opts.UseSwiftCall = Args.hasArg(OPT_enable_swiftcall);
 
+  Opts.ReleaseSILDuringIRGen |= Args.hasArg(OPT_release_sil_during_irgen);
+
   // This is set to true by default.
   Opts.UseIncrementalLLVMCodeGen &=
     !Args.hasArg(OPT_disable_incremental_llvm_codegeneration);
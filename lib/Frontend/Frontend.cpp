@@ -383,6 +383,18 @@ void CompilerInstance::performSema() {
     DelayedCB.reset(new AlwaysDelayedCallbacks);
   }
 
+  // Function bodies of non-primary files are not type-checked, so only
+  // record them and parse the few which may be needed later.
+  AlwaysDelayedCallbacks NonPrimaryDelayedCB;
+  bool DelayNonPrimaryBodies =
+      !DelayedCB && PrimaryBufferID != NO_SUCH_BUFFER &&
+      Invocation.isDelayedNonPrimaryFunctionBodyParsing();
+  auto getDelayedCallbacks = [&](bool IsPrimary) -> DelayedParsingCallbacks * {
+    if (DelayNonPrimaryBodies && !IsPrimary)
+      return &NonPrimaryDelayedCB;
+    return DelayedCB.get();
+  };
+
   PersistentParserState PersistentState;
 
   // Make sure the main file is the first file in the module. This may only be
@@ -441,7 +453,7 @@ void CompilerInstance::performSema() {
       // Parser may stop at some erroneous constructions like #else, #endif
       // or '}' in some cases, continue parsing until we are done
       parseIntoSourceFile(*NextInput, BufferID, &Done, nullptr,
-                          &PersistentState, DelayedCB.get());
+                          &PersistentState, getDelayedCallbacks(IsPrimary));
     } while (!Done);
 
     Diags.setSuppressWarnings(DidSuppressWarnings);
@@ -494,7 +506,9 @@ void CompilerInstance::performSema() {
       // with 'sil' definitions.
       parseIntoSourceFile(MainFile, MainFile.getBufferID().getValue(), &Done,
                           TheSILModule ? &SILContext : nullptr,
-                          &PersistentState, DelayedCB.get());
+                          &PersistentState,
+                          getDelayedCallbacks(mainIsPrimary ||
+                                              TheSILModule != nullptr));
       if (mainIsPrimary) {
         performTypeChecking(MainFile, PersistentState.getTopLevelContext(),
                             TypeCheckOptions, CurTUElem,
@@ -528,6 +542,8 @@ void CompilerInstance::performSema() {
   if (DelayedCB) {
     performDelayedParsing(MainModule, PersistentState,
                           Invocation.getCodeCompletionFactory());
+  } else if (DelayNonPrimaryBodies) {
+    performDelayedParsingOfInlinableBodies(MainModule, PersistentState);
   }
 
   // Perform whole-module type checking.
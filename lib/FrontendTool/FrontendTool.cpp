@@ -24,6 +24,8 @@
 
 #include "swift/Subsystems.h"
 #include "swift/AST/ASTScope.h"
+#include "swift/AST/ASTWalker.h"
+#include "swift/AST/ClangModuleLoader.h"
 #include "swift/AST/DiagnosticsFrontend.h"
 #include "swift/AST/DiagnosticsSema.h"
 #include "swift/AST/IRGenOptions.h"
@@ -35,6 +37,7 @@
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/FileSystem.h"
 #include "swift/Basic/LLVMContext.h"
+#include "swift/Basic/MemoryStats.h"
 #include "swift/Basic/SourceManager.h"
 #include "swift/Basic/Timer.h"
 #include "swift/Frontend/DiagnosticVerifier.h"
@@ -42,6 +45,7 @@
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
 #include "swift/Frontend/SerializedDiagnosticConsumer.h"
 #include "swift/Immediate/Immediate.h"
+#include "swift/Index/IndexRecord.h"
 #include "swift/Option/Options.h"
 #include "swift/PrintAsObjC/PrintAsObjC.h"
 #include "swift/Serialization/SerializationOptions.h"
@@ -51,6 +55,9 @@
 // This API should be sunk down to LLVM.
 #include "clang/Frontend/CompilerInstance.h"
 
+#include "clang/AST/ASTContext.h"
+#include "clang/Basic/SourceManager.h"
+
 #include "llvm/ADT/Statistic.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
@@ -696,13 +703,54 @@ static void debugFailWithCrash() {
   LLVM_BUILTIN_TRAP;
 }
 
+/// Adds the memory used by the ASTContext and the Clang importer, and by the
+/// declarations of the main module's source files, to \p stats.
+static void collectMemoryStats(CompilerInstance &Instance,
+                               MemoryStats &stats) {
+  ASTContext &Context = Instance.getASTContext();
+  Context.collectMemoryStats(stats);
+
+  if (auto *loader = Context.getClangModuleLoader()) {
+    clang::ASTContext &clangContext = loader->getClangASTContext();
+    clang::SourceManager &clangSM = clangContext.getSourceManager();
+    stats.addArena("Clang importer",
+                   clangContext.getASTAllocatedMemory() +
+                   clangContext.getSideTableAllocatedMemory() +
+                   clangSM.getContentCacheSize() +
+                   clangSM.getDataStructureSizes());
+  }
+
+  // Declarations are allocated in the AST arena, so they have no allocator of
+  // their own to query; count them instead.
+  class DeclCounter : public ASTWalker {
+  public:
+    llvm::SmallDenseMap<unsigned, uint64_t, 32> Counts;
+
+    bool walkToDeclPre(Decl *D) override {
+      ++Counts[unsigned(D->getKind())];
+      return true;
+    }
+  };
+
+  DeclCounter counter;
+  for (auto *file : Instance.getMainModule()->getFiles())
+    if (auto *SF = dyn_cast<SourceFile>(file))
+      SF->walk(counter);
+
+#define DECL(Id, Parent) \
+  if (uint64_t count = counter.Counts.lookup(unsigned(DeclKind::Id))) \
+    stats.addTable(#Id "Decl", count, count * sizeof(Id##Decl));
+#include "swift/AST/DeclNodes.def"
+}
+
 /// Performs the compile requested by the user.
 /// \returns true on error
 static bool performCompile(CompilerInstance &Instance,
                            CompilerInvocation &Invocation,
                            ArrayRef<const char *> Args,
                            int &ReturnValue,
-                           FrontendObserver *observer) {
+                           FrontendObserver *observer,
+                           MemoryStats *memoryStats) {
   FrontendOptions opts = Invocation.getFrontendOptions();
   FrontendOptions::ActionType Action = opts.RequestedAction;
 
@@ -746,6 +794,23 @@ static bool performCompile(CompilerInstance &Instance,
     return performLLVM(IRGenOpts, Instance.getASTContext(), Module.get());
   }
 
+  // A script whose object code was cached by an earlier run is run without
+  // compiling it at all. A bridging header is not a module file whose changes
+  // the cache could detect, so scripts using one are never cached.
+  std::string ImmediateObjectCachePath;
+  if (opts.ImplicitObjCHeaderPath.empty())
+    ImmediateObjectCachePath = opts.ImmediateObjectCachePath;
+  if (Action == FrontendOptions::Immediate &&
+      !ImmediateObjectCachePath.empty()) {
+    const ProcessCmdLine &CmdLine = ProcessCmdLine(opts.ImmediateArgv.begin(),
+                                                   opts.ImmediateArgv.end());
+    if (auto Result = RunCachedImmediately(Instance, CmdLine, IRGenOpts,
+                                           ImmediateObjectCachePath, Args)) {
+      ReturnValue = *Result;
+      return false;
+    }
+  }
+
   ReferencedNameTracker nameTracker;
   bool shouldTrackReferences = !opts.ReferenceDependenciesFilePath.empty();
   if (shouldTrackReferences)
@@ -761,6 +826,9 @@ static bool performCompile(CompilerInstance &Instance,
     observer->performedSemanticAnalysis(Instance);
   }
 
+  if (memoryStats)
+    memoryStats->recordPhase("Semantic analysis");
+
   FrontendOptions::DebugCrashMode CrashMode = opts.CrashMode;
   if (CrashMode == FrontendOptions::DebugCrashMode::AssertAfterParse)
     debugFailWithAssertion();
@@ -858,6 +926,23 @@ static bool performCompile(CompilerInstance &Instance,
     emitReferenceDependencies(Context.Diags, Instance.getPrimarySourceFile(),
                               *Instance.getDependencyTracker(), opts);
 
+  if (!opts.IndexStorePath.empty()) {
+    // The index unit is keyed by the output file, so that each compilation
+    // of a source file replaces its previous unit.
+    StringRef unitToken = opts.getSingleOutputFilename();
+    if (PrimarySourceFile) {
+      if (unitToken.empty() || unitToken == "-")
+        unitToken = PrimarySourceFile->getFilename();
+      (void)index::indexAndRecord(PrimarySourceFile, unitToken,
+                                  opts.IndexStorePath, Context.Diags);
+    } else {
+      if (unitToken.empty() || unitToken == "-")
+        unitToken = Instance.getMainModule()->getName().str();
+      (void)index::indexAndRecord(Instance.getMainModule(), unitToken,
+                                  opts.IndexStorePath, Context.Diags);
+    }
+  }
+
   if (Context.hadError())
     return true;
 
@@ -900,6 +985,9 @@ static bool performCompile(CompilerInstance &Instance,
     observer->performedSILGeneration(*SM);
   }
 
+  if (memoryStats)
+    memoryStats->recordPhase("SILGen");
+
   // We've been told to emit SIL after SILGen, so write it now.
   if (Action == FrontendOptions::EmitSILGen) {
     // If we are asked to link all, link all.
@@ -973,6 +1061,9 @@ static bool performCompile(CompilerInstance &Instance,
     observer->performedSILOptimization(*SM);
   }
 
+  if (memoryStats)
+    memoryStats->recordPhase("SIL optimization");
+
   {
     SharedTimer timer("SIL verification (post-optimization)");
     SM->verify();
@@ -1076,10 +1167,19 @@ static bool performCompile(CompilerInstance &Instance,
     }
 
     ReturnValue =
-      RunImmediately(Instance, CmdLine, IRGenOpts, Invocation.getSILOptions());
+      RunImmediately(Instance, CmdLine, IRGenOpts, Invocation.getSILOptions(),
+                     ImmediateObjectCachePath, Args);
     return false;
   }
 
+  // The LLVMContext has no accounting of its own, so IRGen is measured by the
+  // growth of the peak resident set size instead.
+  uint64_t peakRSSBeforeIRGen = 0;
+  if (memoryStats) {
+    memoryStats->addArena("SIL", SM->getAllocatedMemory());
+    peakRSSBeforeIRGen = MemoryStats::getPeakResidentSetSize();
+  }
+
   // FIXME: We shouldn't need to use the global context here, but
   // something is persisting across calls to performIRGeneration.
   auto &LLVMContext = getGlobalLLVMContext();
@@ -1091,6 +1191,13 @@ static bool performCompile(CompilerInstance &Instance,
                         opts.getSingleOutputFilename(), LLVMContext);
   }
 
+  if (memoryStats) {
+    memoryStats->recordPhase("IRGen");
+    memoryStats->addArena("IRGen (peak RSS growth)",
+                          MemoryStats::getPeakResidentSetSize() -
+                          peakRSSBeforeIRGen);
+  }
+
   return false;
 }
 
@@ -1299,11 +1406,21 @@ int swift::performFrontend(ArrayRef<const char *> Args,
     observer->configuredCompiler(Instance);
   }
 
+  std::unique_ptr<MemoryStats> memoryStats;
+  if (Invocation.getFrontendOptions().PrintMemoryStats)
+    memoryStats.reset(new MemoryStats());
+
   int ReturnValue = 0;
   bool HadError =
-    performCompile(Instance, Invocation, Args, ReturnValue, observer) ||
+    performCompile(Instance, Invocation, Args, ReturnValue, observer,
+                   memoryStats.get()) ||
     Instance.getASTContext().hadError();
 
+  if (memoryStats) {
+    collectMemoryStats(Instance, *memoryStats);
+    memoryStats->print(llvm::errs());
+  }
+
   if (!HadError && !Invocation.getFrontendOptions().DumpAPIPath.empty()) {
     HadError = dumpAPI(Instance.getMainModule(),
                        Invocation.getFrontendOptions().DumpAPIPath);
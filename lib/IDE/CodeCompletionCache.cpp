@@ -2,6 +2,7 @@
 #include "swift/Basic/Cache.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -90,12 +91,6 @@ CodeCompletionCache::~CodeCompletionCache() {}
 /// cached results. This isn't expected to change very often.
 static constexpr uint32_t onDiskCompletionCacheVersion = 1;
 
-static StringRef copyString(llvm::BumpPtrAllocator &Allocator, StringRef Str) {
-  char *Mem = Allocator.Allocate<char>(Str.size());
-  std::copy(Str.begin(), Str.end(), Mem);
-  return StringRef(Mem, Str.size());
-}
-
 static ArrayRef<StringRef> copyStringArray(llvm::BumpPtrAllocator &Allocator,
                                            ArrayRef<StringRef> Arr) {
   StringRef *Buff = Allocator.Allocate<StringRef>(Arr.size());
@@ -113,8 +108,12 @@ static ArrayRef<std::pair<StringRef, StringRef>> copyStringPairArray(
 }
 
 /// Deserializes CodeCompletionResults from \p in and stores them in \p V.
+///
+/// Strings are not copied out of \p in; they are referenced in place, and
+/// \p in is kept alive for as long as the allocator of \p V's sink, which
+/// also keeps the results alive when they are imported into another sink.
 /// \see writeCacheModule.
-static bool readCachedModule(llvm::MemoryBuffer *in,
+static bool readCachedModule(std::unique_ptr<llvm::MemoryBuffer> in,
                              const CodeCompletionCache::Key &K,
                              CodeCompletionCache::Value &V,
                              bool allowOutOfDate = false) {
@@ -159,7 +158,14 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
   auto stringCount = read32le(strings);
   assert(strings + stringCount == end && "incorrect file size");
   (void)stringCount; // so it is not seen as "unused" in release builds.
-  
+
+  // Tie the lifetime of the buffer to the allocator of the sink.
+  std::shared_ptr<llvm::MemoryBuffer> buffer(std::move(in));
+  V.Sink.Allocator = CodeCompletionResultSink::AllocatorPtr(
+      new llvm::BumpPtrAllocator, [buffer](llvm::BumpPtrAllocator *allocator) {
+        delete allocator;
+      });
+
   // STRINGS
   auto getString = [&](uint32_t index) -> StringRef {
     if (index == ~0u)
@@ -167,7 +173,7 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
 
     const char *p = strings + index;
     auto size = read32le(p);
-    return copyString(*V.Sink.Allocator, StringRef(p, size));
+    return StringRef(p, size);
   };
 
   // CHUNKS
@@ -272,6 +278,8 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
 ///
 ///   STRINGS
 ///     * A blob of length-prefixed strings referred to in CHUNKS or RESULTS.
+///     * Strings are read in place, so an entry may be shared by several
+///       references.
 static void writeCachedModule(llvm::raw_ostream &out,
                               const CodeCompletionCache::Key &K,
                               CodeCompletionCache::Value &V) {
@@ -321,6 +329,21 @@ static void writeCachedModule(llvm::raw_ostream &out,
     return static_cast<uint32_t>(size);
   };
 
+  // Strings are read in place, so identical strings (module names, chunk
+  // texts, ...) can share a single entry. Lists of strings, which are read
+  // back as consecutive entries, still use addString.
+  llvm::StringMap<uint32_t> uniquedStrings;
+  auto addUniquedString = [&](StringRef str) {
+    if (str.empty())
+      return ~0u;
+    auto known = uniquedStrings.find(str);
+    if (known != uniquedStrings.end())
+      return known->getValue();
+    auto index = addString(str);
+    uniquedStrings[str] = index;
+    return index;
+  };
+
   auto addCompletionString = [&](const CodeCompletionString *str) {
     auto size = chunks.tell();
     chunksLE.write(static_cast<uint32_t>(str->getChunks().size()));
@@ -329,7 +352,7 @@ static void writeCachedModule(llvm::raw_ostream &out,
       chunksLE.write(static_cast<uint8_t>(chunk.getNestingLevel()));
       chunksLE.write(static_cast<uint8_t>(chunk.isAnnotation()));
       if (chunk.hasText()) {
-        chunksLE.write(addString(chunk.getText()));
+        chunksLE.write(addUniquedString(chunk.getText()));
       } else {
         chunksLE.write(static_cast<uint32_t>(~0u));
       }
@@ -356,8 +379,8 @@ static void writeCachedModule(llvm::raw_ostream &out,
       LE.write(static_cast<uint8_t>(R->getNumBytesToErase()));
       LE.write(
           static_cast<uint32_t>(addCompletionString(R->getCompletionString())));
-      LE.write(addString(R->getModuleName()));      // index into strings
-      LE.write(addString(R->getBriefDocComment())); // index into strings
+      LE.write(addUniquedString(R->getModuleName()));      // index into strings
+      LE.write(addUniquedString(R->getBriefDocComment())); // index into strings
       LE.write(static_cast<uint32_t>(R->getAssociatedUSRs().size()));
       if (R->getAssociatedUSRs().empty()) {
         LE.write(static_cast<uint32_t>(~0u));
@@ -425,14 +448,17 @@ static std::string getName(StringRef cacheDirectory,
 
 Optional<CodeCompletionCache::ValueRefCntPtr>
 OnDiskCodeCompletionCache::get(const Key &K) {
-  // Try to find the cached file.
-  auto bufferOrErr = llvm::MemoryBuffer::getFile(getName(cacheDirectory, K));
+  // Try to find the cached file. It doesn't need a null terminator, which
+  // lets it be memory mapped.
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(
+      getName(cacheDirectory, K), /*FileSize=*/-1,
+      /*RequiresNullTerminator=*/false);
   if (!bufferOrErr)
     return None;
 
   // Read the cached results, failing if they are out of date.
   auto V = CodeCompletionCache::createValue();
-  if (!readCachedModule(bufferOrErr.get().get(), K, *V))
+  if (!readCachedModule(std::move(bufferOrErr.get()), K, *V))
     return None;
 
   return V;
@@ -468,7 +494,8 @@ std::error_code OnDiskCodeCompletionCache::set(const Key &K, ValueRefCntPtr V) {
 Optional<CodeCompletionCache::ValueRefCntPtr>
 OnDiskCodeCompletionCache::getFromFile(StringRef filename) {
   // Try to find the cached file.
-  auto bufferOrErr = llvm::MemoryBuffer::getFile(filename);
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(
+      filename, /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
   if (!bufferOrErr)
     return None;
 
@@ -477,7 +504,7 @@ OnDiskCodeCompletionCache::getFromFile(StringRef filename) {
 
   // Read the cached results.
   auto V = CodeCompletionCache::createValue();
-  if (!readCachedModule(bufferOrErr.get().get(), K, *V,
+  if (!readCachedModule(std::move(bufferOrErr.get()), K, *V,
                         /*allowOutOfDate*/ true))
     return None;
 
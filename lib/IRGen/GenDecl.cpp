@@ -801,6 +801,10 @@ void IRGenerator::emitGlobalTopLevel() {
     Decl *decl = v.getDecl();
     CurrentIGMPtr IGM = getGenModule(decl ? decl->getDeclContext() : nullptr);
     IGM->emitSILGlobalVariable(&v);
+
+    // The static initializer is read after the functions have been emitted.
+    if (SILFunction *init = v.getInitializer())
+      RetainedSILFunctions.insert(init);
   }
   PrimaryIGM->emitCoverageMapping();
   
@@ -876,6 +880,13 @@ void IRGenerator::emitTypeMetadataRecords() {
   }
 }
 
+bool IRGenerator::canReleaseSILFunction(SILFunction *f) const {
+  // With multiple IGMs, a function emitted into one module may still be
+  // declared in another one, which needs to know that it has a definition.
+  return Opts.ReleaseSILDuringIRGen && !Opts.UseJIT && !hasMultipleIGMs() &&
+         f->isDefinition() && !RetainedSILFunctions.count(f);
+}
+
 /// Emit any lazy definitions (of globals or functions or whatever
 /// else) that we require.
 void IRGenerator::emitLazyDefinitions() {
@@ -1149,7 +1149,12 @@ void irgen::emitFunctionPartialApplication(IRGenFunction &IGF,
                                            CanSILFunctionType origType,
                                            CanSILFunctionType substType,
                                            CanSILFunctionType outType,
-                                           Explosion &out) {
+                                           Explosion &out,
+                                           int &StackAllocSize) {
+  // Only an allocated context can end up on the stack.
+  int maxStackAllocSize = StackAllocSize;
+  StackAllocSize = -1;
+
   // If we have a single Swift-refcounted context value, we can adopt it
   // directly as our closure context without creating a box and thunk.
   enum HasSingleSwiftRefcountedContext { Maybe, Yes, No, Thunkable }
@@ -1363,7 +1368,19 @@ void irgen::emitFunctionPartialApplication(IRGenFunction &IGF,
     // Allocate a new object.
     HeapNonFixedOffsets offsets(IGF, layout);
 
-    data = IGF.emitUnmanagedAlloc(layout, "closure", descriptor, &offsets);
+    if (maxStackAllocSize >= 0 && layout.isFixedLayout() &&
+        layout.getSize() <= Size(maxStackAllocSize)) {
+      // The context does not escape: allocate it on the stack.
+      Address alloca = IGF.createAlloca(layout.getType(),
+                                        layout.getAlignment(), "closure.raw");
+      data = IGF.Builder.CreateBitCast(alloca.getAddress(),
+                                       IGF.IGM.RefCountedPtrTy);
+      data = IGF.emitInitStackObjectCall(
+          layout.getPrivateMetadata(IGF.IGM, descriptor), data, "closure");
+      StackAllocSize = layout.getSize().getValue();
+    } else {
+      data = IGF.emitUnmanagedAlloc(layout, "closure", descriptor, &offsets);
+    }
     Address dataAddr = layout.emitCastTo(IGF, data);
     
     unsigned i = 0;
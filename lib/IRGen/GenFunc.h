@@ -47,6 +47,11 @@ namespace irgen {
 
   /// Emit a partial application thunk for a function pointer applied to a
   /// partial set of argument values.
+  ///
+  /// If \p StackAllocSize is not negative, the context may be allocated on
+  /// the stack if it fits into \p StackAllocSize bytes. On return,
+  /// \p StackAllocSize is set to the number of allocated stack bytes, or -1
+  /// if the context was not allocated on the stack.
   void emitFunctionPartialApplication(IRGenFunction &IGF,
                                       SILFunction &SILFn,
                                       llvm::Value *fnPtr,
@@ -57,7 +62,8 @@ namespace irgen {
                                       CanSILFunctionType origType,
                                       CanSILFunctionType substType,
                                       CanSILFunctionType outType,
-                                      Explosion &out);
+                                      Explosion &out,
+                                      int &StackAllocSize);
   
 } // end namespace irgen
 } // end namespace swift
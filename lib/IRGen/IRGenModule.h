@@ -212,6 +212,10 @@ private:
   /// appear in the translation unit.
   llvm::DenseMap<SILFunction*, unsigned> FunctionOrder;
 
+  /// SIL functions whose bodies are still read after their IR has been
+  /// emitted, and so must not be released by -release-sil-during-irgen.
+  llvm::SmallPtrSet<SILFunction*, 4> RetainedSILFunctions;
+
   /// The queue of IRGenModules for multi-threaded compilation.
   SmallVector<IRGenModule *, 8> Queue;
 
@@ -285,6 +289,10 @@ public:
   /// Emit everything which is reachable from already emitted IR.
   void emitLazyDefinitions();
   
+  /// Returns true if the body of \p f can be freed now that its IR has been
+  /// emitted.
+  bool canReleaseSILFunction(SILFunction *f) const;
+
   void addLazyFunction(SILFunction *f) {
     // Add it to the queue if it hasn't already been put there.
     if (LazilyEmittedFunctions.insert(f).second) {
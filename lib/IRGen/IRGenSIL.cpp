@@ -374,6 +374,9 @@ public:
   /// Calculates EstimatedStackSize.
   void estimateStackSize();
 
+  /// Emit the end of the lifetime of a stack allocated object.
+  void emitStackObjectLifetimeEnd(llvm::Value *object);
+
   void setLoweredValue(SILValue v, LoweredValue &&lv) {
     auto inserted = LoweredValues.insert({v, std::move(lv)});
     assert(inserted.second && "already had lowered value for sil value?!");
@@ -1328,6 +1331,11 @@ void IRGenModule::emitSILFunction(SILFunction *f) {
 
   PrettyStackTraceSILFunction stackTrace("emitting IR", f);
   IRGenSILFunction(*this, f).emitSILFunction();
+
+  // References to f from IR emitted later only need its name and type, so
+  // its instructions can be freed now.
+  if (IRGen.canReleaseSILFunction(f))
+    f->convertToDeclaration();
 }
 
 void IRGenSILFunction::emitSILFunction() {
@@ -2195,6 +2203,13 @@ void IRGenSILFunction::visitPartialApplyInst(swift::PartialApplyInst *i) {
     = getPartialApplicationFunction(*this, i->getCallee(),
                                     i->getSubstitutions());
 
+  int StackAllocSize = -1;
+  if (i->canAllocOnStack()) {
+    estimateStackSize();
+    // Is there enough space for stack allocation?
+    StackAllocSize = IGM.IRGen.Opts.StackPromotionSizeLimit - EstimatedStackSize;
+  }
+
   // Create the thunk and function value.
   Explosion function;
   emitFunctionPartialApplication(*this, *CurSILFn,
@@ -2202,7 +2217,12 @@ void IRGenSILFunction::visitPartialApplyInst(swift::PartialApplyInst *i) {
                                  params, i->getSubstitutions(),
                                  origCalleeTy, i->getSubstCalleeType(),
                                  i->getType().castTo<SILFunctionType>(),
-                                 function);
+                                 function, StackAllocSize);
+  if (StackAllocSize >= 0) {
+    // Remember that this partial_apply allocates the context on the stack.
+    StackAllocs.insert(i);
+    EstimatedStackSize += StackAllocSize;
+  }
   setLoweredExplosion(v, function);
 }
 
@@ -2893,20 +2913,100 @@ void IRGenSILFunction::visitCondBranchInst(swift::CondBranchInst *i) {
   Builder.CreateCondBr(condValue, trueBB.bb, falseBB.bb);
 }
 
+/// Should copies and destroys of a value of the given type be emitted as a
+/// call to a shared helper function instead of being expanded inline?
+///
+/// Expanding the copy or destroy of a large aggregate produces one retain or
+/// release per reference counted field at every use. Above the configured
+/// explosion size we trade the call overhead for the code size.
+static bool shouldOutlineValueOperation(IRGenSILFunction &IGF, SILType type,
+                                        const LoadableTypeInfo &ti) {
+  unsigned threshold = IGF.IGM.IRGen.Opts.ValueOperationOutliningThreshold;
+  if (threshold == 0)
+    return false;
+
+  // The helper can't refer to the generic context of the current function.
+  if (type.hasArchetype())
+    return false;
+
+  if (ti.isPOD(ResilienceExpansion::Maximal))
+    return false;
+
+  return ti.getExplosionSize() >= threshold;
+}
+
+/// Emit a call to the shared helper function which copies or destroys the
+/// given explosion of a value of the given type. The values are consumed out
+/// of the explosion.
+static void emitOutlinedValueOperation(IRGenSILFunction &IGF, SILType type,
+                                       const LoadableTypeInfo &ti,
+                                       Explosion &in, bool isDestroy,
+                                       irgen::Atomicity atomicity) {
+  IRGenModule &IGM = IGF.IGM;
+  auto args = in.claimAll();
+
+  SmallVector<llvm::Type *, 8> argTys;
+  for (auto *arg : args)
+    argTys.push_back(arg->getType());
+
+  // __swift_outlined_{copy,destroy}_<mangled type> is the shared helper for
+  // the value operations of one type.
+  llvm::SmallString<64> fnName;
+  fnName += isDestroy ? "__swift_outlined_destroy_"
+                      : "__swift_outlined_copy_";
+  llvm::SmallString<32> typeName;
+  fnName += IGM.mangleType(type.getSwiftRValueType(), typeName);
+  if (atomicity == irgen::Atomicity::NonAtomic)
+    fnName += "_nonatomic";
+
+  auto fn = IGM.getOrCreateHelperFunction(fnName, IGM.VoidTy, argTys,
+                                          [&](IRGenFunction &subIGF) {
+    Explosion params = subIGF.collectParameters();
+    if (isDestroy) {
+      ti.consume(subIGF, params, atomicity);
+    } else {
+      Explosion copied;
+      ti.copy(subIGF, params, copied, atomicity);
+      copied.claimAll();
+    }
+    subIGF.Builder.CreateRetVoid();
+  });
+
+  auto call = IGF.Builder.CreateCall(fn, args);
+  call->setCallingConv(IGM.DefaultCC);
+  call->setDoesNotThrow();
+}
+
 void IRGenSILFunction::visitRetainValueInst(swift::RetainValueInst *i) {
+  SILType type = i->getOperand()->getType();
+  auto &ti = cast<LoadableTypeInfo>(getTypeInfo(type));
+  auto atomicity = i->isAtomic() ? irgen::Atomicity::Atomic
+                                 : irgen::Atomicity::NonAtomic;
   Explosion in = getLoweredExplosion(i->getOperand());
+  if (shouldOutlineValueOperation(*this, type, ti)) {
+    emitOutlinedValueOperation(*this, type, ti, in, /*isDestroy*/ false,
+                               atomicity);
+    return;
+  }
   Explosion out;
-  cast<LoadableTypeInfo>(getTypeInfo(i->getOperand()->getType()))
-      .copy(*this, in, out, i->isAtomic() ? irgen::Atomicity::Atomic
-                                          : irgen::Atomicity::NonAtomic);
+  ti.copy(*this, in, out, atomicity);
   out.claimAll();
 }
 
 void IRGenSILFunction::visitCopyValueInst(swift::CopyValueInst *i) {
+  SILType type = i->getOperand()->getType();
+  auto &ti = cast<LoadableTypeInfo>(getTypeInfo(type));
   Explosion in = getLoweredExplosion(i->getOperand());
   Explosion out;
-  cast<LoadableTypeInfo>(getTypeInfo(i->getOperand()->getType()))
-      .copy(*this, in, out, irgen::Atomicity::Atomic);
+  if (shouldOutlineValueOperation(*this, type, ti)) {
+    // Copying a loadable value doesn't change its scalar values, so the copy
+    // is just the operand after the outlined retains.
+    out.add(in.getAll());
+    emitOutlinedValueOperation(*this, type, ti, in, /*isDestroy*/ false,
+                               irgen::Atomicity::Atomic);
+  } else {
+    ti.copy(*this, in, out, irgen::Atomicity::Atomic);
+  }
   setLoweredExplosion(i, out);
 }
 
@@ -2955,16 +3055,29 @@ void IRGenSILFunction::visitSetDeallocatingInst(SetDeallocatingInst *i) {
 }
 
 void IRGenSILFunction::visitReleaseValueInst(swift::ReleaseValueInst *i) {
+  SILType type = i->getOperand()->getType();
+  auto &ti = cast<LoadableTypeInfo>(getTypeInfo(type));
+  auto atomicity = i->isAtomic() ? irgen::Atomicity::Atomic
+                                 : irgen::Atomicity::NonAtomic;
   Explosion in = getLoweredExplosion(i->getOperand());
-  cast<LoadableTypeInfo>(getTypeInfo(i->getOperand()->getType()))
-      .consume(*this, in, i->isAtomic() ? irgen::Atomicity::Atomic
-                                        : irgen::Atomicity::NonAtomic);
+  if (shouldOutlineValueOperation(*this, type, ti)) {
+    emitOutlinedValueOperation(*this, type, ti, in, /*isDestroy*/ true,
+                               atomicity);
+    return;
+  }
+  ti.consume(*this, in, atomicity);
 }
 
 void IRGenSILFunction::visitDestroyValueInst(swift::DestroyValueInst *i) {
+  SILType type = i->getOperand()->getType();
+  auto &ti = cast<LoadableTypeInfo>(getTypeInfo(type));
   Explosion in = getLoweredExplosion(i->getOperand());
-  cast<LoadableTypeInfo>(getTypeInfo(i->getOperand()->getType()))
-      .consume(*this, in, irgen::Atomicity::Atomic);
+  if (shouldOutlineValueOperation(*this, type, ti)) {
+    emitOutlinedValueOperation(*this, type, ti, in, /*isDestroy*/ true,
+                               irgen::Atomicity::Atomic);
+    return;
+  }
+  ti.consume(*this, in, irgen::Atomicity::Atomic);
 }
 
 void IRGenSILFunction::visitStructInst(swift::StructInst *i) {
@@ -3584,6 +3697,16 @@ void IRGenSILFunction::visitDeallocStackInst(swift::DeallocStackInst *i) {
 void IRGenSILFunction::visitDeallocRefInst(swift::DeallocRefInst *i) {
   // Lower the operand.
   Explosion self = getLoweredExplosion(i->getOperand());
+  if (auto *PAI = dyn_cast<PartialApplyInst>(i->getOperand())) {
+    // It's the dealloc_ref [stack] of a closure context. The context is the
+    // second value of the thick function explosion.
+    assert(i->canAllocOnStack() && PAI->canAllocOnStack());
+    self.claimNext();
+    auto contextValue = self.claimNext();
+    if (StackAllocs.count(PAI))
+      emitStackObjectLifetimeEnd(contextValue);
+    return;
+  }
   auto selfValue = self.claimNext();
   auto *ARI = dyn_cast<AllocRefInst>(i->getOperand());
   if (!i->canAllocOnStack()) {
@@ -3607,18 +3730,21 @@ void IRGenSILFunction::visitDeallocRefInst(swift::DeallocRefInst *i) {
   // object on the stack, we don't have to deallocate it, because it is
   // deallocated in the final release.
   assert(ARI->canAllocOnStack());
-  if (StackAllocs.count(ARI)) {
-    if (IGM.IRGen.Opts.EmitStackPromotionChecks) {
-      selfValue = Builder.CreateBitCast(selfValue, IGM.RefCountedPtrTy);
-      emitVerifyEndOfLifetimeCall(selfValue);
-    } else {
-      // This has two purposes:
-      // 1. Tell LLVM the lifetime of the allocated stack memory.
-      // 2. Avoid tail-call optimization which may convert the call to the final
-      //    release to a jump, which is done after the stack frame is
-      //    destructed.
-      Builder.CreateLifetimeEnd(selfValue);
-    }
+  if (StackAllocs.count(ARI))
+    emitStackObjectLifetimeEnd(selfValue);
+}
+
+void IRGenSILFunction::emitStackObjectLifetimeEnd(llvm::Value *object) {
+  if (IGM.IRGen.Opts.EmitStackPromotionChecks) {
+    object = Builder.CreateBitCast(object, IGM.RefCountedPtrTy);
+    emitVerifyEndOfLifetimeCall(object);
+  } else {
+    // This has two purposes:
+    // 1. Tell LLVM the lifetime of the allocated stack memory.
+    // 2. Avoid tail-call optimization which may convert the call to the final
+    //    release to a jump, which is done after the stack frame is
+    //    destructed.
+    Builder.CreateLifetimeEnd(object);
   }
 }
 
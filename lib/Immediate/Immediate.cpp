@@ -26,17 +26,24 @@
 #include "swift/AST/Module.h"
 #include "swift/Basic/LLVM.h"
 #include "swift/Basic/LLVMContext.h"
+#include "swift/Basic/Version.h"
 #include "swift/Frontend/Frontend.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Config/config.h"
 #include "llvm/ExecutionEngine/MCJIT.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/IR/DiagnosticPrinter.h"
 #include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/Linker/Linker.h"
+#include "llvm/Object/ObjectFile.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 
 #if defined(_MSC_VER)
@@ -202,19 +209,16 @@ bool swift::immediate::linkLLVMModules(llvm::Module *Module,
   return !Failed;
 }
 
-bool swift::immediate::IRGenImportedModules(
-    CompilerInstance &CI,
-    llvm::Module &Module,
-    llvm::SmallPtrSet<swift::Module *, 8> &ImportedModules,
-    SmallVectorImpl<llvm::Function*> &InitFns,
-    IRGenOptions &IRGenOpts,
-    const SILOptions &SILOpts) {
+/// Collects the libraries that the main module and the modules it imports
+/// link against.
+static void collectLinkLibraries(CompilerInstance &CI, IRGenOptions &IRGenOpts,
+                                 SmallVectorImpl<LinkLibrary> &LinkLibraries) {
   swift::Module *M = CI.getMainModule();
 
-  // Perform autolinking.
-  SmallVector<LinkLibrary, 4> AllLinkLibraries(IRGenOpts.LinkLibraries);
+  LinkLibraries.append(IRGenOpts.LinkLibraries.begin(),
+                       IRGenOpts.LinkLibraries.end());
   auto addLinkLibrary = [&](LinkLibrary linkLib) {
-    AllLinkLibraries.push_back(linkLib);
+    LinkLibraries.push_back(linkLib);
   };
 
   M->forAllVisibleModules({}, /*includePrivateTopLevel=*/true,
@@ -231,9 +235,29 @@ bool swift::immediate::IRGenImportedModules(
     next->collectLinkLibraries(addLinkLibrary);
     prev = next;
   }
+}
 
+/// Loads the libraries that the main module and the modules it imports link
+/// against.
+static void autolinkImportedModules(CompilerInstance &CI,
+                                    IRGenOptions &IRGenOpts) {
+  SmallVector<LinkLibrary, 4> AllLinkLibraries;
+  collectLinkLibraries(CI, IRGenOpts, AllLinkLibraries);
   tryLoadLibraries(AllLinkLibraries, CI.getASTContext().SearchPathOpts,
                    CI.getDiags());
+}
+
+bool swift::immediate::IRGenImportedModules(
+    CompilerInstance &CI,
+    llvm::Module &Module,
+    llvm::SmallPtrSet<swift::Module *, 8> &ImportedModules,
+    SmallVectorImpl<llvm::Function*> &InitFns,
+    IRGenOptions &IRGenOpts,
+    const SILOptions &SILOpts) {
+  swift::Module *M = CI.getMainModule();
+
+  // Perform autolinking.
+  autolinkImportedModules(CI, IRGenOpts);
 
   ImportedModules.insert(M);
   if (!CI.hasSourceImport())
@@ -290,31 +314,253 @@ bool swift::immediate::IRGenImportedModules(
   return hadError;
 }
 
-int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
-                          IRGenOptions &IRGenOpts, const SILOptions &SILOpts) {
+/// Writes \p Contents to \p Path, through a temporary file so that a
+/// concurrent run of the same script never sees a partial file.
+///
+/// \returns true on success.
+static bool writeObjectCacheFile(StringRef Path, StringRef Contents) {
+  if (llvm::sys::fs::create_directories(llvm::sys::path::parent_path(Path)))
+    return false;
+  int FD;
+  SmallString<128> TempPath;
+  if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", FD, TempPath))
+    return false;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << Contents;
+  }
+  if (llvm::sys::fs::rename(TempPath, Path)) {
+    llvm::sys::fs::remove(TempPath);
+    return false;
+  }
+  return true;
+}
+
+namespace {
+/// An llvm::ObjectCache which writes the object code compiled for a script
+/// to its entry in the immediate mode object cache.
+///
+/// An entry consists of the object file "<key>.o" and the dependencies file
+/// "<key>.deps", which is written last; see getObjectCacheDeps(). The cache
+/// is looked up before the script is even parsed, by RunCachedImmediately(),
+/// so this never provides the object code itself.
+class ImmediateObjectCacheWriter : public llvm::ObjectCache {
+  std::string EntryPath;
+  std::string Deps;
+
+public:
+  ImmediateObjectCacheWriter(StringRef entryPath, std::string deps)
+    : EntryPath(entryPath), Deps(std::move(deps)) {}
+
+  std::unique_ptr<llvm::MemoryBuffer>
+  getObject(const llvm::Module *M) override {
+    return nullptr;
+  }
+
+  void notifyObjectCompiled(const llvm::Module *M,
+                            llvm::MemoryBufferRef Obj) override {
+    // The cache is only an optimization, so give up quietly on any error.
+    std::string ObjectPath = EntryPath + ".o";
+    if (!writeObjectCacheFile(ObjectPath, Obj.getBuffer()) ||
+        !writeObjectCacheFile(EntryPath + ".deps", Deps))
+      return;
+    DEBUG(llvm::dbgs() << "Cached object file " << ObjectPath << '\n');
+  }
+};
+} // end anonymous namespace
+
+/// The function that runs the static constructors of a script compiled with
+/// the object cache. An object file has no llvm.global_ctors for the engine
+/// to run, so IRGen's constructors are called from this function instead.
+static const char StaticInitFnName[] = "__swift_immediate_static_init";
+
+/// Returns the path in \p CacheDir, without an extension, of the cache entry
+/// for the script. It is named by the MD5 hash of the compiler and its
+/// arguments, the target, and the contents of the script, which are all
+/// known before the script is parsed. The modules the script imports are
+/// only known after import resolution, so they are recorded in the entry's
+/// dependencies file instead.
+static std::string
+getObjectCacheEntryPath(CompilerInstance &CI, IRGenOptions &IRGenOpts,
+                        StringRef CacheDir,
+                        ArrayRef<const char *> CompilerArgs) {
   ASTContext &Context = CI.getASTContext();
-  
-  // IRGen the main module.
-  auto *swiftModule = CI.getMainModule();
-  // FIXME: We shouldn't need to use the global context here, but
-  // something is persisting across calls to performIRGeneration.
-  auto ModuleOwner =
-      performIRGeneration(IRGenOpts, swiftModule, CI.getSILModule(),
-                          swiftModule->getName().str(), getGlobalLLVMContext());
-  auto *Module = ModuleOwner.get();
+  llvm::MD5 Hash;
+  auto update = [&](StringRef Str) {
+    Hash.update(Str);
+    // Keep adjacent strings from running together.
+    Hash.update(StringRef("\0", 1));
+  };
 
-  if (Context.hadError())
-    return -1;
+  auto &LangVersion = Context.LangOpts.EffectiveLanguageVersion;
+  update(version::getSwiftFullVersion(LangVersion));
+  // The arguments after "--" are passed to the script and don't affect how
+  // it is compiled.
+  for (StringRef Arg : CompilerArgs) {
+    if (Arg == "--")
+      break;
+    update(Arg);
+  }
 
-  // Load libSwiftCore to setup process arguments.
-  //
-  // This must be done here, before any library loading has been done, to avoid
-  // racing with the static initializers in user code.
+  llvm::TargetOptions TargetOpt;
+  std::string CPU;
+  std::vector<std::string> Features;
+  std::tie(TargetOpt, CPU, Features) = getIRTargetOptions(IRGenOpts, Context);
+  update(CPU);
+  for (auto &Feature : Features)
+    update(Feature);
+
+  auto &SM = CI.getSourceMgr().getLLVMSourceMgr();
+  for (unsigned BufferID : CI.getInputBufferIDs())
+    update(SM.getMemoryBuffer(BufferID)->getBuffer());
+
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> HashStr;
+  llvm::MD5::stringifyResult(Result, HashStr);
+
+  SmallString<128> Path(CacheDir);
+  llvm::sys::path::append(Path, HashStr.str());
+  return Path.str();
+}
+
+/// Returns the contents of the dependencies file of the cache entry for the
+/// script, or None if the script can't be cached.
+///
+/// The file has a line "file <size> <mtime> <path>" for each file of a module
+/// the script imports, and a line "library <kind> <force-load> <name>" for
+/// each library it links against. Hashing the contents of every imported
+/// module would take longer than compiling most scripts, so modules are
+/// compared by size and modification time. A module that is not backed by a
+/// file, such as the one for a bridging header, can't be checked, so the
+/// script is not cached.
+static Optional<std::string> getObjectCacheDeps(CompilerInstance &CI,
+                                                IRGenOptions &IRGenOpts) {
+  std::string Deps;
+  llvm::raw_string_ostream OS(Deps);
+
+  for (auto &Entry : CI.getASTContext().LoadedModules) {
+    swift::Module *M = Entry.second;
+    if (M == CI.getMainModule())
+      continue;
+    for (auto File : M->getFiles()) {
+      if (isa<BuiltinUnit>(File))
+        continue;
+      auto LF = dyn_cast<LoadedFile>(File);
+      if (!LF)
+        return None;
+
+      StringRef Filename = LF->getFilename();
+      llvm::sys::fs::file_status Status;
+      if (Filename.empty() || llvm::sys::fs::status(Filename, Status)) {
+        DEBUG(llvm::dbgs() << "Not caching object file: can't check module "
+                           << M->getName() << '\n');
+        return None;
+      }
+      OS << "file " << Status.getSize() << ' '
+         << uint64_t(Status.getLastModificationTime().toEpochTime()) << ' '
+         << Filename << '\n';
+    }
+  }
+
+  SmallVector<LinkLibrary, 4> LinkLibraries;
+  collectLinkLibraries(CI, IRGenOpts, LinkLibraries);
+  for (auto &Lib : LinkLibraries)
+    OS << "library " << unsigned(Lib.getKind()) << ' '
+       << unsigned(Lib.shouldForceLoad()) << ' ' << Lib.getName() << '\n';
+
+  return OS.str();
+}
+
+/// Checks that the files recorded in the dependencies file \p Deps of a cache
+/// entry are unchanged, and adds the recorded libraries to \p LinkLibraries.
+///
+/// \returns true if the entry can be used.
+static bool checkObjectCacheDeps(StringRef Deps,
+                                 SmallVectorImpl<LinkLibrary> &LinkLibraries) {
+  SmallVector<StringRef, 32> Lines;
+  Deps.split(Lines, '\n', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  for (StringRef Line : Lines) {
+    StringRef Kind, First, Second, Rest;
+    std::tie(Kind, Rest) = Line.split(' ');
+    std::tie(First, Rest) = Rest.split(' ');
+    std::tie(Second, Rest) = Rest.split(' ');
+
+    if (Kind == "file") {
+      uint64_t Size, ModTime;
+      if (First.getAsInteger(10, Size) || Second.getAsInteger(10, ModTime))
+        return false;
+      llvm::sys::fs::file_status Status;
+      if (llvm::sys::fs::status(Rest, Status) || Status.getSize() != Size ||
+          uint64_t(Status.getLastModificationTime().toEpochTime()) != ModTime) {
+        DEBUG(llvm::dbgs() << "Cached object file is out of date: " << Rest
+                           << " changed\n");
+        return false;
+      }
+      continue;
+    }
+
+    if (Kind == "library") {
+      unsigned LibKind, ForceLoad;
+      if (First.getAsInteger(10, LibKind) ||
+          LibKind > unsigned(LibraryKind::Framework) ||
+          Second.getAsInteger(10, ForceLoad))
+        return false;
+      LinkLibraries.push_back(LinkLibrary(Rest, LibraryKind(LibKind),
+                                          ForceLoad != 0));
+      continue;
+    }
+
+    return false;
+  }
+  return true;
+}
+
+/// Moves the static constructors of \p Module into a new function named
+/// StaticInitFnName, so that they can be run from a cached object file.
+static void emitStaticInitFn(llvm::Module &Module) {
+  auto *InitFn = llvm::Function::Create(
+      llvm::FunctionType::get(llvm::Type::getVoidTy(Module.getContext()),
+                              /*isVarArg=*/false),
+      llvm::GlobalValue::ExternalLinkage, StaticInitFnName, &Module);
+  llvm::IRBuilder<> Builder(
+      llvm::BasicBlock::Create(Module.getContext(), "entry", InitFn));
+
+  // Call the constructors in the order the engine would run them.
+  if (auto *Ctors = Module.getNamedGlobal("llvm.global_ctors")) {
+    auto *Init = Ctors->getInitializer();
+    if (auto *Entries = dyn_cast<llvm::ConstantArray>(Init)) {
+      for (auto &Entry : Entries->operands()) {
+        auto *Struct = dyn_cast<llvm::ConstantStruct>(Entry);
+        if (!Struct)
+          continue;
+        auto *Ctor = dyn_cast<llvm::Function>(
+            Struct->getOperand(1)->stripPointerCasts());
+        if (Ctor)
+          Builder.CreateCall(Ctor);
+      }
+    }
+    Ctors->eraseFromParent();
+  }
+  Builder.CreateRetVoid();
+}
+
+/// Loads libSwiftCore and passes it the arguments of the script, which are
+/// kept alive in \p ArgBuf.
+///
+/// This must be done before any library loading has been done, to avoid
+/// racing with the static initializers in user code.
+///
+/// \returns true on success.
+static bool setUpProcessArgs(CompilerInstance &CI,
+                             const ProcessCmdLine &CmdLine,
+                             SmallVectorImpl<const char *> &ArgBuf) {
+  ASTContext &Context = CI.getASTContext();
   auto stdlib = loadSwiftRuntime(Context.SearchPathOpts.RuntimeLibraryPath);
   if (!stdlib) {
     CI.getDiags().diagnose(SourceLoc(),
                            diag::error_immediate_mode_missing_stdlib);
-    return -1;
+    return false;
   }
 
   // Setup interpreted process arguments.
@@ -322,15 +568,130 @@ int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
   auto emplaceProcessArgs
           = (ArgOverride)dlsym(stdlib, "_swift_stdlib_overrideUnsafeArgvArgc");
   if (dlerror())
-    return -1;
+    return false;
 
-  SmallVector<const char *, 32> argBuf;
   for (size_t i = 0; i < CmdLine.size(); ++i) {
-    argBuf.push_back(CmdLine[i].c_str());
+    ArgBuf.push_back(CmdLine[i].c_str());
   }
-  argBuf.push_back(nullptr);
+  ArgBuf.push_back(nullptr);
+
+  (*emplaceProcessArgs)(ArgBuf.data(), CmdLine.size());
+  return true;
+}
 
-  (*emplaceProcessArgs)(argBuf.data(), CmdLine.size());
+Optional<int> swift::RunCachedImmediately(CompilerInstance &CI,
+                                          const ProcessCmdLine &CmdLine,
+                                          IRGenOptions &IRGenOpts,
+                                          const std::string &ObjectCachePath,
+                                          ArrayRef<const char *> CompilerArgs) {
+  // Scripts that import source modules are not cached, because their
+  // modules' initializers need the generated IR to be found.
+  if (CI.hasSourceImport())
+    return None;
+
+  std::string EntryPath = getObjectCacheEntryPath(CI, IRGenOpts,
+                                                  ObjectCachePath,
+                                                  CompilerArgs);
+  auto DepsBuffer = llvm::MemoryBuffer::getFile(EntryPath + ".deps");
+  if (!DepsBuffer)
+    return None;
+  SmallVector<LinkLibrary, 4> LinkLibraries;
+  if (!checkObjectCacheDeps((*DepsBuffer)->getBuffer(), LinkLibraries))
+    return None;
+
+  std::string ObjectPath = EntryPath + ".o";
+  auto ObjectBuffer = llvm::MemoryBuffer::getFile(ObjectPath);
+  if (!ObjectBuffer)
+    return None;
+  auto Object = llvm::object::ObjectFile::createObjectFile(
+      (*ObjectBuffer)->getMemBufferRef());
+  if (!Object) {
+    llvm::consumeError(Object.takeError());
+    return None;
+  }
+  DEBUG(llvm::dbgs() << "Using cached object file " << ObjectPath << '\n');
+
+  SmallVector<const char *, 32> argBuf;
+  if (!setUpProcessArgs(CI, CmdLine, argBuf))
+    return -1;
+
+  ASTContext &Context = CI.getASTContext();
+  tryLoadLibraries(LinkLibraries, Context.SearchPathOpts, CI.getDiags());
+
+  // The engine needs a module, even though all of the code is in the object.
+  auto EmptyModule = llvm::make_unique<llvm::Module>(
+      CI.getMainModule()->getName().str(), getGlobalLLVMContext());
+  EmptyModule->setTargetTriple(Context.LangOpts.Target.str());
+
+  llvm::EngineBuilder builder(std::move(EmptyModule));
+  std::string ErrorMsg;
+  llvm::TargetOptions TargetOpt;
+  std::string CPU;
+  std::vector<std::string> Features;
+  std::tie(TargetOpt, CPU, Features) = getIRTargetOptions(IRGenOpts, Context);
+  builder.setRelocationModel(llvm::Reloc::PIC_);
+  builder.setTargetOptions(TargetOpt);
+  builder.setMCPU(CPU);
+  builder.setMAttrs(Features);
+  builder.setErrorStr(&ErrorMsg);
+  builder.setEngineKind(llvm::EngineKind::JIT);
+  llvm::ExecutionEngine *EE = builder.create();
+  if (!EE) {
+    llvm::errs() << "Error loading JIT: " << ErrorMsg;
+    return -1;
+  }
+
+  EE->addObjectFile(llvm::object::OwningBinary<llvm::object::ObjectFile>(
+      std::move(*Object), std::move(*ObjectBuffer)));
+  EE->finalizeObject();
+
+  auto StaticInit = EE->getFunctionAddress(StaticInitFnName);
+  auto Main = EE->getFunctionAddress("main");
+  if (!StaticInit || !Main) {
+    llvm::errs() << "Error loading cached object file\n";
+    return -1;
+  }
+
+  DEBUG(llvm::dbgs() << "Running static constructors\n");
+  reinterpret_cast<void (*)()>(StaticInit)();
+  DEBUG(llvm::dbgs() << "Running main\n");
+  return reinterpret_cast<int (*)(int, const char **)>(Main)(
+      argBuf.size() - 1, argBuf.data());
+}
+
+int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
+                          IRGenOptions &IRGenOpts, const SILOptions &SILOpts,
+                          const std::string &ObjectCachePath,
+                          ArrayRef<const char *> CompilerArgs) {
+  ASTContext &Context = CI.getASTContext();
+
+  // IRGen the main module.
+  auto *swiftModule = CI.getMainModule();
+  // FIXME: We shouldn't need to use the global context here, but
+  // something is persisting across calls to performIRGeneration.
+  auto ModuleOwner =
+      performIRGeneration(IRGenOpts, swiftModule, CI.getSILModule(),
+                          swiftModule->getName().str(), getGlobalLLVMContext());
+  auto *Module = ModuleOwner.get();
+
+  if (Context.hadError())
+    return -1;
+
+  // Write the object code to the cache, for RunCachedImmediately() to find
+  // on the next run of the same script.
+  std::string CacheEntryPath;
+  std::string CacheDeps;
+  if (!ObjectCachePath.empty() && !CI.hasSourceImport()) {
+    if (auto Deps = getObjectCacheDeps(CI, IRGenOpts)) {
+      CacheEntryPath = getObjectCacheEntryPath(CI, IRGenOpts, ObjectCachePath,
+                                               CompilerArgs);
+      CacheDeps = std::move(*Deps);
+    }
+  }
+
+  SmallVector<const char *, 32> argBuf;
+  if (!setUpProcessArgs(CI, CmdLine, argBuf))
+    return -1;
 
   SmallVector<llvm::Function*, 8> InitFns;
   llvm::SmallPtrSet<swift::Module *, 8> ImportedModules;
@@ -342,6 +703,9 @@ int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
   PMBuilder.OptLevel = 2;
   PMBuilder.Inliner = llvm::createFunctionInliningPass(200);
 
+  if (!CacheEntryPath.empty())
+    emitStaticInitFn(*Module);
+
   // Build the ExecutionEngine.
   llvm::EngineBuilder builder(std::move(ModuleOwner));
   std::string ErrorMsg;
@@ -362,6 +726,11 @@ int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
     return -1;
   }
 
+  // The engine is never destroyed, so neither is the cache it uses.
+  if (!CacheEntryPath.empty())
+    EE->setObjectCache(new ImmediateObjectCacheWriter(CacheEntryPath,
+                                                      std::move(CacheDeps)));
+
   DEBUG(llvm::dbgs() << "Module to be executed:\n";
         Module->dump());
 
@@ -375,7 +744,10 @@ int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
   }
 
   DEBUG(llvm::dbgs() << "Running static constructors\n");
-  EE->runStaticConstructorsDestructors(false);
+  if (!CacheEntryPath.empty())
+    EE->runFunction(Module->getFunction(StaticInitFnName), {});
+  else
+    EE->runStaticConstructorsDestructors(false);
   DEBUG(llvm::dbgs() << "Running main\n");
   llvm::Function *EntryFn = Module->getFunction("main");
   return EE->runFunctionAsMain(EntryFn, CmdLine, 0);
@@ -0,0 +1,270 @@
+//===--- IndexRecord.cpp --------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Index/IndexRecord.h"
+#include "swift/AST/DiagnosticsCommon.h"
+#include "swift/AST/Module.h"
+#include "swift/Index/Index.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace swift;
+using namespace swift::index;
+
+/// A version number for the layout of the index store.
+///
+/// This should be incremented any time the format of records or units
+/// changes; it is part of the directory name so that stores written by
+/// different compilers don't get mixed up.
+static constexpr unsigned indexStoreVersion = 1;
+
+namespace {
+/// Serializes the symbol occurrences of a source file into a record, and
+/// collects the modules that it depends on.
+///
+/// Records use a simple line-based format:
+///
+///   symbol <kind> <sub-kinds> <roles> <line>:<column> <USR> <name>
+///     related <kind> <sub-kinds> <roles> <USR> <name>
+///
+/// where kinds and roles are the numeric values of SymbolKind,
+/// SymbolSubKindSet and SymbolRoleSet.
+class RecordingConsumer : public IndexDataConsumer {
+  llvm::raw_ostream &OS;
+  llvm::SetVector<std::string> &Dependencies;
+  std::string Error;
+
+  void printSymbol(const IndexSymbol &symbol) {
+    OS << unsigned(symbol.kind) << ' ' << symbol.subKinds << ' '
+       << symbol.roles;
+  }
+
+public:
+  RecordingConsumer(llvm::raw_ostream &OS,
+                    llvm::SetVector<std::string> &Dependencies)
+    : OS(OS), Dependencies(Dependencies) {}
+
+  StringRef getError() const { return Error; }
+
+  void failed(StringRef error) override { Error = error; }
+
+  bool recordHash(StringRef hash, bool isKnown) override { return true; }
+
+  bool startDependency(SymbolKind kind, StringRef name, StringRef path,
+                       bool isSystem, StringRef hash) override {
+    std::string line;
+    llvm::raw_string_ostream LineOS(line);
+    LineOS << "dep " << (kind == SymbolKind::ClangModule ? "clang" : "swift")
+           << ' ' << (isSystem ? "system" : "user") << ' ' << name << ' '
+           << path;
+    Dependencies.insert(LineOS.str());
+    return true;
+  }
+
+  bool finishDependency(SymbolKind kind) override { return true; }
+
+  bool startSourceEntity(const IndexSymbol &symbol) override {
+    OS << "symbol ";
+    printSymbol(symbol);
+    OS << ' ' << symbol.line << ':' << symbol.column << ' ' << symbol.USR
+       << ' ' << symbol.name << '\n';
+    return true;
+  }
+
+  bool recordRelatedEntity(const IndexSymbol &symbol) override {
+    OS << "  related ";
+    printSymbol(symbol);
+    OS << ' ' << symbol.USR << ' ' << symbol.name << '\n';
+    return true;
+  }
+
+  bool finishSourceEntity(SymbolKind kind, SymbolSubKindSet subKinds,
+                          SymbolRoleSet roles) override {
+    return true;
+  }
+};
+} // end anonymous namespace
+
+static std::string getHashString(StringRef contents) {
+  llvm::MD5 hash;
+  hash.update(contents);
+  llvm::MD5::MD5Result hashBuf;
+  hash.final(hashBuf);
+  SmallString<32> out;
+  llvm::MD5::stringifyResult(hashBuf, out);
+  return out.str();
+}
+
+/// Returns the path of the directory \p kind ("records" or "units") in the
+/// store at \p indexStorePath, creating it if needed.
+static bool getStoreDirectory(StringRef indexStorePath, StringRef kind,
+                              SmallVectorImpl<char> &path,
+                              DiagnosticEngine &diags) {
+  path.assign(indexStorePath.begin(), indexStorePath.end());
+  llvm::sys::path::append(path, "v" + std::to_string(indexStoreVersion), kind);
+  if (auto err = llvm::sys::fs::create_directories(path)) {
+    diags.diagnose(SourceLoc(), diag::error_opening_output,
+                   StringRef(path.data(), path.size()), err.message());
+    return true;
+  }
+  return false;
+}
+
+/// Writes \p contents to \p path via a temporary file, so that readers never
+/// see a partially written file.
+static bool writeFileAtomically(StringRef path, StringRef contents,
+                                DiagnosticEngine &diags) {
+  SmallString<128> tmpPath(path);
+  tmpPath += "-%%%%%%";
+  int tmpFD;
+  if (auto err = llvm::sys::fs::createUniqueFile(tmpPath.str(), tmpFD,
+                                                 tmpPath)) {
+    diags.diagnose(SourceLoc(), diag::error_opening_output, path,
+                   err.message());
+    return true;
+  }
+
+  {
+    llvm::raw_fd_ostream out(tmpFD, /*shouldClose=*/true);
+    out << contents;
+    out.close();
+    if (out.has_error()) {
+      out.clear_error();
+      llvm::sys::fs::remove(tmpPath.str());
+      diags.diagnose(SourceLoc(), diag::error_opening_output, path,
+                     "could not write file");
+      return true;
+    }
+  }
+
+  if (auto err = llvm::sys::fs::rename(tmpPath.str(), path)) {
+    llvm::sys::fs::remove(tmpPath.str());
+    diags.diagnose(SourceLoc(), diag::error_opening_output, path,
+                   err.message());
+    return true;
+  }
+  return false;
+}
+
+/// Indexes \p SF and writes its record unless an identical one already
+/// exists. On success \p recordName is set to the name of the record.
+static bool recordSourceFile(SourceFile *SF, StringRef recordsDir,
+                             llvm::SetVector<std::string> &dependencies,
+                             std::string &recordName,
+                             DiagnosticEngine &diags) {
+  std::string contents;
+  {
+    llvm::raw_string_ostream OS(contents);
+    RecordingConsumer consumer(OS, dependencies);
+    indexSourceFile(SF, /*hash=*/"", consumer);
+    if (!consumer.getError().empty()) {
+      diags.diagnose(SourceLoc(), diag::error_opening_output,
+                     SF->getFilename(), consumer.getError());
+      return true;
+    }
+  }
+
+  recordName = llvm::sys::path::filename(SF->getFilename());
+  recordName += '-';
+  recordName += getHashString(contents);
+
+  // Records are named by their contents, so an existing record is up to date.
+  SmallString<128> recordPath(recordsDir);
+  llvm::sys::path::append(recordPath, recordName);
+  if (llvm::sys::fs::exists(recordPath))
+    return false;
+  return writeFileAtomically(recordPath, contents, diags);
+}
+
+static bool writeUnit(ModuleDecl *module, StringRef indexUnitToken,
+                      StringRef indexStorePath,
+                      ArrayRef<std::pair<StringRef, std::string>> records,
+                      const llvm::SetVector<std::string> &dependencies,
+                      DiagnosticEngine &diags) {
+  SmallString<128> unitPath;
+  if (getStoreDirectory(indexStorePath, "units", unitPath, diags))
+    return true;
+
+  // units/<output file name>-<hash of the full output path>
+  {
+    SmallString<64> unitName(llvm::sys::path::filename(indexUnitToken));
+    unitName += '-';
+    unitName += getHashString(indexUnitToken);
+    llvm::sys::path::append(unitPath, unitName);
+  }
+
+  std::string contents;
+  {
+    llvm::raw_string_ostream OS(contents);
+    OS << "module " << module->getName().str() << '\n';
+    OS << "output " << indexUnitToken << '\n';
+    for (auto &record : records)
+      OS << "file " << record.first << ' ' << record.second << '\n';
+    for (auto &dependency : dependencies)
+      OS << dependency << '\n';
+  }
+
+  // Leave an unchanged unit alone, so that clients watching the store only
+  // see the compilations whose index data actually changed.
+  auto existing = llvm::MemoryBuffer::getFile(unitPath);
+  if (existing && existing.get()->getBuffer() == contents)
+    return false;
+  return writeFileAtomically(unitPath, contents, diags);
+}
+
+static bool indexAndRecordFiles(ModuleDecl *module,
+                                ArrayRef<SourceFile *> sourceFiles,
+                                StringRef indexUnitToken,
+                                StringRef indexStorePath,
+                                DiagnosticEngine &diags) {
+  SmallString<128> recordsDir;
+  if (getStoreDirectory(indexStorePath, "records", recordsDir, diags))
+    return true;
+
+  llvm::SetVector<std::string> dependencies;
+  SmallVector<std::pair<StringRef, std::string>, 8> records;
+  for (auto *SF : sourceFiles) {
+    if (!SF->getBufferID().hasValue())
+      continue;
+    std::string recordName;
+    if (recordSourceFile(SF, recordsDir, dependencies, recordName, diags))
+      return true;
+    records.push_back({SF->getFilename(), std::move(recordName)});
+  }
+
+  return writeUnit(module, indexUnitToken, indexStorePath, records,
+                   dependencies, diags);
+}
+
+bool index::indexAndRecord(SourceFile *primarySourceFile,
+                           StringRef indexUnitToken, StringRef indexStorePath,
+                           DiagnosticEngine &diags) {
+  assert(primarySourceFile);
+  return indexAndRecordFiles(primarySourceFile->getParentModule(),
+                             primarySourceFile, indexUnitToken,
+                             indexStorePath, diags);
+}
+
+bool index::indexAndRecord(ModuleDecl *module, StringRef indexUnitToken,
+                           StringRef indexStorePath, DiagnosticEngine &diags) {
+  assert(module);
+  SmallVector<SourceFile *, 16> sourceFiles;
+  for (auto *file : module->getFiles())
+    if (auto *SF = dyn_cast<SourceFile>(file))
+      sourceFiles.push_back(SF);
+  return indexAndRecordFiles(module, sourceFiles, indexUnitToken,
+                             indexStorePath, diags);
+}
@@ -28,6 +28,10 @@
 // FIXME: Figure out if this can be migrated to LLVM.
 #include "clang/Basic/CharInfo.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 using namespace swift;
 
 // clang::isIdentifierHead and clang::isIdentifierBody are deliberately not in
@@ -289,6 +293,118 @@ Lexer::State Lexer::getStateForBeginningOfTokenLoc(SourceLoc Loc) const {
   return State(SourceLoc(llvm::SMLoc::getFromPointer(Ptr)));
 }
 
+//===----------------------------------------------------------------------===//
+// Fast scanning helpers
+//===----------------------------------------------------------------------===//
+//
+// The functions below skip runs of plain ASCII characters which don't need
+// any special handling, 16 bytes at a time. They return the first character
+// which might be interesting for the caller, which then continues with the
+// regular character-by-character loop. They never read beyond BufferEnd and
+// simply return Ptr if the target doesn't support SSE2 or if there are less
+// than 16 bytes left.
+
+#if defined(__SSE2__)
+namespace {
+/// Advance \p Ptr to the first 16 byte block in [Ptr, End) for which
+/// \p GetStopMask returns a non-zero mask, and return the position of the
+/// first stop character in that block.
+template <typename MaskFn>
+const char *skipBlocks(const char *Ptr, const char *End, MaskFn GetStopMask) {
+  while (End - Ptr >= 16) {
+    __m128i Chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Ptr));
+    if (unsigned Mask = _mm_movemask_epi8(GetStopMask(Chars)))
+      return Ptr + llvm::countTrailingZeros(Mask);
+    Ptr += 16;
+  }
+  return Ptr;
+}
+
+/// Returns a mask of the bytes which are nul or not ASCII.
+__m128i getNulOrNonASCIIMask(__m128i Chars) {
+  return _mm_cmplt_epi8(Chars, _mm_set1_epi8(1));
+}
+
+/// Returns a mask of the bytes which are equal to \p C.
+__m128i getCharMask(__m128i Chars, char C) {
+  return _mm_cmpeq_epi8(Chars, _mm_set1_epi8(C));
+}
+
+/// Returns a mask of the bytes in the range [\p Lo, \p Hi].
+/// Only valid for ASCII bounds.
+__m128i getRangeMask(__m128i Chars, char Lo, char Hi) {
+  return _mm_and_si128(_mm_cmpgt_epi8(Chars, _mm_set1_epi8(Lo - 1)),
+                       _mm_cmplt_epi8(Chars, _mm_set1_epi8(Hi + 1)));
+}
+} // end anonymous namespace
+#endif
+
+/// Skip characters in a // comment which don't end the line.
+static const char *skipLineCommentChars(const char *Ptr, const char *End) {
+#if defined(__SSE2__)
+  return skipBlocks(Ptr, End, [](__m128i Chars) {
+    return _mm_or_si128(getNulOrNonASCIIMask(Chars),
+                        _mm_or_si128(getCharMask(Chars, '\n'),
+                                     getCharMask(Chars, '\r')));
+  });
+#else
+  return Ptr;
+#endif
+}
+
+/// Skip characters in a /* comment which can neither start nor end a nested
+/// comment nor end the line.
+static const char *skipBlockCommentChars(const char *Ptr, const char *End) {
+#if defined(__SSE2__)
+  return skipBlocks(Ptr, End, [](__m128i Chars) {
+    __m128i Delimiters = _mm_or_si128(getCharMask(Chars, '*'),
+                                      getCharMask(Chars, '/'));
+    __m128i Newlines = _mm_or_si128(getCharMask(Chars, '\n'),
+                                    getCharMask(Chars, '\r'));
+    return _mm_or_si128(getNulOrNonASCIIMask(Chars),
+                        _mm_or_si128(Delimiters, Newlines));
+  });
+#else
+  return Ptr;
+#endif
+}
+
+/// Skip printable ASCII characters in a string literal which are neither
+/// quotes nor the start of an escape.
+static const char *skipStringLiteralChars(const char *Ptr, const char *End) {
+#if defined(__SSE2__)
+  return skipBlocks(Ptr, End, [](__m128i Chars) {
+    // Control characters and non-ASCII characters (which are negative).
+    __m128i Unprintable = _mm_or_si128(
+        _mm_cmplt_epi8(Chars, _mm_set1_epi8(' ')), getCharMask(Chars, 0x7F));
+    __m128i Special = _mm_or_si128(
+        _mm_or_si128(getCharMask(Chars, '"'), getCharMask(Chars, '\'')),
+        getCharMask(Chars, '\\'));
+    return _mm_or_si128(Unprintable, Special);
+  });
+#else
+  return Ptr;
+#endif
+}
+
+/// Skip ASCII characters which can continue an identifier.
+static const char *skipIdentifierChars(const char *Ptr, const char *End) {
+#if defined(__SSE2__)
+  return skipBlocks(Ptr, End, [](__m128i Chars) {
+    __m128i Letters = _mm_or_si128(getRangeMask(Chars, 'a', 'z'),
+                                   getRangeMask(Chars, 'A', 'Z'));
+    __m128i Others = _mm_or_si128(
+        getRangeMask(Chars, '0', '9'),
+        _mm_or_si128(getCharMask(Chars, '_'), getCharMask(Chars, '$')));
+    // Stop at every character which is not an identifier character.
+    return _mm_xor_si128(_mm_or_si128(Letters, Others),
+                         _mm_set1_epi8(char(0xFF)));
+  });
+#else
+  return Ptr;
+#endif
+}
+
 //===----------------------------------------------------------------------===//
 // Lexer Subroutines
 //===----------------------------------------------------------------------===//
@@ -308,6 +424,7 @@ static void diagnoseEmbeddedNul(DiagnosticEngine *Diags, const char *Ptr) {
 
 void Lexer::skipToEndOfLine() {
   while (1) {
+    CurPtr = skipLineCommentChars(CurPtr, BufferEnd);
     switch (*CurPtr++) {
     case '\n':
     case '\r':
@@ -361,6 +478,7 @@ void Lexer::skipSlashStarComment() {
   unsigned Depth = 1;
   
   while (1) {
+    CurPtr = skipBlockCommentChars(CurPtr, BufferEnd);
     switch (*CurPtr++) {
     case '*':
       // Check for a '*/'
@@ -569,7 +687,9 @@ void Lexer::lexIdentifier() {
   (void) didStart;
 
   // Lex [a-zA-Z_$0-9[[:XID_Continue:]]]*
-  while (advanceIfValidContinuationOfIdentifier(CurPtr, BufferEnd));
+  do {
+    CurPtr = skipIdentifierChars(CurPtr, BufferEnd);
+  } while (advanceIfValidContinuationOfIdentifier(CurPtr, BufferEnd));
 
   tok Kind = kindOfIdentifier(StringRef(TokStart, CurPtr-TokStart), InSILMode);
   return formToken(Kind, TokStart);
@@ -1251,6 +1371,8 @@ void Lexer::lexStringLiteral() {
   bool wasErroneous = false;
   
   while (true) {
+    CurPtr = skipStringLiteralChars(CurPtr, BufferEnd);
+
     if (*CurPtr == '\\' && *(CurPtr + 1) == '(') {
       // Consume tokens until we hit the corresponding ')'.
       CurPtr += 2;
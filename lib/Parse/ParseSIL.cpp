@@ -3756,13 +3756,16 @@ bool SILParser::parseCallInstruction(SILLocation InstLoc,
 
   auto PartialApplyConvention = ParameterConvention::Direct_Owned;
   bool IsNonThrowingApply = false;
+  bool IsStackAllocatable = false;
   StringRef AttrName;
   
-  if (parseSILOptional(AttrName, *this)) {
+  while (parseSILOptional(AttrName, *this)) {
     if (AttrName.equals("nothrow"))
       IsNonThrowingApply = true;
     else if (AttrName.equals("callee_guaranteed"))
       PartialApplyConvention = ParameterConvention::Direct_Guaranteed;
+    else if (AttrName.equals("stack") && Opcode == ValueKind::PartialApplyInst)
+      IsStackAllocatable = true;
     else
       return true;
   }
@@ -3867,8 +3870,11 @@ bool SILParser::parseCallInstruction(SILLocation InstLoc,
       SILBuilder::getPartialApplyResultType(Ty, ArgNames.size(), SILMod, subs,
                                             PartialApplyConvention);
     // FIXME: Why the arbitrary order difference in IRBuilder type argument?
-    ResultVal = B.createPartialApply(InstLoc, FnVal, FnTy,
+    auto *PAI = B.createPartialApply(InstLoc, FnVal, FnTy,
                                      subs, Args, closureTy);
+    if (IsStackAllocatable)
+      PAI->setStackAllocatable();
+    ResultVal = PAI;
     break;
   }
   case ValueKind::TryApplyInst: {
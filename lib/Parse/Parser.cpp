@@ -53,15 +53,22 @@ class ParseDelayedFunctionBodies : public ASTWalker {
   PersistentParserState &ParserState;
   CodeCompletionCallbacksFactory *CodeCompletionFactory;
 
+  /// If true, only parse the bodies which can be inlined into other files.
+  bool OnlyInlinableBodies;
+
 public:
   ParseDelayedFunctionBodies(PersistentParserState &ParserState,
-                             CodeCompletionCallbacksFactory *Factory)
-    : ParserState(ParserState), CodeCompletionFactory(Factory) {}
+                             CodeCompletionCallbacksFactory *Factory,
+                             bool OnlyInlinableBodies = false)
+    : ParserState(ParserState), CodeCompletionFactory(Factory),
+      OnlyInlinableBodies(OnlyInlinableBodies) {}
 
   bool walkToDeclPre(Decl *D) override {
     if (auto AFD = dyn_cast<AbstractFunctionDecl>(D)) {
       if (AFD->getBodyKind() != FuncDecl::BodyKind::Unparsed)
         return false;
+      if (OnlyInlinableBodies && !isInlinable(AFD))
+        return false;
       parseFunctionBody(AFD);
       return true;
     }
@@ -69,6 +76,11 @@ public:
   }
 
 private:
+  static bool isInlinable(AbstractFunctionDecl *AFD) {
+    return AFD->isTransparent() ||
+           AFD->getAttrs().hasAttribute<InlineableAttr>();
+  }
+
   void parseFunctionBody(AbstractFunctionDecl *AFD) {
     assert(AFD->getBodyKind() == FuncDecl::BodyKind::Unparsed);
 
@@ -164,6 +176,14 @@ void swift::performDelayedParsing(
     parseDelayedDecl(PersistentState, CodeCompletionFactory);
 }
 
+void swift::performDelayedParsingOfInlinableBodies(
+    DeclContext *DC, PersistentParserState &PersistentState) {
+  SharedTimer timer("Parsing");
+  ParseDelayedFunctionBodies Walker(PersistentState, /*Factory=*/nullptr,
+                                    /*OnlyInlinableBodies=*/true);
+  DC->walkContext(Walker);
+}
+
 /// \brief Tokenizes a string literal, taking into account string interpolation.
 static void getStringPartTokens(const Token &Tok, const LangOptions &LangOpts,
                                 const SourceManager &SM,
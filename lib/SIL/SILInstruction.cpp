@@ -951,6 +951,10 @@ bool SILInstruction::isAllocatingStack() const {
     if (ARI->canAllocOnStack())
       return true;
   }
+  if (auto *PAI = dyn_cast<PartialApplyInst>(this)) {
+    if (PAI->canAllocOnStack())
+      return true;
+  }
   return false;
 }
 
@@ -989,6 +993,10 @@ bool SILInstruction::isTriviallyDuplicatable() const {
     if (ARI->canAllocOnStack())
       return false;
   }
+  if (auto *PAI = dyn_cast<PartialApplyInst>(this)) {
+    if (PAI->canAllocOnStack())
+      return false;
+  }
 
   if (isa<OpenExistentialAddrInst>(this) ||
       isa<OpenExistentialRefInst>(this) ||
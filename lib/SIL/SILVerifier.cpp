@@ -1709,6 +1709,12 @@ public:
   void checkDeallocRefInst(DeallocRefInst *DI) {
     require(DI->getOperand()->getType().isObject(),
             "Operand of dealloc_ref must be object");
+    if (auto *PAI = dyn_cast<PartialApplyInst>(DI->getOperand())) {
+      require(DI->canAllocOnStack() && PAI->canAllocOnStack(),
+              "dealloc_ref of a closure must be a dealloc_ref [stack] of a "
+              "partial_apply [stack]");
+      return;
+    }
     require(DI->getOperand()->getType().getClassOrBoundGenericClass(),
             "Operand of dealloc_ref must be of class type");
   }
@@ -62,7 +62,7 @@ void CallerAnalysis::invalidateExistingCalleeRelation(SILFunction *F) {
   FunctionInfo &CallerInfo = FuncInfos[F];
   for (auto Callee : CallerInfo.Callees) {
     FunctionInfo &CalleeInfo = FuncInfos[Callee];
-    CalleeInfo.Callers.erase(F);
+    CalleeInfo.Callers.remove(F);
     CalleeInfo.PartialAppliers.erase(F);
   }
 }
@@ -265,6 +265,15 @@ void CapturePropagation::rewritePartialApply(PartialApplyInst *OrigPAI,
   auto FuncRef = Builder.createFunctionRef(OrigPAI->getLoc(), SpecialF);
   auto *T2TF = Builder.createThinToThickFunction(OrigPAI->getLoc(),
                                                  FuncRef, OrigPAI->getType());
+  // The new closure doesn't have a context which needs to be deallocated.
+  if (OrigPAI->canAllocOnStack()) {
+    SmallVector<SILInstruction *, 2> Deallocs;
+    for (Operand *Use : OrigPAI->getUses())
+      if (isa<DeallocRefInst>(Use->getUser()))
+        Deallocs.push_back(Use->getUser());
+    for (SILInstruction *Dealloc : Deallocs)
+      Dealloc->eraseFromParent();
+  }
   OrigPAI->replaceAllUsesWith(T2TF);
   recursivelyDeleteTriviallyDeadInstructions(OrigPAI, true);
   DEBUG(llvm::dbgs() << "  Rewrote caller:\n" << *T2TF);
@@ -189,6 +189,9 @@ public:
   SILInstruction *
   createNewClosure(SILBuilder &B, SILValue V,
                    llvm::SmallVectorImpl<SILValue> &Args) const {
+    // The new closure is created inside the specialized function and has no
+    // dealloc_ref [stack], so its context is always allocated on the heap,
+    // even if the original closure's context is on the stack.
     if (isa<PartialApplyInst>(getClosure()))
       return B.createPartialApply(getClosure()->getLoc(), V, V->getType(), {},
                                   Args, getClosure()->getType());
@@ -26,6 +26,7 @@
 #include "swift/SILOptimizer/PassManager/Transforms.h"
 #include "swift/SILOptimizer/Utils/CFG.h"
 #include "swift/SILOptimizer/Utils/Local.h"
+#include "swift/SILOptimizer/Utils/RegionCloner.h"
 #include "swift/SILOptimizer/Utils/SILSSAUpdater.h"
 #include "swift/SIL/Dominance.h"
 #include "swift/SIL/PatternMatch.h"
@@ -59,6 +60,16 @@ static llvm::cl::opt<bool> EnableABCOpts("enable-abcopts",
 static llvm::cl::opt<bool> EnableABCHoisting("enable-abc-hoisting",
                                              llvm::cl::init(true));
 
+static llvm::cl::opt<bool> EnableABCLoopVersioning(
+    "enable-abc-loop-versioning", llvm::cl::init(false),
+    llvm::cl::desc("Version loops on a bounds check predicate to remove "
+                   "conditionally executed bounds checks"));
+
+static llvm::cl::opt<unsigned> ABCLoopVersioningSizeLimit(
+    "abc-loop-versioning-size-limit", llvm::cl::init(200),
+    llvm::cl::desc("The maximum number of instructions in a loop that is "
+                   "versioned for bounds check removal"));
+
 
 using ArraySet = llvm::SmallPtrSet<SILValue, 16>;
 // A pair of the array pointer and the array check kind (kCheckIndex or
@@ -900,6 +911,8 @@ public:
 
   operator bool() { return Ind != nullptr; }
 
+  InductionInfo *getInduction() { return Ind; }
+
   static AccessFunction getLinearFunction(SILValue Idx,
                                           InductionAnalysis &IndVars) {
     // Match the actual induction variable buried in the integer struct.
@@ -964,11 +977,35 @@ static bool hasArrayType(SILValue Value, SILModule &M) {
            M.getASTContext().getArrayDecl();
 }
 
+/// A bounds check on the value of a canonical induction variable that could
+/// not be hoisted because it is not executed in every iteration of the loop.
+struct VersionableCheck {
+  ApplyInst *Check;
+  /// The array.get_count call of the checked array.
+  ApplyInst *Count;
+  /// The start and end value of the induction variable.
+  SILValue Start;
+  SILValue End;
+};
+
+/// A loop which can be versioned such that the fast version of the loop does
+/// not contain the bounds checks in \p Checks.
+struct LoopVersioningCandidate {
+  SILBasicBlock *Preheader;
+  SmallVector<VersionableCheck, 4> Checks;
+};
+
 /// Hoist bounds check in the loop to the loop preheader.
-static bool hoistChecksInLoop(DominanceInfo *DT, DominanceInfoNode *DTNode,
-                              ABCAnalysis &ABC, InductionAnalysis &IndVars,
-                              SILBasicBlock *Preheader, SILBasicBlock *Header,
-                              SILBasicBlock *SingleExitingBlk) {
+///
+/// Checks on induction variables which are not executed in every iteration are
+/// added to \p VersionableChecks. Only checks inside \p Loop are added: the
+/// dominator tree below the header also contains blocks after the loop exits.
+static bool
+hoistChecksInLoop(SILLoop *Loop, DominanceInfo *DT, DominanceInfoNode *DTNode,
+                  ABCAnalysis &ABC, InductionAnalysis &IndVars,
+                  SILBasicBlock *Preheader, SILBasicBlock *Header,
+                  SILBasicBlock *SingleExitingBlk,
+                  SmallVectorImpl<VersionableCheck> &VersionableChecks) {
 
   bool Changed = false;
   auto *CurBB = DTNode->getBlock();
@@ -1045,8 +1082,16 @@ static bool hoistChecksInLoop(DominanceInfo *DT, DominanceInfoNode *DTNode,
     }
     
     // For hoisting bounds checks the block must dominate the exit block.
-    if (!blockAlwaysExecutes)
+    // Otherwise we can still remove the check in a versioned loop.
+    if (!blockAlwaysExecutes) {
+      if (Loop->contains(CurBB) &&
+          hasArrayType(ArrayVal, Header->getModule())) {
+        auto *Ind = F.getInduction();
+        VersionableChecks.push_back({ArrayCall, nullptr, Ind->Start, Ind->End});
+        DEBUG(llvm::dbgs() << "  Bounds check is versionable\n");
+      }
       continue;
+    }
 
     // Hoist the access function and the check to the preheader for start and
     // end of the induction.
@@ -1065,8 +1110,8 @@ static bool hoistChecksInLoop(DominanceInfo *DT, DominanceInfoNode *DTNode,
   DEBUG(Preheader->getParent()->dump());
   // Traverse the children in the dominator tree.
   for (auto Child: *DTNode)
-    Changed |= hoistChecksInLoop(DT, Child, ABC, IndVars, Preheader,
-                                 Header, SingleExitingBlk);
+    Changed |= hoistChecksInLoop(Loop, DT, Child, ABC, IndVars, Preheader,
+                                 Header, SingleExitingBlk, VersionableChecks);
 
   return Changed;
 }
@@ -1129,11 +1174,95 @@ static bool isComparisonKnownFalse(BuiltinInst *Builtin,
   return false;
 }
 
+/// Find an array.get_count call on the array checked by \p Check which can
+/// provide the array's count at the end of the loop preheader.
+///
+/// This is either a call on the same array value which dominates the
+/// preheader, or a call in the loop which can be hoisted to the preheader. The
+/// array is not modified in the loop, so any load of the array in the loop
+/// yields the same count.
+static ApplyInst *findCountForCheck(ApplyInst *Check, SILLoop *Loop,
+                                    SILBasicBlock *Preheader,
+                                    DominanceInfo *DT) {
+  SILValue ArrayVal = ArraySemanticsCall(Check).getSelf();
+
+  SmallVector<SILValue, 4> ArrayValues;
+  if (dominates(DT, ArrayVal, Preheader)) {
+    ArrayValues.push_back(ArrayVal);
+  } else if (auto *LI = dyn_cast<LoadInst>(ArrayVal)) {
+    for (auto *Use : LI->getOperand()->getUses()) {
+      auto *OtherLI = dyn_cast<LoadInst>(Use->getUser());
+      if (OtherLI && Loop->contains(OtherLI->getParent()))
+        ArrayValues.push_back(OtherLI);
+    }
+  }
+
+  for (SILValue Array : ArrayValues) {
+    for (auto *Use : Array->getUses()) {
+      ArraySemanticsCall Count(Use->getUser(), "array.get_count");
+      if (!Count || Count.getSelf() != Array)
+        continue;
+
+      ApplyInst *CountCall = Count;
+      if (Loop->contains(CountCall->getParent())) {
+        if (Count.canHoist(Preheader->getTerminator(), DT))
+          return CountCall;
+        continue;
+      }
+      if (DT->dominates(CountCall->getParent(), Preheader))
+        return CountCall;
+    }
+  }
+  return nullptr;
+}
+
+/// Collect the bounds checks of the loop which can be removed in a versioned
+/// copy of the loop. Returns false if the loop should not be versioned.
+static bool
+collectVersioningCandidate(SILLoop *Loop, SILBasicBlock *Preheader,
+                           DominanceInfo *DT,
+                           SmallVectorImpl<VersionableCheck> &Checks,
+                           LoopVersioningCandidate &Candidate) {
+  if (Checks.empty())
+    return false;
+
+  // We have to duplicate the whole loop. Bail if we can't or if the loop is
+  // too big.
+  unsigned NumInsts = 0;
+  for (auto *BB : Loop->getBlocks())
+    for (auto &Inst : *BB) {
+      if (!Loop->canDuplicate(&Inst))
+        return false;
+      if (++NumInsts > ABCLoopVersioningSizeLimit)
+        return false;
+    }
+
+  Candidate.Preheader = Preheader;
+  for (auto &Check : Checks) {
+    assert(Loop->contains(Check.Check->getParent()) &&
+           "Only checks in the loop are removed in the versioned loop");
+    // The predicate compares the range of the induction variable to the
+    // array's count, so we need a count at the preheader.
+    Check.Count = findCountForCheck(Check.Check, Loop, Preheader, DT);
+    if (!Check.Count) {
+      DEBUG(llvm::dbgs() << " no count found for " << *Check.Check);
+      continue;
+    }
+    Candidate.Checks.push_back(Check);
+  }
+  return !Candidate.Checks.empty();
+}
+
 /// Analyze the loop for arrays that are not modified and perform dominator tree
 /// based redundant bounds check removal.
-static bool hoistBoundsChecks(SILLoop *Loop, DominanceInfo *DT, SILLoopInfo *LI,
-                              IVInfo &IVs, ArraySet &Arrays,
-                              RCIdentityFunctionInfo *RCIA, bool ShouldVerify) {
+///
+/// Loops with bounds checks that can be removed by versioning the loop are
+/// added to \p Candidates.
+static bool
+hoistBoundsChecks(SILLoop *Loop, DominanceInfo *DT, SILLoopInfo *LI,
+                  IVInfo &IVs, ArraySet &Arrays, RCIdentityFunctionInfo *RCIA,
+                  bool ShouldVerify,
+                  SmallVectorImpl<LoopVersioningCandidate> &Candidates) {
   auto *Header = Loop->getHeader();
   if (!Header) return false;
 
@@ -1269,14 +1398,169 @@ static bool hoistBoundsChecks(SILLoop *Loop, DominanceInfo *DT, SILLoopInfo *LI,
   DEBUG(Preheader->getParent()->dump());
 
   // Hoist bounds checks.
-  Changed |= hoistChecksInLoop(DT, DT->getNode(Header), ABC, IndVars,
-                               Preheader, Header, SingleExitingBlk);
+  SmallVector<VersionableCheck, 4> VersionableChecks;
+  Changed |= hoistChecksInLoop(Loop, DT, DT->getNode(Header), ABC, IndVars,
+                               Preheader, Header, SingleExitingBlk,
+                               VersionableChecks);
   if (Changed) {
     Preheader->getParent()->verify();
   }
+
+  if (EnableABCLoopVersioning) {
+    LoopVersioningCandidate Candidate;
+    if (collectVersioningCandidate(Loop, Preheader, DT, VersionableChecks,
+                                   Candidate))
+      Candidates.push_back(std::move(Candidate));
+  }
   return Changed;
 }
 
+/// Create the Builtin.Int1 predicate "0 <= Start < End <= Count" which
+/// guarantees that all indices in the range of the induction variable are valid
+/// subscripts of the array.
+static SILValue createInBoundsPredicate(SILBuilder &B, SILLocation Loc,
+                                        VersionableCheck &Check,
+                                        SILValue Count) {
+  auto Int1Ty = SILType::getBuiltinIntegerType(1, B.getASTContext());
+  auto IndexTy = Check.Start->getType();
+  auto *Zero = B.createIntegerLiteral(Loc, IndexTy, 0);
+
+  SILValue StartNonNegative = B.createBuiltinBinaryFunction(
+      Loc, "cmp_sge", IndexTy, Int1Ty, {Check.Start, Zero});
+  SILValue NotEmpty = B.createBuiltinBinaryFunction(
+      Loc, "cmp_slt", IndexTy, Int1Ty, {Check.Start, Check.End});
+  SILValue EndInBounds = B.createBuiltinBinaryFunction(
+      Loc, "cmp_sle", IndexTy, Int1Ty, {Check.End, Count});
+
+  SILValue Result = B.createBuiltinBinaryFunction(
+      Loc, "and", Int1Ty, Int1Ty, {StartNonNegative, NotEmpty});
+  return B.createBuiltinBinaryFunction(Loc, "and", Int1Ty, Int1Ty,
+                                       {Result, EndInBounds});
+}
+
+/// Returns the field holding the builtin integer value of the Int returned by
+/// an array.get_count call.
+static VarDecl *getCountValueField(ApplyInst *CountCall) {
+  auto *IntDecl = CountCall->getType().getStructOrBoundGenericStruct();
+  if (!IntDecl)
+    return nullptr;
+  auto Fields = IntDecl->getStoredProperties();
+  if (Fields.empty() || std::next(Fields.begin()) != Fields.end())
+    return nullptr;
+  return *Fields.begin();
+}
+
+/// Version the loop of \p Candidate:
+///
+///   if (0 <= start && start < end && end <= a.count) {
+///     for i in start..<end { if c { a[i] /* no check */ } }
+///   } else {
+///     for i in start..<end { if c { a[i] /* checked */ } }
+///   }
+///
+/// The fast version of the loop contains no bounds checks and no control
+/// flow from them, which lets LLVM's loop vectorizer handle it.
+static bool versionLoop(LoopVersioningCandidate &Candidate, DominanceInfo *DT,
+                        SILLoopAnalysis *LA) {
+  auto *Preheader = Candidate.Preheader;
+  auto *Header = Preheader->getSingleSuccessor();
+  if (!Header)
+    return false;
+
+  // Earlier versioning invalidated the loop info; get an updated loop.
+  auto *F = Preheader->getParent();
+  auto *Loop = LA->get(F)->getLoopFor(Header);
+  if (!Loop || Loop->getHeader() != Header ||
+      Loop->getLoopPreheader() != Preheader)
+    return false;
+
+  // Make sure that we can still compute the predicate in the preheader.
+  SmallVector<bool, 4> HoistCount;
+  for (auto &Check : Candidate.Checks) {
+    if (!dominates(DT, Check.Start, Preheader) ||
+        !dominates(DT, Check.End, Preheader) ||
+        Check.Start->getType() != Check.End->getType())
+      return false;
+
+    auto *Field = getCountValueField(Check.Count);
+    if (!Field || Check.Count->getType().getFieldType(Field, F->getModule()) !=
+                      Check.Start->getType())
+      return false;
+
+    bool IsInLoop = Loop->contains(Check.Count->getParent());
+    if (IsInLoop ? !ArraySemanticsCall(Check.Count)
+                        .canHoist(Preheader->getTerminator(), DT)
+                 : !DT->dominates(Check.Count->getParent(), Preheader))
+      return false;
+    HoistCount.push_back(IsInLoop);
+  }
+
+  DEBUG(llvm::dbgs() << "Versioning loop for bounds checks " << *Loop);
+
+  // Split of a new empty preheader which will contain the check whether to
+  // execute the unchecked or the original loop.
+  SILBuilder B(Preheader);
+  auto *CheckBlock = splitBasicBlockAndBranch(B, Preheader->getTerminator(),
+                                              DT, nullptr);
+
+  // The loop info is not updated by the cloner, but the exit blocks of the
+  // original loop stay valid.
+  SmallVector<SILBasicBlock *, 16> ExitBlocks;
+  Loop->getExitBlocks(ExitBlocks);
+
+  SmallVector<SILBasicBlock *, 16> ExitBlocksDominatedByCheck;
+  for (auto *ExitBlock : ExitBlocks)
+    if (DT->dominates(CheckBlock, ExitBlock))
+      ExitBlocksDominatedByCheck.push_back(ExitBlock);
+
+  SILBasicBlock *NewPreheader =
+      splitBasicBlockAndBranch(B, &*CheckBlock->begin(), DT, nullptr);
+
+  // Clone the loop. The clone becomes the fast version of the loop.
+  RegionCloner Cloner(NewPreheader, ExitBlocks, *DT);
+  auto *ClonedPreheader = Cloner.cloneRegion();
+
+  // Compute the predicate in the check block.
+  auto *CheckTerm = CheckBlock->getTerminator();
+  SILLocation Loc = CheckTerm->getLoc();
+  B.setInsertionPoint(CheckTerm);
+  SILValue InBounds;
+  for (unsigned Idx = 0, End = Candidate.Checks.size(); Idx != End; ++Idx) {
+    auto &Check = Candidate.Checks[Idx];
+    ApplyInst *CountCall = Check.Count;
+    if (HoistCount[Idx])
+      CountCall = ArraySemanticsCall(CountCall).copyTo(CheckTerm, DT);
+    SILValue Count =
+        B.createStructExtract(Loc, CountCall, getCountValueField(CountCall));
+    SILValue Pred = createInBoundsPredicate(B, Loc, Check, Count);
+    if (InBounds) {
+      auto Int1Ty = SILType::getBuiltinIntegerType(1, B.getASTContext());
+      InBounds = B.createBuiltinBinaryFunction(Loc, "and", Int1Ty, Int1Ty,
+                                               {InBounds, Pred});
+    } else {
+      InBounds = Pred;
+    }
+  }
+  B.createCondBranch(Loc, InBounds, ClonedPreheader, NewPreheader);
+  CheckTerm->eraseFromParent();
+
+  // Fixup the exit blocks. They are now dominated by the check block.
+  for (auto *BB : ExitBlocksDominatedByCheck)
+    DT->changeImmediateDominator(DT->getNode(BB), DT->getNode(CheckBlock));
+
+  // Remove the bounds checks from the fast loop.
+  for (auto &Check : Candidate.Checks) {
+    auto *ClonedCheck = Cloner.getClonedInstruction(Check.Check);
+    assert(ClonedCheck && "Bounds check must be in the cloned loop");
+    ArraySemanticsCall(ClonedCheck).removeCall();
+    DEBUG(llvm::dbgs() << "  Bounds check removed in versioned loop\n");
+  }
+
+  // We have cloned a loop - invalidate loop info.
+  LA->invalidate(F, SILAnalysis::InvalidationKind::FunctionBody);
+  return true;
+}
+
 #ifndef NDEBUG
 static void reportBoundsChecks(SILFunction *F) {
   unsigned NumBCs = 0;
@@ -1365,6 +1649,8 @@ public:
     if (ShouldReportBoundsChecks) { reportBoundsChecks(F); };
 
     bool ShouldVerify = getOptions().VerifyAll;
+    SmallVector<LoopVersioningCandidate, 4> VersioningCandidates;
+    bool VersionedLoops = false;
 
     if (LI->empty()) {
       DEBUG(llvm::dbgs() << "No loops in " << F->getName() << "\n");
@@ -1384,14 +1670,29 @@ public:
 
         while (!Worklist.empty()) {
           Changed |= hoistBoundsChecks(Worklist.pop_back_val(), DT, LI, IVs,
-                                       ReleaseSafeArrays, RCIA, ShouldVerify);
+                                       ReleaseSafeArrays, RCIA, ShouldVerify,
+                                       VersioningCandidates);
         }
       }
 
+      // Version loops with bounds checks that could not be hoisted because
+      // they are executed conditionally.
+      for (auto &Candidate : VersioningCandidates)
+        VersionedLoops |= versionLoop(Candidate, DT, LA);
+
+      if (VersionedLoops)
+        splitAllCriticalEdges(*F, true /* only cond_br terminators*/, DT,
+                              nullptr);
+
       if (ShouldReportBoundsChecks) { reportBoundsChecks(F); };
     }
 
-    if (Changed) {
+    if (VersionedLoops) {
+      // We preserve the dominator tree. Let's invalidate everything else.
+      DA->lockInvalidation();
+      PM->invalidateAnalysis(F, SILAnalysis::InvalidationKind::FunctionBody);
+      DA->unlockInvalidation();
+    } else if (Changed) {
       PM->invalidateAnalysis(F,
                           SILAnalysis::InvalidationKind::CallsAndInstructions);
     }
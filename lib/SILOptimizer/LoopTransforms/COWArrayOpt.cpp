@@ -31,6 +31,7 @@
 #include "swift/SILOptimizer/PassManager/Transforms.h"
 #include "swift/SILOptimizer/Utils/CFG.h"
 #include "swift/SILOptimizer/Utils/Local.h"
+#include "swift/SILOptimizer/Utils/RegionCloner.h"
 #include "swift/SILOptimizer/Utils/SILSSAUpdater.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/StringExtras.h"
@@ -1932,177 +1933,6 @@ private:
 };
 } // End anonymous namespace.
 
-namespace {
-/// Clone a single exit multiple exit region starting at basic block and ending
-/// in a set of basic blocks. Updates the dominator tree with the cloned blocks.
-/// However, the client needs to update the dominator of the exit blocks.
-class RegionCloner : public SILCloner<RegionCloner> {
-  DominanceInfo &DomTree;
-  SILBasicBlock *StartBB;
-  SmallPtrSet<SILBasicBlock *, 16> OutsideBBs;
-
-  friend class SILVisitor<RegionCloner>;
-  friend class SILCloner<RegionCloner>;
-
-public:
-  RegionCloner(SILBasicBlock *EntryBB,
-               SmallVectorImpl<SILBasicBlock *> &ExitBlocks, DominanceInfo &DT)
-      : SILCloner<RegionCloner>(*EntryBB->getParent()), DomTree(DT),
-        StartBB(EntryBB), OutsideBBs(ExitBlocks.begin(), ExitBlocks.end()) {}
-
-  SILBasicBlock *cloneRegion() {
-    assert (DomTree.getNode(StartBB) != nullptr && "Can't cloned dead code");
-
-    auto CurFun = StartBB->getParent();
-    auto &Mod = CurFun->getModule();
-
-    // We don't want to visit blocks outside of the region. visitSILBasicBlocks
-    // checks BBMap before it clones a block. So we mark exiting blocks as
-    // visited by putting them in the BBMap.
-    for (auto *BB : OutsideBBs)
-      BBMap[BB] = BB;
-
-    // We need to split any edge from a non cond_br basic block leading to a
-    // exit block. After cloning this edge will become critical if it came from
-    // inside the cloned region. The SSAUpdater can't handle critical non
-    // cond_br edges.
-    for (auto *BB : OutsideBBs) {
-      SmallVector<SILBasicBlock*, 8> Preds(BB->getPreds());
-      for (auto *Pred : Preds)
-        if (!isa<CondBranchInst>(Pred->getTerminator()) &&
-            !isa<BranchInst>(Pred->getTerminator()))
-          splitEdgesFromTo(Pred, BB, &DomTree, nullptr);
-    }
-
-    // Create the cloned start basic block.
-    auto *ClonedStartBB = new (Mod) SILBasicBlock(CurFun);
-    BBMap[StartBB] = ClonedStartBB;
-
-    // Clone the arguments.
-    for (auto &Arg : StartBB->getBBArgs()) {
-      SILValue MappedArg =
-          new (Mod) SILArgument(ClonedStartBB, getOpType(Arg->getType()));
-      ValueMap.insert(std::make_pair(Arg, MappedArg));
-    }
-
-    // Clone the instructions in this basic block and recursively clone
-    // successor blocks.
-    getBuilder().setInsertionPoint(ClonedStartBB);
-    visitSILBasicBlock(StartBB);
-
-    // Fix-up terminators.
-    for (auto BBPair : BBMap)
-      if (BBPair.first != BBPair.second) {
-        getBuilder().setInsertionPoint(BBPair.second);
-        visit(BBPair.first->getTerminator());
-      }
-
-    // Add dominator tree nodes for the new basic blocks.
-    fixDomTreeNodes(DomTree.getNode(StartBB));
-
-    // Update SSA form for values used outside of the copied region.
-    updateSSAForm();
-    return ClonedStartBB;
-  }
-
-  llvm::MapVector<SILBasicBlock *, SILBasicBlock *> &getBBMap() { return BBMap; }
-
-protected:
-  /// Clone the dominator tree from the original region to the cloned region.
-  void fixDomTreeNodes(DominanceInfoNode *OrigNode) {
-    auto *BB = OrigNode->getBlock();
-    auto MapIt = BBMap.find(BB);
-    // Outside the cloned region.
-    if (MapIt == BBMap.end())
-      return;
-
-    auto *ClonedBB = MapIt->second;
-    // Exit blocks (BBMap[BB] == BB) end the recursion.
-    if (ClonedBB == BB)
-      return;
-
-    auto *OrigDom = OrigNode->getIDom();
-    assert(OrigDom);
-
-    if (BB == StartBB) {
-      // The cloned start node shares the same dominator as the original node.
-      auto *ClonedNode = DomTree.addNewBlock(ClonedBB, OrigDom->getBlock());
-      (void) ClonedNode;
-      assert(ClonedNode);
-    } else {
-      // Otherwise, map the dominator structure using the mapped block.
-      auto *OrigDomBB = OrigDom->getBlock();
-      assert(BBMap.count(OrigDomBB) && "Must have visited dominating block");
-      auto *MappedDomBB = BBMap[OrigDomBB];
-      assert(MappedDomBB);
-      DomTree.addNewBlock(ClonedBB, MappedDomBB);
-    }
-
-    for (auto *Child : *OrigNode)
-      fixDomTreeNodes(Child);
-  }
-
-  SILValue remapValue(SILValue V) {
-    if (auto *BB = V->getParentBB()) {
-      if (!DomTree.dominates(StartBB, BB)) {
-        // Must be a value that dominates the start basic block.
-        assert(DomTree.dominates(BB, StartBB) &&
-               "Must dominated the start of the cloned region");
-        return V;
-      }
-    }
-    return SILCloner<RegionCloner>::remapValue(V);
-  }
-
-  void postProcess(SILInstruction *Orig, SILInstruction *Cloned) {
-    SILCloner<RegionCloner>::postProcess(Orig, Cloned);
-  }
-
-  /// Update SSA form for values that are used outside the region.
-  void updateSSAForValue(SILBasicBlock *OrigBB, SILValue V,
-                         SILSSAUpdater &SSAUp) {
-    // Collect outside uses.
-    SmallVector<UseWrapper, 16> UseList;
-    for (auto Use : V->getUses())
-      if (OutsideBBs.count(Use->getUser()->getParent()) ||
-          !BBMap.count(Use->getUser()->getParent())) {
-        UseList.push_back(UseWrapper(Use));
-      }
-    if (UseList.empty())
-      return;
-
-    // Update SSA form.
-    SSAUp.Initialize(V->getType());
-    SSAUp.AddAvailableValue(OrigBB, V);
-    SILValue NewVal = remapValue(V);
-    SSAUp.AddAvailableValue(BBMap[OrigBB], NewVal);
-    for (auto U : UseList) {
-      Operand *Use = U;
-      SSAUp.RewriteUse(*Use);
-    }
-  }
-
-  void updateSSAForm() {
-    SILSSAUpdater SSAUp;
-    for (auto Entry : BBMap) {
-      // Ignore exit blocks.
-      if (Entry.first == Entry.second)
-        continue;
-      auto *OrigBB = Entry.first;
-
-      // Update outside used phi values.
-      for (auto *Arg : OrigBB->getBBArgs())
-        updateSSAForValue(OrigBB, Arg, SSAUp);
-
-      // Update outside used instruction values.
-      for (auto &Inst : *OrigBB) {
-        updateSSAForValue(OrigBB, &Inst, SSAUp);
-      }
-    }
-  }
-};
-} // End anonymous namespace.
-
 namespace {
 /// This class transforms a hoistable loop nest into a speculatively specialized
 /// loop based on array.props calls.
@@ -952,6 +952,117 @@ SILCombiner::propagateConcreteTypeOfInitExistential(FullApplySite AI) {
   return propagateConcreteTypeOfInitExistential(AI, PD, PropagateIntoOperand);
 }
 
+/// Propagate the concrete type of an existential, which is opened and passed
+/// as generic argument, into the substitutions of the apply.
+///
+/// For example (the callee may be created by the function signature
+/// optimization):
+///   %e = init_existential_addr %s : $*P, $C
+///   %o = open_existential_addr %s : $*P to $*@opened("...") P
+///   apply %f<@opened("...") P>(%o)
+/// ->
+///   apply %f<C>(%e)
+/// This enables the generic specializer to specialize the callee.
+SILInstruction *
+SILCombiner::propagateConcreteTypeOfInitExistentialArgument(FullApplySite AI) {
+  if (!AI.hasSubstitutions())
+    return nullptr;
+
+  auto FnTy = AI.getCallee()->getType().getAs<SILFunctionType>();
+  if (!FnTy || !FnTy->isPolymorphic())
+    return nullptr;
+
+  ArrayRef<Substitution> Subs = AI.getSubstitutions();
+  for (unsigned ArgIdx = 0, e = AI.getNumArguments(); ArgIdx != e; ++ArgIdx) {
+    SILValue Arg = AI.getArgument(ArgIdx);
+    if (!isa<OpenExistentialAddrInst>(Arg))
+      continue;
+
+    CanType OpenedArchetype;
+    SILValue OpenedArchetypeDef;
+    auto *InitExistential = dyn_cast_or_null<InitExistentialAddrInst>(
+        findInitExistential(AI, Arg, OpenedArchetype, OpenedArchetypeDef));
+    if (!InitExistential)
+      continue;
+
+    // The opened archetype must be the replacement of exactly one generic
+    // parameter, which is passed directly as this argument.
+    auto IsOpenedArchetype = [&](Type T) -> bool {
+      return T->isEqual(OpenedArchetype);
+    };
+    int SubstIdx = -1;
+    bool IsUsedElsewhere = false;
+    for (unsigned i = 0, NumSubs = Subs.size(); i != NumSubs; ++i) {
+      Type Replacement = Subs[i].getReplacement();
+      if (Replacement->isEqual(OpenedArchetype) && SubstIdx < 0)
+        SubstIdx = i;
+      else if (Replacement.findIf(IsOpenedArchetype))
+        IsUsedElsewhere = true;
+    }
+    for (unsigned i = 0; i != e; ++i) {
+      if (i != ArgIdx &&
+          AI.getArgument(i)->getType().getSwiftRValueType().findIf(
+              IsOpenedArchetype))
+        IsUsedElsewhere = true;
+    }
+    if (AI.getType().getSwiftRValueType().findIf(IsOpenedArchetype))
+      IsUsedElsewhere = true;
+    if (SubstIdx < 0 || IsUsedElsewhere ||
+        Subs[SubstIdx].getConformances().size() != 1)
+      continue;
+
+    ProtocolDecl *Protocol =
+        Subs[SubstIdx].getConformances()[0].getRequirement();
+    ArrayRef<ProtocolConformanceRef> Conformances;
+    SILValue NewArg;
+    auto ConformanceAndConcreteType = getConformanceAndConcreteType(
+        AI, InitExistential, Protocol, NewArg, Conformances);
+    if (!ConformanceAndConcreteType)
+      continue;
+
+    ProtocolConformanceRef Conformance =
+        std::get<0>(*ConformanceAndConcreteType);
+    CanType ConcreteType = std::get<1>(*ConformanceAndConcreteType);
+    if (ConcreteType->isOpenedExistential())
+      continue;
+
+    // Replace the opened archetype by the concrete type.
+    SmallVector<Substitution, 8> Substitutions(Subs.begin(), Subs.end());
+    auto NewConformances = AI.getModule().getASTContext()
+                             .AllocateUninitialized<ProtocolConformanceRef>(1);
+    NewConformances[0] = Conformance;
+    Substitutions[SubstIdx] = Substitution(ConcreteType, NewConformances);
+
+    SmallVector<SILValue, 8> Args;
+    for (unsigned i = 0; i != e; ++i)
+      Args.push_back(i == ArgIdx ? NewArg : AI.getArgument(i));
+
+    SILType NewSubstCalleeType = SILType::getPrimitiveObjectType(
+        FnTy->substGenericArgs(AI.getModule(), AI.getModule().getSwiftModule(),
+                               Substitutions));
+
+    FullApplySite NewAI;
+    Builder.setCurrentDebugScope(AI.getDebugScope());
+    Builder.addOpenedArchetypeOperands(AI.getInstruction());
+
+    if (auto *TAI = dyn_cast<TryApplyInst>(AI))
+      NewAI = Builder.createTryApply(AI.getLoc(), AI.getCallee(),
+                                     NewSubstCalleeType, Substitutions, Args,
+                                     TAI->getNormalBB(), TAI->getErrorBB());
+    else
+      NewAI = Builder.createApply(AI.getLoc(), AI.getCallee(),
+                                  NewSubstCalleeType, AI.getType(),
+                                  Substitutions, Args,
+                                  cast<ApplyInst>(AI)->isNonThrowing());
+
+    if (isa<ApplyInst>(NewAI))
+      replaceInstUsesWith(*AI.getInstruction(), NewAI.getInstruction());
+    eraseInstFromFunction(*AI.getInstruction());
+    return NewAI.getInstruction();
+  }
+  return nullptr;
+}
+
 /// \brief Check that all users of the apply are retain/release ignoring one
 /// user.
 static bool
@@ -1170,6 +1281,12 @@ SILInstruction *SILCombiner::visitApplyInst(ApplyInst *AI) {
     if (propagateConcreteTypeOfInitExistential(AI)) {
       return nullptr;
     }
+    // (apply (function_ref generic_function) (open_existential_addr)) ->
+    // propagate the concrete type of the opened existential into the
+    // substitutions.
+    if (propagateConcreteTypeOfInitExistentialArgument(AI)) {
+      return nullptr;
+    }
   }
 
   // Optimize f_inverse(f(x)) -> x.
@@ -1301,6 +1418,12 @@ SILInstruction *SILCombiner::visitTryApplyInst(TryApplyInst *AI) {
     if (propagateConcreteTypeOfInitExistential(AI)) {
       return nullptr;
     }
+    // (apply (function_ref generic_function) (open_existential_addr)) ->
+    // propagate the concrete type of the opened existential into the
+    // substitutions.
+    if (propagateConcreteTypeOfInitExistentialArgument(AI)) {
+      return nullptr;
+    }
   }
 
   return nullptr;
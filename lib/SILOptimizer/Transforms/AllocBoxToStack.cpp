@@ -764,10 +764,14 @@ specializePartialApply(PartialApplyInst *PartialApply,
   CanSILFunctionType SubstCalleeTy = CanFnTy->substGenericArgs(M,
                                                              M.getSwiftModule(),
                                                              Subs);
-  return Builder.createPartialApply(PartialApply->getLoc(), FunctionRef,
-                                 SILType::getPrimitiveObjectType(SubstCalleeTy),
-                                    PartialApply->getSubstitutions(), Args,
-                                    PartialApply->getType());
+  auto *NewPAI =
+    Builder.createPartialApply(PartialApply->getLoc(), FunctionRef,
+                               SILType::getPrimitiveObjectType(SubstCalleeTy),
+                               PartialApply->getSubstitutions(), Args,
+                               PartialApply->getType());
+  if (PartialApply->canAllocOnStack())
+    NewPAI->setStackAllocatable();
+  return NewPAI;
 }
 
 static void
@@ -22,6 +22,10 @@
 /// but then we would send slightly different functions to the pass pipeline
 /// multiple times through notifyPassManagerOfFunction. 
 ///
+/// Existential parameters are converted to generic parameters, so that the
+/// generic specializer can later specialize the function for the concrete
+/// types of the callers.
+///
 /// TODO: Optimize function with generic parameters.
 ///
 /// TODO: Improve epilogue release matcher, i.e. do a data flow instead of
@@ -30,6 +34,8 @@
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "sil-function-signature-opt"
+#include "swift/AST/ArchetypeBuilder.h"
+#include "swift/AST/GenericEnvironment.h"
 #include "swift/SILOptimizer/Analysis/ARCAnalysis.h"
 #include "swift/SILOptimizer/Analysis/CallerAnalysis.h"
 #include "swift/SILOptimizer/Analysis/EpilogueARCAnalysis.h"
@@ -54,6 +60,8 @@ STATISTIC(NumDeadArgsEliminated, "Total dead args eliminated");
 STATISTIC(NumOwnedConvertedToGuaranteed, "Total owned args -> guaranteed args");
 STATISTIC(NumOwnedConvertedToNotOwnedResult, "Total owned result -> not owned result");
 STATISTIC(NumSROAArguments, "Total SROA arguments optimized");
+STATISTIC(NumExistentialToGeneric,
+          "Total existential args -> generic args");
 
 using SILParameterInfoList = llvm::SmallVector<SILParameterInfo, 8>;
 using ArgumentIndexMap = llvm::SmallDenseMap<int, int>;
@@ -129,6 +137,15 @@ class FunctionSignatureTransform {
   /// will use during our optimization.
   llvm::SmallVector<ResultDescriptor, 4> &ResultDescList;
 
+  /// The generic signature and environment of the optimized function if
+  /// existential parameters are converted to generic parameters.
+  GenericSignature *NewGenericSig;
+  GenericEnvironment *NewGenericEnv;
+
+  /// Maps the index of an existential argument to the generic parameter type
+  /// which replaces it.
+  llvm::SmallDenseMap<unsigned, CanType, 4> ExistentialArgToGenericParam;
+
   /// Return a function name based on ArgumentDescList and ResultDescList.
   std::string createOptimizedSILFunctionName();
 
@@ -184,6 +201,20 @@ private:
   /// Add the release for converted arguments and result.
   void OwnedToGuaranteedFinalizeThunkFunction(SILBuilder &B, SILFunction *F);
 
+  /// ----------------------------------------------------------///
+  /// Existential to generic transformation.                    ///
+  /// ----------------------------------------------------------///
+  /// Find existential parameters which can be converted to generic
+  /// parameters and create the generic signature of the optimized function.
+  bool ExistentialToGenericAnalyzeParameters(ArrayRef<SILFunction *> Callers);
+  /// Replace the uses of the existential arguments in the optimized function
+  /// with existentials which are initialized from the generic arguments.
+  void ExistentialToGenericFinalizeOptimizedFunction();
+  /// Deinitialize the opened existentials which are passed as @in to the
+  /// optimized function.
+  void ExistentialToGenericFinalizeThunkFunction(SILBuilder &Builder,
+                                                 SILFunction *F);
+
   /// ----------------------------------------------------------///
   /// Argument explosion transformation.                        ///
   /// ----------------------------------------------------------///
@@ -204,6 +235,17 @@ private:
       return;
     }
 
+    // Pass the opened existential as generic argument.
+    if (AD.ExistentialToGeneric) {
+      SILValue Existential = BB->getBBArg(AD.Index);
+      auto OpenedTy = ArchetypeType::getOpened(
+          Existential->getType().getSwiftRValueType());
+      NewArgs.push_back(Builder.createOpenExistentialAddr(
+          BB->getParent()->getLocation(), Existential,
+          SILType::getPrimitiveAddressType(OpenedTy)));
+      return;
+    }
+
     // Explode the argument.
     if (AD.Explode) {
       llvm::SmallVector<SILValue, 4> LeafValues;
@@ -235,14 +277,15 @@ public:
                              llvm::SmallVector<ResultDescriptor, 4> &RDL)
     : F(F), NewF(nullptr), RCIA(RCIA), EA(EA), FM(FM),
       AIM(AIM), shouldModifySelfArgument(false), ArgumentDescList(ADL),
-      ResultDescList(RDL) {}
+      ResultDescList(RDL), NewGenericSig(nullptr), NewGenericEnv(nullptr) {}
 
   /// Return the optimized function.
   SILFunction *getOptimizedFunction() { return NewF; }
 
   /// Run the optimization.
-  bool run(bool hasCaller) {
+  bool run(ArrayRef<SILFunction *> Callers) {
     bool Changed = false;
+    bool hasCaller = !Callers.empty();
 
     if (!hasCaller && canBeCalledIndirectly(F->getRepresentation())) {
       DEBUG(llvm::dbgs() << "  function has no caller -> abort\n");
@@ -281,6 +324,15 @@ public:
       Changed = true;
     }
 
+    // Run the existential to generic transformation only if nothing else
+    // changed. The optimized function is generic and won't be handled by the
+    // other transformations anymore, so they get their chance first.
+    if (!Changed && hasCaller &&
+        ExistentialToGenericAnalyzeParameters(Callers)) {
+      Changed = true;
+      DEBUG(llvm::dbgs() << "  transform existential-to-generic\n");
+    }
+
     // Create the specialized function and invalidate the old function.
     if (Changed) {
       createFunctionSignatureOptimizedFunction();
@@ -347,6 +399,10 @@ std::string FunctionSignatureTransform::createOptimizedSILFunctionName() {
     if (Arg.Explode) {
       FM.setArgumentSROA(i);
     }   
+
+    if (Arg.ExistentialToGeneric) {
+      FM.setArgumentExistentialToGeneric(i);
+    }
   }
 
   // Handle return value's change.
@@ -364,6 +420,14 @@ std::string FunctionSignatureTransform::createOptimizedSILFunctionName() {
 void
 FunctionSignatureTransform::
 computeOptimizedArgInterface(ArgumentDescriptor &AD, SILParameterInfoList &Out) {
+  // Pass the existential as generic parameter with the same convention.
+  if (AD.ExistentialToGeneric) {
+    ++NumExistentialToGeneric;
+    Out.push_back(SILParameterInfo(ExistentialArgToGenericParam[AD.Index],
+                                   AD.PInfo.getConvention()));
+    return;
+  }
+
   // If this argument is live, but we cannot optimize it.
   if (!AD.canOptimizeLiveArg()) {
     Out.push_back(AD.PInfo);
@@ -452,7 +516,11 @@ CanSILFunctionType FunctionSignatureTransform::createOptimizedSILFunctionType()
     ExtInfo = ExtInfo.withRepresentation(SILFunctionTypeRepresentation::Thin);
   }
 
-  return SILFunctionType::get(FTy->getGenericSignature(), ExtInfo,
+  GenericSignature *GenericSig = FTy->getGenericSignature();
+  if (NewGenericSig)
+    GenericSig = NewGenericSig;
+
+  return SILFunctionType::get(GenericSig, ExtInfo,
                               FTy->getCalleeConvention(), InterfaceParams,
                               InterfaceResults, FTy->getOptionalErrorResult(),
                               F->getModule().getASTContext());
@@ -470,7 +538,8 @@ void FunctionSignatureTransform::createFunctionSignatureOptimizedFunction() {
   
   NewF = M.createFunction(
       linkage, Name,
-      createOptimizedSILFunctionType(), nullptr, F->getLocation(), F->isBare(),
+      createOptimizedSILFunctionType(), NewGenericEnv, F->getLocation(),
+      F->isBare(),
       F->isTransparent(), F->isFragile(), F->isThunk(), F->getClassVisibility(),
       F->getInlineStrategy(), F->getEffectsKind(), 0, F->getDebugScope(),
       F->getDeclContext());
@@ -492,6 +561,7 @@ void FunctionSignatureTransform::createFunctionSignatureOptimizedFunction() {
   // Do the last bit of work to the newly created optimized function.
   ArgumentExplosionFinalizeOptimizedFunction();
   DeadArgumentFinalizeOptimizedFunction();
+  ExistentialToGenericFinalizeOptimizedFunction();
 
   // Create the thunk body !
   F->setThunk(IsThunk);
@@ -508,21 +578,39 @@ void FunctionSignatureTransform::createFunctionSignatureOptimizedFunction() {
   SILLocation Loc = ThunkBody->getParent()->getLocation();
   SILBuilder Builder(ThunkBody);
   Builder.setCurrentDebugScope(ThunkBody->getParent()->getDebugScope());
+  SILOpenedArchetypesTracker OpenedArchetypesTracker(*F);
+  Builder.setOpenedArchetypesTracker(&OpenedArchetypesTracker);
 
   FunctionRefInst *FRI = Builder.createFunctionRef(Loc, NewF);
 
   // Create the args for the thunk's apply, ignoring any dead arguments.
+  // The opened existentials are the substitutions for the generic parameters
+  // which replace existential parameters.
   llvm::SmallVector<SILValue, 8> ThunkArgs;
+  llvm::SmallVector<Substitution, 4> Subs;
   for (auto &ArgDesc : ArgumentDescList) {
     addThunkArgument(ArgDesc, Builder, ThunkBody, ThunkArgs);
+    if (ArgDesc.ExistentialToGeneric) {
+      CanType OpenedTy = ThunkArgs.back()->getType().getSwiftRValueType();
+      SmallVector<ProtocolDecl *, 1> Protocols;
+      ArgDesc.Arg->getType().getSwiftRValueType()->isExistentialType(Protocols);
+      ProtocolConformanceRef Conformance(Protocols[0]);
+      Subs.push_back(Substitution(OpenedTy,
+                                  M.getASTContext().AllocateCopy(
+                                      llvm::makeArrayRef(Conformance))));
+    }
   }
 
-  // We are ignoring generic functions and functions with out parameters for
-  // now.
+  // We are ignoring functions with out parameters for now.
   SILValue ReturnValue;
   SILType LoweredType = NewF->getLoweredType();
-  SILType ResultType = LoweredType.getFunctionInterfaceResultType();
   auto FunctionTy = LoweredType.castTo<SILFunctionType>();
+  if (!Subs.empty()) {
+    LoweredType = SILType::getPrimitiveObjectType(
+        FunctionTy->substGenericArgs(M, M.getSwiftModule(), Subs));
+    FunctionTy = LoweredType.castTo<SILFunctionType>();
+  }
+  SILType ResultType = LoweredType.getFunctionInterfaceResultType();
   if (FunctionTy->hasErrorResult()) {
     // We need a try_apply to call a function with an error result.
     SILFunction *Thunk = ThunkBody->getParent();
@@ -532,16 +620,15 @@ void FunctionSignatureTransform::createFunctionSignatureOptimizedFunction() {
     SILType Error =
         SILType::getPrimitiveObjectType(FunctionTy->getErrorResult().getType());
     auto *ErrorArg = ErrorBlock->createBBArg(Error, 0);
-    Builder.createTryApply(Loc, FRI, LoweredType, ArrayRef<Substitution>(),
-                           ThunkArgs, NormalBlock, ErrorBlock);
+    Builder.createTryApply(Loc, FRI, LoweredType, Subs, ThunkArgs,
+                           NormalBlock, ErrorBlock);
 
     Builder.setInsertionPoint(ErrorBlock);
     Builder.createThrow(Loc, ErrorArg);
     Builder.setInsertionPoint(NormalBlock);
   } else {
     ReturnValue = Builder.createApply(Loc, FRI, LoweredType, ResultType,
-                                      ArrayRef<Substitution>(), ThunkArgs,
-                                      false);
+                                      Subs, ThunkArgs, false);
   }
 
   // Set up the return results.
@@ -553,6 +640,7 @@ void FunctionSignatureTransform::createFunctionSignatureOptimizedFunction() {
 
   // Do the last bit work to finalize the thunk.
   OwnedToGuaranteedFinalizeThunkFunction(Builder, F);
+  ExistentialToGenericFinalizeThunkFunction(Builder, F);
   assert(F->getDebugScope()->Parent != NewF->getDebugScope()->Parent);
 }
 
@@ -858,6 +946,213 @@ void FunctionSignatureTransform::ArgumentExplosionFinalizeOptimizedFunction() {
   }
 }
 
+/// ----------------------------------------------------------///
+/// Existential to generic transformation.                    ///
+/// ----------------------------------------------------------///
+/// Returns true if \p Arg is an address-only existential of a single
+/// non-class protocol which is opened in the function body.
+static bool isConvertibleExistentialArg(SILArgument *Arg,
+                                        SILParameterInfo PInfo,
+                                        ProtocolDecl *&Protocol) {
+  auto Convention = PInfo.getConvention();
+  if (Convention != ParameterConvention::Indirect_In &&
+      Convention != ParameterConvention::Indirect_In_Guaranteed)
+    return false;
+
+  SILType ArgTy = Arg->getType();
+  SmallVector<ProtocolDecl *, 1> Protocols;
+  if (!ArgTy.getSwiftRValueType()->isExistentialType(Protocols) ||
+      Protocols.size() != 1)
+    return false;
+
+  if (Protocols[0]->requiresClass() ||
+      ArgTy.getPreferredExistentialRepresentation(Arg->getModule()) !=
+          ExistentialRepresentation::Opaque)
+    return false;
+
+  // Only convert the argument if the opened value is really used. Otherwise
+  // the generic specializer wouldn't gain anything from the concrete type.
+  for (Operand *Use : Arg->getUses()) {
+    if (isa<OpenExistentialAddrInst>(Use->getUser())) {
+      Protocol = Protocols[0];
+      return true;
+    }
+  }
+  return false;
+}
+
+/// Collects the full apply sites of \p F in \p Callers.
+static void collectCallSites(SILFunction *F, ArrayRef<SILFunction *> Callers,
+                             SmallVectorImpl<FullApplySite> &CallSites) {
+  for (SILFunction *Caller : Callers) {
+    for (auto &BB : *Caller) {
+      for (auto &I : BB) {
+        FullApplySite AI = FullApplySite::isa(&I);
+        if (AI && AI.getReferencedFunction() == F)
+          CallSites.push_back(AI);
+      }
+    }
+  }
+}
+
+/// Returns true if one of the \p CallSites passes an existential which is
+/// initialized with a statically known concrete type as argument \p ArgIdx.
+/// Only then can the generic specializer make use of the new generic
+/// parameter. Callers which just forward an opaque existential would only pay
+/// for the thunk re-wrapping it.
+static bool isPassedConcreteExistential(ArrayRef<FullApplySite> CallSites,
+                                        unsigned ArgIdx) {
+  for (FullApplySite AI : CallSites) {
+    auto *ASI = dyn_cast<AllocStackInst>(AI.getArgument(ArgIdx));
+    if (!ASI)
+      continue;
+    for (Operand *Use : ASI->getUses()) {
+      auto *IE = dyn_cast<InitExistentialAddrInst>(Use->getUser());
+      if (IE && !IE->getFormalConcreteType()->hasOpenedExistential())
+        return true;
+    }
+  }
+  return false;
+}
+
+bool FunctionSignatureTransform::
+ExistentialToGenericAnalyzeParameters(ArrayRef<SILFunction *> Callers) {
+  ArrayRef<SILArgument *> Args = F->begin()->getBBArgs();
+  ASTContext &Ctx = F->getModule().getASTContext();
+  SmallVector<GenericTypeParamType *, 4> GenericParams;
+  SmallVector<Requirement, 4> Requirements;
+
+  // The call sites are only collected once the first convertible argument is
+  // found, and then shared by all arguments.
+  SmallVector<FullApplySite, 8> CallSites;
+  bool CollectedCallSites = false;
+
+  for (unsigned i = 0, e = Args.size(); i != e; ++i) {
+    ArgumentDescriptor &A = ArgumentDescList[i];
+    if (A.IsIndirectResult || Args[i]->isSelf())
+      continue;
+
+    ProtocolDecl *Protocol = nullptr;
+    if (!isConvertibleExistentialArg(Args[i], A.PInfo, Protocol))
+      continue;
+
+    if (!CollectedCallSites) {
+      collectCallSites(F, Callers, CallSites);
+      CollectedCallSites = true;
+    }
+    if (!isPassedConcreteExistential(CallSites, i))
+      continue;
+
+    auto *ParamTy =
+        GenericTypeParamType::get(0, GenericParams.size(), Ctx);
+    GenericParams.push_back(ParamTy);
+    Requirements.push_back(Requirement(RequirementKind::Conformance, ParamTy,
+                                       Protocol->getDeclaredType()));
+    ExistentialArgToGenericParam[A.Index] = CanType(ParamTy);
+    A.ExistentialToGeneric = true;
+  }
+
+  if (GenericParams.empty())
+    return false;
+
+  NewGenericSig = GenericSignature::get(GenericParams, Requirements);
+  ArchetypeBuilder Builder(*F->getModule().getSwiftModule(), Ctx.Diags);
+  Builder.addGenericSignature(NewGenericSig, nullptr);
+  Builder.finalize(SourceLoc());
+  NewGenericEnv = Builder.getGenericEnvironment();
+  return true;
+}
+
+void FunctionSignatureTransform::
+ExistentialToGenericFinalizeOptimizedFunction() {
+  if (!NewGenericEnv)
+    return;
+
+  SILBasicBlock *BB = &*NewF->begin();
+  SILLocation Loc = NewF->getLocation();
+  ASTContext &Ctx = NewF->getModule().getASTContext();
+  SILBuilder Builder(BB->begin());
+  Builder.setCurrentDebugScope(NewF->getDebugScope());
+
+  // Collect the exits before we create new instructions.
+  llvm::SmallVector<SILBasicBlock *, 4> ExitBlocks;
+  for (auto &EBB : *NewF) {
+    if (EBB.getTerminator()->isFunctionExiting())
+      ExitBlocks.push_back(&EBB);
+  }
+
+  for (ArgumentDescriptor &AD : ArgumentDescList) {
+    if (!AD.ExistentialToGeneric)
+      continue;
+
+    // The generic value is passed in a new argument. Wrap it into a local
+    // existential which replaces the original argument.
+    SILArgument *OrigArg = BB->getBBArg(AD.Index);
+    SILType ExistentialTy = OrigArg->getType();
+    SILType ArgTy = NewF->mapTypeIntoContext(SILType::getPrimitiveAddressType(
+        ExistentialArgToGenericParam[AD.Index]));
+    SILValue NewArg = BB->insertBBArg(AD.Index, ArgTy, OrigArg->getDecl());
+
+    SmallVector<ProtocolDecl *, 1> Protocols;
+    ExistentialTy.getSwiftRValueType()->isExistentialType(Protocols);
+    ProtocolConformanceRef Conformance(Protocols[0]);
+
+    auto *ASI = Builder.createAllocStack(Loc, ExistentialTy.getObjectType());
+    auto *Payload = Builder.createInitExistentialAddr(
+        Loc, ASI, ArgTy.getSwiftRValueType(), ArgTy.getObjectType(),
+        Ctx.AllocateCopy(llvm::makeArrayRef(Conformance)));
+    Builder.createCopyAddr(Loc, NewArg, Payload, IsTake, IsInitialization);
+
+    OrigArg->replaceAllUsesWith(ASI);
+    BB->eraseBBArg(AD.Index + 1);
+
+    // An @in_guaranteed argument must still be initialized when the function
+    // returns, so move the value back. An @in existential was destroyed by
+    // the function body.
+    bool IsGuaranteed = AD.PInfo.getConvention() ==
+                        ParameterConvention::Indirect_In_Guaranteed;
+    for (SILBasicBlock *ExitBB : ExitBlocks) {
+      SILBuilder ExitBuilder(ExitBB->getTerminator());
+      ExitBuilder.setCurrentDebugScope(NewF->getDebugScope());
+      if (IsGuaranteed) {
+        ExitBuilder.createCopyAddr(Loc, Payload, NewArg, IsTake,
+                                   IsInitialization);
+        ExitBuilder.createDeinitExistentialAddr(Loc, ASI);
+      }
+      ExitBuilder.createDeallocStack(Loc, ASI);
+    }
+  }
+}
+
+void FunctionSignatureTransform::
+ExistentialToGenericFinalizeThunkFunction(SILBuilder &Builder, SILFunction *F) {
+  // The optimized function consumed the opened value of an @in argument,
+  // deinitialize the remaining existential container.
+  for (auto &ArgDesc : ArgumentDescList) {
+    if (!ArgDesc.ExistentialToGeneric ||
+        ArgDesc.PInfo.getConvention() != ParameterConvention::Indirect_In)
+      continue;
+
+    SILValue Existential = F->getArguments()[ArgDesc.Index];
+    SILInstruction *Call = findOnlyApply(F);
+    if (isa<ApplyInst>(Call)) {
+      Builder.setInsertionPoint(&*std::next(SILBasicBlock::iterator(Call)));
+      Builder.createDeinitExistentialAddr(RegularLocation(SourceLoc()),
+                                          Existential);
+    } else {
+      SILBasicBlock *NormalBB = dyn_cast<TryApplyInst>(Call)->getNormalBB();
+      Builder.setInsertionPoint(&*NormalBB->begin());
+      Builder.createDeinitExistentialAddr(RegularLocation(SourceLoc()),
+                                          Existential);
+
+      SILBasicBlock *ErrorBB = dyn_cast<TryApplyInst>(Call)->getErrorBB();
+      Builder.setInsertionPoint(&*ErrorBB->begin());
+      Builder.createDeinitExistentialAddr(RegularLocation(SourceLoc()),
+                                          Existential);
+    }
+  }
+}
+
 //===----------------------------------------------------------------------===//
 //                           Top Level Entry Point
 //===----------------------------------------------------------------------===//
@@ -931,7 +1226,7 @@ public:
     if (OptForPartialApply) {
       Changed = FST.removeDeadArgs(FuncInfo.getMinPartialAppliedArgs());
     } else {
-      Changed = FST.run(FuncInfo.hasCaller());
+      Changed = FST.run(FuncInfo.getCallers());
     }
     if (Changed) {
       ++ NumFunctionSignaturesOptimized;
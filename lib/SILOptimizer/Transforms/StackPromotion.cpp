@@ -13,6 +13,7 @@
 #define DEBUG_TYPE "stack-promotion"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Analysis/ArraySemantic.h"
 #include "swift/SILOptimizer/Analysis/EscapeAnalysis.h"
 #include "swift/SILOptimizer/Analysis/DominanceAnalysis.h"
 #include "swift/SIL/SILArgument.h"
@@ -23,6 +24,10 @@
 #include "llvm/ADT/Statistic.h"
 
 STATISTIC(NumStackPromoted, "Number of objects promoted to the stack");
+STATISTIC(NumClosureContextsPromoted,
+          "Number of closure contexts promoted to the stack");
+STATISTIC(NumNonAtomicRC,
+          "Number of reference counting operations made non-atomic");
 
 using namespace swift;
 
@@ -31,6 +36,12 @@ using namespace swift;
 /// It handles alloc_ref instructions of native swift classes: if promoted,
 /// the [stack] attribute is set in the alloc_ref and a dealloc_ref [stack] is
 /// inserted at the end of the object's lifetime.
+/// The same is done for the context of non-escaping closures, which is
+/// allocated by a partial_apply.
+///
+/// A promoted object does not escape the function and is therefore never
+/// shared between threads. Reference counting operations which are known to
+/// operate on such an object are made non-atomic.
 class StackPromoter {
 
   // Some analysis we need.
@@ -105,12 +116,19 @@ class StackPromoter {
   /// Tries to promote the allocation \p AI.
   bool tryPromoteAlloc(AllocRefInst *ARI);
 
-  /// Returns true if the allocation \p AI can be promoted.
+  /// Tries to promote the closure context which is allocated by \p PAI.
+  bool tryPromoteClosureContext(PartialApplyInst *PAI);
+
+  /// Makes the reference counting instructions non-atomic which directly
+  /// operate on the stack promoted object \p Obj.
+  void setNonAtomicRefCounting(SILInstruction *Obj);
+
+  /// Returns true if the allocation \p Alloc can be promoted.
   /// In this case it sets the \a DeallocInsertionPoint to the instruction
   /// where the deallocation must be inserted.
   /// It optionally also sets \a AllocInsertionPoint in case the allocation
   /// instruction must be moved to another place.
-  bool canPromoteAlloc(AllocRefInst *ARI,
+  bool canPromoteAlloc(SILInstruction *Alloc,
                        SILInstruction *&AllocInsertionPoint,
                        SILInstruction *&DeallocInsertionPoint);
 
@@ -215,6 +233,8 @@ bool StackPromoter::promote() {
       SILInstruction *I = &*Iter++;
       if (auto *ARI = dyn_cast<AllocRefInst>(I)) {
         Changed |= tryPromoteAlloc(ARI);
+      } else if (auto *PAI = dyn_cast<PartialApplyInst>(I)) {
+        Changed |= tryPromoteClosureContext(PAI);
       }
     }
   }
@@ -222,7 +242,9 @@ bool StackPromoter::promote() {
 }
 
 bool StackPromoter::tryPromoteAlloc(AllocRefInst *ARI) {
-  
+  if (ARI->isObjC() || ARI->canAllocOnStack())
+    return false;
+
   SILInstruction *AllocInsertionPoint = nullptr;
   SILInstruction *DeallocInsertionPoint = nullptr;
   if (!canPromoteAlloc(ARI, AllocInsertionPoint, DeallocInsertionPoint))
@@ -240,9 +262,107 @@ bool StackPromoter::tryPromoteAlloc(AllocRefInst *ARI) {
 
   /// And create a dealloc_ref [stack] at the end of the object's lifetime.
   B.createDeallocRef(ARI->getLoc(), ARI, true);
+  setNonAtomicRefCounting(ARI);
   return true;
 }
 
+bool StackPromoter::tryPromoteClosureContext(PartialApplyInst *PAI) {
+  // Without any captured values there is no context to allocate.
+  if (PAI->canAllocOnStack() || PAI->getArguments().empty())
+    return false;
+
+  SILInstruction *AllocInsertionPoint = nullptr;
+  SILInstruction *DeallocInsertionPoint = nullptr;
+  if (!canPromoteAlloc(PAI, AllocInsertionPoint, DeallocInsertionPoint))
+    return false;
+
+  // In contrast to an alloc_ref, we can't move a partial_apply above the
+  // definitions of its operands.
+  if (AllocInsertionPoint)
+    return false;
+
+  DEBUG(llvm::dbgs() << "Promoted closure context " << *PAI);
+  DEBUG(llvm::dbgs() << "    in " << PAI->getFunction()->getName() << '\n');
+  NumClosureContextsPromoted++;
+
+  PAI->setStackAllocatable();
+
+  // The context is deallocated at the end of the closure's lifetime.
+  SILBuilder B(DeallocInsertionPoint);
+  B.createDeallocRef(PAI->getLoc(), PAI, true);
+  setNonAtomicRefCounting(PAI);
+  return true;
+}
+
+/// Returns true if \p V is the only non-trivial operand of the aggregate
+/// instruction \p I.
+static bool isOnlyNonTrivialOperand(SILInstruction *I, SILValue V) {
+  SILModule &M = I->getModule();
+  for (const Operand &Op : I->getAllOperands()) {
+    if (Op.get() != V && !Op.get()->getType().isTrivial(M))
+      return false;
+  }
+  return true;
+}
+
+void StackPromoter::setNonAtomicRefCounting(SILInstruction *Obj) {
+  SmallVector<SILValue, 8> WorkList;
+  WorkList.push_back(Obj);
+  while (!WorkList.empty()) {
+    SILValue V = WorkList.pop_back_val();
+    for (Operand *Use : V->getUses()) {
+      SILInstruction *User = Use->getUser();
+      switch (User->getKind()) {
+        case ValueKind::StrongRetainInst:
+        case ValueKind::StrongReleaseInst:
+        case ValueKind::RetainValueInst:
+        case ValueKind::ReleaseValueInst: {
+          auto *RCI = cast<RefCountingInst>(User);
+          if (RCI->isAtomic()) {
+            RCI->setNonAtomic();
+            NumNonAtomicRC++;
+          }
+          break;
+        }
+        case ValueKind::UpcastInst:
+        case ValueKind::UncheckedRefCastInst:
+        case ValueKind::RefToBridgeObjectInst:
+        case ValueKind::BridgeObjectToRefInst:
+        case ValueKind::ConvertFunctionInst:
+          // The object reference is just forwarded.
+          if (Use->getOperandNumber() == 0)
+            WorkList.push_back(User);
+          break;
+        case ValueKind::StructInst:
+        case ValueKind::TupleInst:
+          // The aggregate doesn't reference anything else than the object,
+          // e.g. the _storage field of an array buffer.
+          if (isOnlyNonTrivialOperand(User, V))
+            WorkList.push_back(User);
+          break;
+        case ValueKind::StructExtractInst:
+        case ValueKind::TupleExtractInst:
+          // The only non-trivial element of the aggregate is the object.
+          if (!User->getType().isTrivial(User->getModule()))
+            WorkList.push_back(User);
+          break;
+        case ValueKind::ApplyInst: {
+          // The array which adopts the promoted buffer only references the
+          // buffer.
+          ArraySemanticsCall ArrayInit(User, "array.uninitialized");
+          if (ArrayInit && cast<ApplyInst>(User)->getArgument(0) == V) {
+            if (SILValue ArrayValue = ArrayInit.getArrayValue())
+              WorkList.push_back(ArrayValue);
+          }
+          break;
+        }
+        default:
+          break;
+      }
+    }
+  }
+}
+
 namespace {
 
 /// Iterator which iterates over all basic blocks of a function which are not
@@ -325,15 +445,12 @@ template <> struct GraphTraits<StackPromoter *>
 
 }
 
-bool StackPromoter::canPromoteAlloc(AllocRefInst *ARI,
+bool StackPromoter::canPromoteAlloc(SILInstruction *Alloc,
                                     SILInstruction *&AllocInsertionPoint,
                                     SILInstruction *&DeallocInsertionPoint) {
-  if (ARI->isObjC() || ARI->canAllocOnStack())
-    return false;
-
   AllocInsertionPoint = nullptr;
   DeallocInsertionPoint = nullptr;
-  auto *Node = ConGraph->getNodeOrNull(ARI, EA);
+  auto *Node = ConGraph->getNodeOrNull(Alloc, EA);
   if (!Node)
     return false;
 
@@ -358,7 +475,7 @@ bool StackPromoter::canPromoteAlloc(AllocRefInst *ARI,
   // Try to find the point where to insert the deallocation.
   // This might need more than one try in case we need to move the allocation
   // out of a stack-alloc-dealloc pair. See findDeallocPoint().
-  SILInstruction *StartInst = ARI;
+  SILInstruction *StartInst = Alloc;
   for (;;) {
     SILInstruction *RestartPoint = nullptr;
     DeallocInsertionPoint = findDeallocPoint(StartInst, RestartPoint, Node,
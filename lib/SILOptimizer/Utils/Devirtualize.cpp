@@ -1061,9 +1061,16 @@ static ApplySite devirtualizeWitnessMethod(ApplySite AI, SILFunction *F,
     SAI = Builder.createTryApply(Loc, FRI, SubstCalleeSILType,
                                  NewSubs, Arguments,
                                  TAI->getNormalBB(), TAI->getErrorBB());
-  if (auto *PAI = dyn_cast<PartialApplyInst>(AI))
-    SAI = Builder.createPartialApply(Loc, FRI, SubstCalleeSILType,
-                                     NewSubs, Arguments, PAI->getType());
+  if (auto *PAI = dyn_cast<PartialApplyInst>(AI)) {
+    auto *NewPAI = Builder.createPartialApply(Loc, FRI, SubstCalleeSILType,
+                                              NewSubs, Arguments,
+                                              PAI->getType());
+    // The uses of the closure, including its dealloc_ref [stack], are moved
+    // to the new closure.
+    if (PAI->canAllocOnStack())
+      NewPAI->setStackAllocatable();
+    SAI = NewPAI;
+  }
 
   NumWitnessDevirt++;
   return SAI;
@@ -320,6 +320,8 @@ static ApplySite replaceWithSpecializedCallee(ApplySite AI,
     auto *NewPAI =
       Builder.createPartialApply(Loc, Callee, PTy, {}, Arguments,
                                  SILType::getPrimitiveObjectType(NewPAType));
+    if (PAI->canAllocOnStack())
+      NewPAI->setStackAllocatable();
     PAI->replaceAllUsesWith(NewPAI);
     return NewPAI;
   }
@@ -563,6 +565,8 @@ void swift::trySpecializeApplyOfGeneric(
                                       {},
                                       Arguments,
                                       PAI->getType());
+    if (PAI->canAllocOnStack())
+      NewPAI->setStackAllocatable();
     PAI->replaceAllUsesWith(NewPAI);
     DeadApplies.insert(PAI);
     return;
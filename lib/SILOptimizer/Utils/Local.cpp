@@ -1029,6 +1029,9 @@ static bool useDoesNotKeepClosureAlive(const SILInstruction *I) {
   case ValueKind::ReleaseValueInst:
   case ValueKind::DebugValueInst:
     return true;
+  case ValueKind::DeallocRefInst:
+    // The end of the lifetime of a stack allocated closure context.
+    return cast<DeallocRefInst>(I)->canAllocOnStack();
   default:
     return false;
   }
@@ -0,0 +1,159 @@
+//===--- RegionCloner.cpp - Clone single entry CFG regions ----------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/SILOptimizer/Utils/RegionCloner.h"
+#include "swift/SIL/SILArgument.h"
+#include "swift/SILOptimizer/Utils/CFG.h"
+
+using namespace swift;
+
+SILBasicBlock *RegionCloner::cloneRegion() {
+  assert (DomTree.getNode(StartBB) != nullptr && "Can't cloned dead code");
+
+  auto CurFun = StartBB->getParent();
+  auto &Mod = CurFun->getModule();
+
+  // We don't want to visit blocks outside of the region. visitSILBasicBlocks
+  // checks BBMap before it clones a block. So we mark exiting blocks as
+  // visited by putting them in the BBMap.
+  for (auto *BB : OutsideBBs)
+    BBMap[BB] = BB;
+
+  // We need to split any edge from a non cond_br basic block leading to a
+  // exit block. After cloning this edge will become critical if it came from
+  // inside the cloned region. The SSAUpdater can't handle critical non
+  // cond_br edges.
+  for (auto *BB : OutsideBBs) {
+    SmallVector<SILBasicBlock*, 8> Preds(BB->getPreds());
+    for (auto *Pred : Preds)
+      if (!isa<CondBranchInst>(Pred->getTerminator()) &&
+          !isa<BranchInst>(Pred->getTerminator()))
+        splitEdgesFromTo(Pred, BB, &DomTree, nullptr);
+  }
+
+  // Create the cloned start basic block.
+  auto *ClonedStartBB = new (Mod) SILBasicBlock(CurFun);
+  BBMap[StartBB] = ClonedStartBB;
+
+  // Clone the arguments.
+  for (auto &Arg : StartBB->getBBArgs()) {
+    SILValue MappedArg =
+        new (Mod) SILArgument(ClonedStartBB, getOpType(Arg->getType()));
+    ValueMap.insert(std::make_pair(Arg, MappedArg));
+  }
+
+  // Clone the instructions in this basic block and recursively clone
+  // successor blocks.
+  getBuilder().setInsertionPoint(ClonedStartBB);
+  visitSILBasicBlock(StartBB);
+
+  // Fix-up terminators.
+  for (auto BBPair : BBMap)
+    if (BBPair.first != BBPair.second) {
+      getBuilder().setInsertionPoint(BBPair.second);
+      visit(BBPair.first->getTerminator());
+    }
+
+  // Add dominator tree nodes for the new basic blocks.
+  fixDomTreeNodes(DomTree.getNode(StartBB));
+
+  // Update SSA form for values used outside of the copied region.
+  updateSSAForm();
+  return ClonedStartBB;
+}
+
+void RegionCloner::fixDomTreeNodes(DominanceInfoNode *OrigNode) {
+  auto *BB = OrigNode->getBlock();
+  auto MapIt = BBMap.find(BB);
+  // Outside the cloned region.
+  if (MapIt == BBMap.end())
+    return;
+
+  auto *ClonedBB = MapIt->second;
+  // Exit blocks (BBMap[BB] == BB) end the recursion.
+  if (ClonedBB == BB)
+    return;
+
+  auto *OrigDom = OrigNode->getIDom();
+  assert(OrigDom);
+
+  if (BB == StartBB) {
+    // The cloned start node shares the same dominator as the original node.
+    auto *ClonedNode = DomTree.addNewBlock(ClonedBB, OrigDom->getBlock());
+    (void) ClonedNode;
+    assert(ClonedNode);
+  } else {
+    // Otherwise, map the dominator structure using the mapped block.
+    auto *OrigDomBB = OrigDom->getBlock();
+    assert(BBMap.count(OrigDomBB) && "Must have visited dominating block");
+    auto *MappedDomBB = BBMap[OrigDomBB];
+    assert(MappedDomBB);
+    DomTree.addNewBlock(ClonedBB, MappedDomBB);
+  }
+
+  for (auto *Child : *OrigNode)
+    fixDomTreeNodes(Child);
+}
+
+SILValue RegionCloner::remapValue(SILValue V) {
+  if (auto *BB = V->getParentBB()) {
+    if (!DomTree.dominates(StartBB, BB)) {
+      // Must be a value that dominates the start basic block.
+      assert(DomTree.dominates(BB, StartBB) &&
+             "Must dominated the start of the cloned region");
+      return V;
+    }
+  }
+  return SILCloner<RegionCloner>::remapValue(V);
+}
+
+void RegionCloner::updateSSAForValue(SILBasicBlock *OrigBB, SILValue V,
+                                     SILSSAUpdater &SSAUp) {
+  // Collect outside uses.
+  SmallVector<UseWrapper, 16> UseList;
+  for (auto Use : V->getUses())
+    if (OutsideBBs.count(Use->getUser()->getParent()) ||
+        !BBMap.count(Use->getUser()->getParent())) {
+      UseList.push_back(UseWrapper(Use));
+    }
+  if (UseList.empty())
+    return;
+
+  // Update SSA form.
+  SSAUp.Initialize(V->getType());
+  SSAUp.AddAvailableValue(OrigBB, V);
+  SILValue NewVal = remapValue(V);
+  SSAUp.AddAvailableValue(BBMap[OrigBB], NewVal);
+  for (auto U : UseList) {
+    Operand *Use = U;
+    SSAUp.RewriteUse(*Use);
+  }
+}
+
+void RegionCloner::updateSSAForm() {
+  SILSSAUpdater SSAUp;
+  for (auto Entry : BBMap) {
+    // Ignore exit blocks.
+    if (Entry.first == Entry.second)
+      continue;
+    auto *OrigBB = Entry.first;
+
+    // Update outside used phi values.
+    for (auto *Arg : OrigBB->getBBArgs())
+      updateSSAForValue(OrigBB, Arg, SSAUp);
+
+    // Update outside used instruction values.
+    for (auto &Inst : *OrigBB) {
+      updateSSAForValue(OrigBB, &Inst, SSAUp);
+    }
+  }
+}
@@ -47,6 +47,8 @@
 using namespace swift;
 
 #define DEBUG_TYPE "TypeCheckDecl"
+STATISTIC(NumArchetypeBuilders,
+          "# of archetype builders created for generic declarations");
 
 namespace {
 
@@ -706,6 +708,7 @@ static void setBoundVarsTypeError(Pattern *pattern, ASTContext &ctx) {
 
 /// Create a fresh archetype builder.
 ArchetypeBuilder TypeChecker::createArchetypeBuilder(Module *mod) {
+  ++NumArchetypeBuilders;
   return ArchetypeBuilder(*mod, Diags);
 }
 
@@ -737,7 +740,8 @@ TypeChecker::handleSILGenericParams(GenericParamList *genericParams,
 
     revertGenericParamList(genericParams);
 
-    ArchetypeBuilder builder(*DC->getParentModule(), Diags);
+    ArchetypeBuilderTimer timer(*this);
+    ArchetypeBuilder builder = createArchetypeBuilder(DC->getParentModule());
     checkGenericParamList(&builder, genericParams, parentSig, parentEnv,
                           nullptr);
     parentSig = genericSig;
@@ -4846,6 +4850,7 @@ public:
       TC.validateGenericFuncSignature(FD);
 
       // Create a fresh archetype builder.
+      ArchetypeBuilderTimer timer(TC);
       ArchetypeBuilder builder =
         TC.createArchetypeBuilder(FD->getModuleContext());
       auto *parentSig = FD->getDeclContext()->getGenericSignatureOfContext();
@@ -6517,6 +6522,7 @@ public:
 
       TC.validateGenericFuncSignature(CD);
 
+      ArchetypeBuilderTimer timer(TC);
       auto builder = TC.createArchetypeBuilder(CD->getModuleContext());
       auto *parentSig = CD->getDeclContext()->getGenericSignatureOfContext();
       auto *parentEnv = CD->getDeclContext()->getGenericEnvironmentOfContext();
@@ -7543,6 +7549,7 @@ checkExtensionGenericParams(TypeChecker &tc, ExtensionDecl *ext,
 
   // Validate the generic parameters for the last time.
   tc.revertGenericParamList(genericParams);
+  ArchetypeBuilderTimer timer(tc);
   ArchetypeBuilder builder = tc.createArchetypeBuilder(ext->getModuleContext());
   tc.checkGenericParamList(&builder, genericParams, parentSig, parentEnv, nullptr);
   inferExtendedTypeReqs(builder);
@@ -461,6 +461,7 @@ void TypeChecker::validateGenericFuncSignature(AbstractFunctionDecl *func) {
   bool invalid = false;
 
   // Create the archetype builder.
+  ArchetypeBuilderTimer timer(*this);
   ArchetypeBuilder builder = createArchetypeBuilder(func->getParentModule());
 
   // Type check the function declaration, treating all generic type
@@ -660,6 +661,7 @@ GenericSignature *TypeChecker::validateGenericSignature(
 
   // Create the archetype builder.
   Module *module = dc->getParentModule();
+  ArchetypeBuilderTimer timer(*this);
   ArchetypeBuilder builder = createArchetypeBuilder(module);
 
   // Type check the generic parameters, treating all generic type
@@ -846,6 +848,7 @@ void TypeChecker::validateGenericTypeSignature(GenericTypeDecl *typeDecl) {
 
   revertGenericParamList(gp);
 
+  ArchetypeBuilderTimer timer(*this);
   ArchetypeBuilder builder =
     createArchetypeBuilder(typeDecl->getModuleContext());
   auto *parentSig = dc->getGenericSignatureOfContext();
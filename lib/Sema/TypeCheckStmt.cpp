@@ -1257,9 +1257,18 @@ bool TypeChecker::typeCheckAbstractFunctionBody(AbstractFunctionDecl *AFD) {
   if (DebugTimeFunctionBodies || WarnLongFunctionBodies)
     timer.emplace(AFD, DebugTimeFunctionBodies, WarnLongFunctionBodies);
 
-  if (typeCheckAbstractFunctionBodyUntil(AFD, SourceLoc()))
+  bool HadError = typeCheckAbstractFunctionBodyUntil(AFD, SourceLoc());
+
+  // Each constraint system, and the arena holding its type variables and the
+  // types built from them, is scoped to a single expression. None of them may
+  // outlive the body, or its memory would stay resident until the end of the
+  // module.
+  assert(!Context.hasActiveConstraintSolver() &&
+         "constraint solver arena outlived the function body");
+
+  if (HadError)
     return true;
-  
+
   performAbstractFuncDeclDiagnostics(*this, AFD);
   return false;
 }
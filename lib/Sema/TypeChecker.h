@@ -28,9 +28,11 @@
 #include "swift/Parse/Lexer.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/OptionSet.h"
+#include "swift/Basic/Timer.h"
 #include "swift/Config.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/TinyPtrVector.h"
+#include "llvm/Support/SaveAndRestore.h"
 #include <functional>
 
 namespace swift {
@@ -512,6 +514,9 @@ public:
   // flag is set to 'true' once the bridge functions have been checked.
   bool HasCheckedBridgeFunctions = false;
 
+  /// Whether an \c ArchetypeBuilderTimer is already running.
+  bool TimingArchetypeBuilder = false;
+
   /// A list of closures for the most recently type-checked function, which we
   /// will need to compute captures for.
   std::vector<AnyFunctionRef> ClosuresWithUncomputedCaptures;
@@ -1824,6 +1829,11 @@ public:
 
   void fillObjCRepresentableTypeCache(const DeclContext *DC);
 
+  /// Create a fresh archetype builder for a generic declaration.
+  ///
+  /// Unlike the builders of canonical signatures, these are not cached by
+  /// the ASTContext; each one is counted and should be timed with an
+  /// \c ArchetypeBuilderTimer.
   ArchetypeBuilder createArchetypeBuilder(Module *mod);
 
   /// \name Availability checking
@@ -2041,6 +2051,26 @@ public:
   }
 };
 
+/// RAII object that times the archetype builders Sema creates for generic
+/// declarations.
+///
+/// Building one generic signature can validate other declarations and build
+/// their signatures too. Only the outermost builder is timed, because a timer
+/// can't be started again while it is running.
+class ArchetypeBuilderTimer {
+  bool Outermost;
+  llvm::SaveAndRestore<bool> Timing;
+  Optional<SharedTimer> Timer;
+
+public:
+  explicit ArchetypeBuilderTimer(TypeChecker &tc)
+    : Outermost(!tc.TimingArchetypeBuilder),
+      Timing(tc.TimingArchetypeBuilder, true) {
+    if (Outermost)
+      Timer.emplace("Build archetypes for generic declarations");
+  }
+};
+
 /// Temporary on-stack storage and unescaping for encoded diagnostic
 /// messages.
 ///
@@ -20,8 +20,11 @@
 #include "swift/ClangImporter/ClangImporter.h"
 #include "swift/Parse/Parser.h"
 #include "swift/Serialization/BCReadingExtras.h"
+#include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 
+#define DEBUG_TYPE "serialization"
+
 using namespace swift;
 using namespace swift::serialization;
 
@@ -4157,6 +4160,25 @@ void ModuleFile::loadAllMembers(Decl *D, uint64_t contextData) {
   }
 }
 
+bool ModuleFile::loadNamedMembers(const IterableDeclContext *IDC,
+                                  Identifier name, uint64_t contextData,
+                                  SmallVectorImpl<ValueDecl *> &members) {
+  if (!DeclMemberNames)
+    return false;
+
+  auto iter = DeclMemberNames->find({contextData, name.str()});
+  if (iter == DeclMemberNames->end())
+    return true;
+
+  for (DeclID memberID : *iter) {
+    auto member = dyn_cast_or_null<ValueDecl>(getDecl(memberID));
+    assert(member && "unable to deserialize named member");
+    if (member)
+      members.push_back(member);
+  }
+  return true;
+}
+
 void
 ModuleFile::loadAllConformances(const Decl *D, uint64_t contextData,
                           SmallVectorImpl<ProtocolConformance*> &conformances) {
@@ -4172,11 +4194,50 @@ ModuleFile::loadAllConformances(const Decl *D, uint64_t contextData,
 
   while (numConformances--) {
     auto conf = readConformance(DeclTypeCursor);
-    if (conf.isConcrete())
+    if (conf.isConcrete()) {
+      DEBUG(llvm::dbgs() << "Loaded conformance of "
+                         << conf.getConcrete()->getType() << " to "
+                         << conf.getRequirement()->getName() << "\n");
       conformances.push_back(conf.getConcrete());
+    }
   }
 }
 
+bool
+ModuleFile::loadConformancesTo(const Decl *D, uint64_t contextData,
+                               ProtocolDecl *protocol,
+                          SmallVectorImpl<ProtocolConformance*> &conformances) {
+  if (!ConformancesByProtocol)
+    return false;
+
+  PrettyStackTraceDecl trace("loading conformances for", D);
+
+  uint64_t numConformances;
+  uint64_t bitPosition;
+  std::tie(numConformances, bitPosition)
+    = decodeLazyConformanceContextData(contextData);
+
+  auto iter = ConformancesByProtocol->find({bitPosition,
+                                            protocol->getName().str()});
+  if (iter == ConformancesByProtocol->end())
+    return true;
+
+  BCOffsetRAII restoreOffset(DeclTypeCursor);
+  for (uint32_t relativeOffset : *iter) {
+    DeclTypeCursor.JumpToBit(bitPosition + relativeOffset);
+    auto conf = readConformance(DeclTypeCursor);
+
+    // Protocols in different modules can have the same name.
+    if (conf.isConcrete() && conf.getConcrete()->getProtocol() == protocol) {
+      DEBUG(llvm::dbgs() << "Loaded conformance of "
+                         << conf.getConcrete()->getType() << " to "
+                         << protocol->getName() << "\n");
+      conformances.push_back(conf.getConcrete());
+    }
+  }
+  return true;
+}
+
 TypeLoc
 ModuleFile::loadAssociatedTypeDefault(const swift::AssociatedTypeDecl *ATD,
                                       uint64_t contextData) {
@@ -671,7 +671,8 @@ bool SILDeserializer::readSILInstruction(SILFunction *Fn, SILBasicBlock *BB,
   Builder.setInsertionPoint(BB);
   Builder.setCurrentDebugScope(Fn->getDebugScope());
   unsigned OpCode = 0, TyCategory = 0, TyCategory2 = 0, TyCategory3 = 0,
-           Attr = 0, NumSubs = 0, NumConformances = 0, IsNonThrowingApply = 0;
+           Attr = 0, NumSubs = 0, NumConformances = 0, IsNonThrowingApply = 0,
+           IsStackPartialApply = 0;
   ValueID ValID, ValID2, ValID3;
   TypeID TyID, TyID2, TyID3;
   TypeID ConcreteTyID;
@@ -751,6 +752,10 @@ bool SILDeserializer::readSILInstruction(SILFunction *Fn, SILBasicBlock *BB,
       OpCode = (unsigned)ValueKind::ApplyInst;
       IsNonThrowingApply = true;
       break;
+    case SIL_STACK_PARTIAL_APPLY:
+      OpCode = (unsigned)ValueKind::PartialApplyInst;
+      IsStackPartialApply = true;
+      break;
         
     default:
       llvm_unreachable("unexpected apply inst kind");
@@ -1084,9 +1089,12 @@ bool SILDeserializer::readSILInstruction(SILFunction *Fn, SILBasicBlock *BB,
       Args.push_back(getLocalValue(ListOfValues[I], ArgTys[I + unappliedArgs]));
 
     // FIXME: Why the arbitrary order difference in IRBuilder type argument?
-    ResultVal = Builder.createPartialApply(Loc, FnVal, SubstFnTy,
+    auto *PAI = Builder.createPartialApply(Loc, FnVal, SubstFnTy,
                                            Substitutions, Args,
                                            closureTy);
+    if (IsStackPartialApply)
+      PAI->setStackAllocatable();
+    ResultVal = PAI;
     break;
   }
   case ValueKind::BuiltinInst: {
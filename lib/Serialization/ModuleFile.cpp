@@ -460,6 +460,68 @@ ModuleFile::readObjCMethodTable(ArrayRef<uint64_t> fields, StringRef blobData) {
                                              base + sizeof(uint32_t), base));
 }
 
+/// Used to deserialize entries in the on-disk tables keyed by a record in the
+/// decls block and a name.
+class ModuleFile::RecordNameTableInfo {
+public:
+  /// The bit offset of the record and the name.
+  using internal_key_type = std::pair<uint64_t, StringRef>;
+  using external_key_type = internal_key_type;
+  using data_type = SmallVector<uint32_t, 2>;
+  using hash_value_type = uint32_t;
+  using offset_type = unsigned;
+
+  internal_key_type GetInternalKey(external_key_type ID) {
+    return ID;
+  }
+
+  hash_value_type ComputeHash(internal_key_type key) {
+    return llvm::HashString(key.second,
+                            uint32_t(key.first) ^ uint32_t(key.first >> 32));
+  }
+
+  static bool EqualKey(internal_key_type lhs, internal_key_type rhs) {
+    return lhs == rhs;
+  }
+
+  static std::pair<unsigned, unsigned> ReadKeyDataLength(const uint8_t *&data) {
+    unsigned keyLength = endian::readNext<uint16_t, little, unaligned>(data);
+    unsigned dataLength = endian::readNext<uint16_t, little, unaligned>(data);
+    return { keyLength, dataLength };
+  }
+
+  static internal_key_type ReadKey(const uint8_t *data, unsigned length) {
+    uint64_t offset = endian::readNext<uint64_t, little, unaligned>(data);
+    return { offset, StringRef(reinterpret_cast<const char *>(data),
+                               length - sizeof(uint64_t)) };
+  }
+
+  static data_type ReadData(internal_key_type key, const uint8_t *data,
+                            unsigned length) {
+    assert(length % sizeof(uint32_t) == 0 && "invalid length");
+    data_type result;
+    while (length > 0) {
+      result.push_back(endian::readNext<uint32_t, little, unaligned>(data));
+      length -= sizeof(uint32_t);
+    }
+
+    return result;
+  }
+};
+
+std::unique_ptr<ModuleFile::SerializedRecordNameTable>
+ModuleFile::readRecordNameTable(ArrayRef<uint64_t> fields,
+                                StringRef blobData) {
+  uint32_t tableOffset;
+  index_block::RecordNameTableLayout::readRecord(fields, tableOffset);
+  auto base = reinterpret_cast<const uint8_t *>(blobData.data());
+
+  using OwnedTable = std::unique_ptr<SerializedRecordNameTable>;
+  return OwnedTable(
+           SerializedRecordNameTable::Create(base + tableOffset,
+                                             base + sizeof(uint32_t), base));
+}
+
 bool ModuleFile::readIndexBlock(llvm::BitstreamCursor &cursor) {
   cursor.EnterSubBlock(INDEX_BLOCK_ID);
 
@@ -524,6 +586,12 @@ bool ModuleFile::readIndexBlock(llvm::BitstreamCursor &cursor) {
       case index_block::OBJC_METHODS:
         ObjCMethods = readObjCMethodTable(scratch, blobData);
         break;
+      case index_block::DECL_MEMBER_NAMES:
+        DeclMemberNames = readRecordNameTable(scratch, blobData);
+        break;
+      case index_block::CONFORMANCES_BY_PROTOCOL:
+        ConformancesByProtocol = readRecordNameTable(scratch, blobData);
+        break;
       case index_block::ENTRY_POINT:
         assert(blobData.empty());
         setEntryPointClassID(scratch.front());
@@ -475,6 +475,8 @@ void Serializer::writeBlockInfoBlock() {
   BLOCK_RECORD(index_block, LOCAL_TYPE_DECLS);
   BLOCK_RECORD(index_block, NORMAL_CONFORMANCE_OFFSETS);
   BLOCK_RECORD(index_block, PRECEDENCE_GROUPS);
+  BLOCK_RECORD(index_block, DECL_MEMBER_NAMES);
+  BLOCK_RECORD(index_block, CONFORMANCES_BY_PROTOCOL);
 
   BLOCK(SIL_BLOCK);
   BLOCK_RECORD(sil_block, SIL_FUNCTION);
@@ -1235,8 +1237,20 @@ Serializer::writeConformances(ArrayRef<ProtocolConformance*> conformances,
                               const std::array<unsigned, 256> &abbrCodes) {
   using namespace decls_block;
 
-  for (auto conformance : conformances)
+  // The reader identifies the conformance list by the offset of its first
+  // record.
+  uint64_t listOffset = Out.GetCurrentBitNo();
+
+  for (auto conformance : conformances) {
+    uint64_t relativeOffset = Out.GetCurrentBitNo() - listOffset;
+    assert(relativeOffset <= std::numeric_limits<uint32_t>::max() &&
+           "conformance list too large");
+    auto protocolName = conformance->getProtocol()->getName();
+    ConformancesByProtocol[{listOffset, protocolName}].push_back(
+      relativeOffset);
+
     writeConformance(conformance, abbrCodes);
+  }
 }
 
 void
@@ -1317,6 +1331,9 @@ static bool shouldSerializeMember(Decl *D) {
 void Serializer::writeMembers(DeclRange members, bool isClass) {
   using namespace decls_block;
 
+  // The reader identifies the member list by the offset of this record.
+  uint64_t membersOffset = Out.GetCurrentBitNo();
+
   unsigned abbrCode = DeclTypeAbbrCodes[MembersLayout::Code];
   SmallVector<DeclID, 16> memberIDs;
   for (auto member : members) {
@@ -1326,13 +1343,16 @@ void Serializer::writeMembers(DeclRange members, bool isClass) {
     DeclID memberID = addDeclRef(member);
     memberIDs.push_back(memberID);
 
-    if (isClass) {
-      if (auto VD = dyn_cast<ValueDecl>(member)) {
-        if (VD->canBeAccessedByDynamicLookup()) {
-          auto &list = ClassMembersByName[VD->getName()];
-          list.push_back({getKindForTable(VD), memberID});
-        }
-      }
+    auto VD = dyn_cast<ValueDecl>(member);
+    if (!VD || !VD->hasName())
+      continue;
+
+    static_assert(declIDFitsIn32Bits(), "DeclID too large");
+    DeclMemberNames[{membersOffset, VD->getName()}].push_back(memberID);
+
+    if (isClass && VD->canBeAccessedByDynamicLookup()) {
+      auto &list = ClassMembersByName[VD->getName()];
+      list.push_back({getKindForTable(VD), memberID});
     }
   }
   MembersLayout::emitRecord(Out, ScratchRecord, abbrCode, memberIDs);
@@ -3945,6 +3965,75 @@ static void writeObjCMethodTable(const index_block::ObjCMethodTableLayout &out,
   out.emit(scratch, tableOffset, hashTableBlob);
 }
 
+namespace {
+  /// Used to serialize the on-disk hash tables keyed by a record in the decls
+  /// block and a name.
+  class RecordNameTableInfo {
+  public:
+    using key_type = std::pair<uint64_t, Identifier>;
+    using key_type_ref = const key_type &;
+    using data_type = SmallVector<uint32_t, 2>;
+    using data_type_ref = const data_type &;
+    using hash_value_type = uint32_t;
+    using offset_type = unsigned;
+
+    hash_value_type ComputeHash(key_type_ref key) {
+      assert(!key.second.empty());
+      return llvm::HashString(key.second.str(),
+                              uint32_t(key.first) ^ uint32_t(key.first >> 32));
+    }
+
+    std::pair<unsigned, unsigned> EmitKeyDataLength(raw_ostream &out,
+                                                    key_type_ref key,
+                                                    data_type_ref data) {
+      uint32_t keyLength = sizeof(uint64_t) + key.second.str().size();
+      assert(keyLength <= std::numeric_limits<uint16_t>::max() &&
+             "name too long");
+      uint32_t dataLength = sizeof(uint32_t) * data.size();
+      assert(dataLength <= std::numeric_limits<uint16_t>::max() &&
+             "too many values");
+      endian::Writer<little> writer(out);
+      writer.write<uint16_t>(keyLength);
+      writer.write<uint16_t>(dataLength);
+      return { keyLength, dataLength };
+    }
+
+    void EmitKey(raw_ostream &out, key_type_ref key, unsigned len) {
+      endian::Writer<little>(out).write<uint64_t>(key.first);
+      out << key.second.str();
+    }
+
+    void EmitData(raw_ostream &out, key_type_ref key, data_type_ref data,
+                  unsigned len) {
+      endian::Writer<little> writer(out);
+      for (auto value : data)
+        writer.write<uint32_t>(value);
+    }
+  };
+} // end anonymous namespace
+
+static void
+writeRecordNameTable(const index_block::RecordNameTableLayout &out,
+                     index_block::RecordKind kind,
+                     const Serializer::RecordNameTable &table) {
+  // Create the on-disk hash table. The MapVector keeps the order stable.
+  llvm::OnDiskChainedHashTableGenerator<RecordNameTableInfo> generator;
+  for (auto &entry : table)
+    generator.insert(entry.first, entry.second);
+
+  llvm::SmallString<4096> hashTableBlob;
+  uint32_t tableOffset;
+  {
+    llvm::raw_svector_ostream blobStream(hashTableBlob);
+    // Make sure that no bucket is at offset 0
+    endian::Writer<little>(blobStream).write<uint32_t>(0);
+    tableOffset = generator.Emit(blobStream);
+  }
+
+  SmallVector<uint64_t, 8> scratch;
+  out.emit(scratch, kind, tableOffset, hashTableBlob);
+}
+
 /// Add operator methods from the given declaration type.
 ///
 /// Recursively walks the members and derived global decls of any nested
@@ -4116,6 +4205,12 @@ void Serializer::writeAST(ModuleOrSourceFile DC) {
     index_block::ObjCMethodTableLayout ObjCMethodTable(Out);
     writeObjCMethodTable(ObjCMethodTable, objcMethods);
 
+    index_block::RecordNameTableLayout RecordNameTable(Out);
+    writeRecordNameTable(RecordNameTable, index_block::DECL_MEMBER_NAMES,
+                         DeclMemberNames);
+    writeRecordNameTable(RecordNameTable, index_block::CONFORMANCES_BY_PROTOCOL,
+                         ConformancesByProtocol);
+
     if (entryPointClassID.hasValue()) {
       index_block::EntryPointLayout EntryPoint(Out);
       EntryPoint.emit(ScratchRecord, entryPointClassID.getValue());
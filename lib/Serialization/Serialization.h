@@ -123,12 +123,30 @@ public:
   // hash table of all defined Objective-C methods.
   using ObjCMethodTable = llvm::DenseMap<ObjCSelector, ObjCMethodTableData>;
 
+  /// The in-memory representation of an on-disk table mapping a record in
+  /// the decls block (by bit offset) and a name to 32-bit values.
+  using RecordNameTable =
+    llvm::MapVector<std::pair<uint64_t, Identifier>, SmallVector<uint32_t, 2>>;
+
 private:
   /// A map from identifiers to methods and properties with the given name.
   ///
   /// This is used for id-style lookup.
   DeclTable ClassMembersByName;
 
+  /// The IDs of the members of every nominal type and extension, by the
+  /// offset of its members record and by name.
+  ///
+  /// This is used to look up members without loading all of them.
+  RecordNameTable DeclMemberNames;
+
+  /// The conformances of every nominal type and extension, by the offset of
+  /// its conformance list and by protocol name. The values are the bit
+  /// offsets of the conformances, relative to the start of the list.
+  ///
+  /// This is used to look up conformances without loading all of them.
+  RecordNameTable ConformancesByProtocol;
+
   /// The queue of types and decls that need to be serialized.
   ///
   /// This is a queue and not simply a vector because serializing one
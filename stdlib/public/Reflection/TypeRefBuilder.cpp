@@ -28,6 +28,44 @@ using namespace reflection;
 
 TypeRefBuilder::TypeRefBuilder() : TC(*this) {}
 
+void TypeRefBuilder::indexReflectionInfos() {
+  for (; NumIndexedReflectionInfos < ReflectionInfos.size();
+       ++NumIndexedReflectionInfos) {
+    auto &Info = ReflectionInfos[NumIndexedReflectionInfos];
+
+    // If a type is described by more than one image, the first one wins,
+    // as it did when each lookup walked the images in order.
+    for (auto &FD : Info.fieldmd) {
+      if (!FD.hasMangledTypeName())
+        continue;
+      FieldDescriptors.emplace(FD.getMangledTypeName(), &FD);
+    }
+
+    for (auto &AssocTyDescriptor : Info.assocty) {
+      AssociatedTypeDescriptors[
+        AssocTyDescriptor.getMangledConformingTypeName()]
+        .push_back(&AssocTyDescriptor);
+    }
+
+    for (auto &BuiltinTypeDescriptor : Info.builtin) {
+      assert(BuiltinTypeDescriptor.Size > 0);
+      assert(BuiltinTypeDescriptor.Alignment > 0);
+      assert(BuiltinTypeDescriptor.Stride > 0);
+      if (!BuiltinTypeDescriptor.hasMangledTypeName())
+        continue;
+      BuiltinTypeDescriptors.emplace(BuiltinTypeDescriptor.getMangledTypeName(),
+                                     &BuiltinTypeDescriptor);
+    }
+
+    for (auto &CD : Info.capture) {
+      auto RemoteAddress = ((uintptr_t) &CD -
+                            Info.LocalStartAddress +
+                            Info.RemoteStartAddress);
+      CaptureDescriptors.emplace(RemoteAddress, &CD);
+    }
+  }
+}
+
 const TypeRef * TypeRefBuilder::
 lookupTypeWitness(const std::string &MangledTypeName,
                   const std::string &Member,
@@ -40,32 +78,31 @@ lookupTypeWitness(const std::string &MangledTypeName,
   if (found != AssociatedTypeCache.end())
     return found->second;
 
-  // Cache missed - we need to look through all of the assocty sections
-  // for all images that we've been notified about.
-  for (auto &Info : ReflectionInfos) {
-    for (const auto &AssocTyDescriptor : Info.assocty) {
-      std::string ConformingTypeName(AssocTyDescriptor.ConformingTypeName);
-      if (ConformingTypeName.compare(MangledTypeName) != 0)
-        continue;
+  // Cache missed - we need to look through the assocty descriptors for
+  // this type in all images that we've been notified about.
+  indexReflectionInfos();
+  auto Descriptors = AssociatedTypeDescriptors.find(MangledTypeName);
+  if (Descriptors == AssociatedTypeDescriptors.end())
+    return nullptr;
 
-      std::string ProtocolMangledName(AssocTyDescriptor.ProtocolTypeName);
-      auto DemangledProto = Demangle::demangleTypeAsNode(ProtocolMangledName);
-      auto TR = swift::remote::decodeMangledType(*this, DemangledProto);
+  for (auto *AssocTyDescriptor : Descriptors->second) {
+    std::string ProtocolMangledName(AssocTyDescriptor->ProtocolTypeName);
+    auto DemangledProto = Demangle::demangleTypeAsNode(ProtocolMangledName);
+    auto TR = swift::remote::decodeMangledType(*this, DemangledProto);
 
-      if (Protocol != TR)
-        continue;
+    if (Protocol != TR)
+      continue;
 
-      for (auto &AssocTy : AssocTyDescriptor) {
-        if (Member.compare(AssocTy.getName()) != 0)
-          continue;
+    for (auto &AssocTy : *AssocTyDescriptor) {
+      if (Member.compare(AssocTy.getName()) != 0)
+        continue;
 
-        auto SubstitutedTypeName = AssocTy.getMangledSubstitutedTypeName();
-        auto Demangled = Demangle::demangleTypeAsNode(SubstitutedTypeName);
-        auto *TypeWitness = swift::remote::decodeMangledType(*this, Demangled);
+      auto SubstitutedTypeName = AssocTy.getMangledSubstitutedTypeName();
+      auto Demangled = Demangle::demangleTypeAsNode(SubstitutedTypeName);
+      auto *TypeWitness = swift::remote::decodeMangledType(*this, Demangled);
 
-        AssociatedTypeCache.insert(std::make_pair(key, TypeWitness));
-        return TypeWitness;
-      }
+      AssociatedTypeCache.insert(std::make_pair(key, TypeWitness));
+      return TypeWitness;
     }
   }
   return nullptr;
@@ -108,19 +145,11 @@ TypeRefBuilder::getFieldTypeInfo(const TypeRef *TR) {
   else
     return {};
 
-  std::vector<std::pair<std::string, const TypeRef *>> Fields;
-  for (auto Info : ReflectionInfos) {
-    for (auto &FD : Info.fieldmd) {
-      if (!FD.hasMangledTypeName())
-        continue;
-      auto CandidateMangledName = FD.getMangledTypeName();
-      if (MangledName.compare(CandidateMangledName) != 0)
-        continue;
-      return &FD;
-    }
-  }
-
-  return nullptr;
+  indexReflectionInfos();
+  auto found = FieldDescriptors.find(MangledName);
+  if (found == FieldDescriptors.end())
+    return nullptr;
+  return found->second;
 }
 
 std::vector<FieldTypeInfo>
@@ -168,36 +197,20 @@ TypeRefBuilder::getBuiltinTypeInfo(const TypeRef *TR) {
   else
     return nullptr;
 
-  for (auto Info : ReflectionInfos) {
-    for (auto &BuiltinTypeDescriptor : Info.builtin) {
-      assert(BuiltinTypeDescriptor.Size > 0);
-      assert(BuiltinTypeDescriptor.Alignment > 0);
-      assert(BuiltinTypeDescriptor.Stride > 0);
-      if (!BuiltinTypeDescriptor.hasMangledTypeName())
-        continue;
-      auto CandidateMangledName = BuiltinTypeDescriptor.getMangledTypeName();
-      if (MangledName.compare(CandidateMangledName) != 0)
-        continue;
-      return &BuiltinTypeDescriptor;
-    }
-  }
-
-  return nullptr;
+  indexReflectionInfos();
+  auto found = BuiltinTypeDescriptors.find(MangledName);
+  if (found == BuiltinTypeDescriptors.end())
+    return nullptr;
+  return found->second;
 }
 
 const CaptureDescriptor *
 TypeRefBuilder::getCaptureDescriptor(uintptr_t RemoteAddress) {
-  for (auto Info : ReflectionInfos) {
-    for (auto &CD : Info.capture) {
-      auto OtherAddr = ((uintptr_t) &CD -
-                        Info.LocalStartAddress +
-                        Info.RemoteStartAddress);
-      if (OtherAddr == RemoteAddress)
-        return &CD;
-    }
-  }
-
-  return nullptr;
+  indexReflectionInfos();
+  auto found = CaptureDescriptors.find(RemoteAddress);
+  if (found == CaptureDescriptors.end())
+    return nullptr;
+  return found->second;
 }
 
 /// Get the unsubstituted capture types for a closure context.
@@ -0,0 +1,26 @@
+; This is not really a Swift source file: -*- Text -*-
+
+%t.input: "A ---> B" ==> "A"
+RUN: sed -ne '/--->/s/ *--->.*$//p' < %S/Inputs/manglings.txt > %t.input
+
+%t.check: "A ---> B" ==> "B"
+RUN: sed -ne '/--->/s/^.*---> *//p' < %S/Inputs/manglings.txt > %t.check
+
+Small chunks make every thread demangle several parts of the input; the
+output must still be in the order of the input.
+RUN: swift-demangle -j 4 -chunk-size=64 < %t.input > %t.output
+RUN: diff %t.check %t.output
+RUN: swift-demangle -j 4 -chunk-size=64 -input-file %t.input > %t.output-file
+RUN: diff %t.check %t.output-file
+
+Repeated symbols are demangled from the per-thread cache.
+RUN: cat %t.input %t.input > %t.input-twice
+RUN: cat %t.check %t.check > %t.check-twice
+RUN: swift-demangle -j 3 -chunk-size=1000 -input-file %t.input-twice > %t.output-twice
+RUN: diff %t.check-twice %t.output-twice
+
+Text around the symbols is kept, and a last line without a newline is handled.
+RUN: printf 'call _TtSi now\nno symbols here\n_TtBo' | swift-demangle -j 2 -chunk-size=1 | %FileCheck %s
+CHECK: call Swift.Int now
+CHECK-NEXT: no symbols here
+CHECK-NEXT: Builtin.NativeObject
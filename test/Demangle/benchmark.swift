@@ -0,0 +1,14 @@
+; This is not really a Swift source file: -*- Text -*-
+
+RUN: swift-demangle -benchmark=3 _TtSi _TtBo | %FileCheck %s
+CHECK: Demangled 2 symbols x 3 iterations:
+CHECK-NEXT: one-shot: {{.*}} symbols/s)
+CHECK-NEXT: reused context: {{.*}} symbols/s)
+CHECK-NEXT: batch (-j 1): {{.*}} symbols/s)
+
+The benchmark fails if a reused context demangles any symbol differently.
+RUN: sed -ne '/--->/s/ *--->.*$//p' < %S/Inputs/manglings.txt > %t.input
+RUN: swift-demangle -benchmark=1 < %t.input | %FileCheck %s -check-prefix=STDIN
+STDIN: Demangled {{[0-9]+}} symbols x 1 iterations:
+STDIN: reused context:
+STDIN-NEXT: batch (-j 1):
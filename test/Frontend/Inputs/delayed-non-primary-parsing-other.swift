@@ -0,0 +1,9 @@
+func otherFunc() -> Int {
+  let x = = 1
+  return x
+}
+
+@_transparent
+func otherTransparentFunc() -> Int {
+  return 42
+}
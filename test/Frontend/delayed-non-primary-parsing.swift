@@ -0,0 +1,12 @@
+// RUN: %target-swift-frontend -parse -primary-file %s %S/Inputs/delayed-non-primary-parsing-other.swift -verify
+// RUN: not %target-swift-frontend -parse -primary-file %s %S/Inputs/delayed-non-primary-parsing-other.swift -disable-delayed-non-primary-function-body-parsing 2>&1 | %FileCheck %s
+
+// Function bodies of non-primary files are only parsed if they are needed, so
+// the error in the body of otherFunc() is only diagnosed when its file is the
+// primary file or delayed parsing is disabled.
+
+// CHECK: delayed-non-primary-parsing-other.swift:2:11: error: expected expression
+
+func primaryFunc() -> Int {
+  return otherFunc() + otherTransparentFunc()
+}
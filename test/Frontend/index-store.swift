@@ -0,0 +1,43 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: cp %s %t/main.swift
+// RUN: %target-swift-frontend -parse -primary-file %t/main.swift -module-name index_store -index-store-path %t/idx -o %t/main.o
+// RUN: ls %t/idx/v1/records | %FileCheck -check-prefix=RECORDS-1 %s
+// RUN: cat %t/idx/v1/records/main.swift-* | %FileCheck -check-prefix=RECORD %s
+// RUN: cat %t/idx/v1/units/main.o-* | %FileCheck -check-prefix=UNIT %s
+// RUN: ls %t/idx/v1/units | %FileCheck -check-prefix=UNITS %s
+
+// RECORDS-1: main.swift-{{[0-9a-f]+}}
+// RECORDS-1-NOT: main.swift-
+
+// RECORD: symbol {{[0-9]+ [0-9]+ [0-9]+}} [[@LINE+3]]:15 {{s:[^ ]+}} Widget
+// RECORD: symbol {{[0-9]+ [0-9]+ [0-9]+}} [[@LINE+3]]:15 {{s:[^ ]+}} draw()
+// RECORD: symbol {{[0-9]+ [0-9]+ [0-9]+}} [[@LINE+4]]:6 {{s:[^ ]+}} use()
+public struct Widget {
+  public func draw() {}
+}
+func use() {
+  Widget().draw()
+}
+
+// UNIT: module index_store
+// UNIT: output {{.*}}main.o
+// UNIT: file {{.*}}main.swift main.swift-{{[0-9a-f]+}}
+// UNIT: dep swift system Swift
+
+// Units are named by the MD5 of the output path, like records are named by the
+// MD5 of their contents, so the names are stable across compiler builds.
+// UNITS: main.o-{{[0-9a-f]{32}$}}
+
+// Recompiling without changes keeps the existing record; a change adds a new
+// record and updates the unit to refer to it.
+// RUN: %target-swift-frontend -parse -primary-file %t/main.swift -module-name index_store -index-store-path %t/idx -o %t/main.o
+// RUN: ls %t/idx/v1/records | %FileCheck -check-prefix=RECORDS-1 %s
+// RUN: echo "func added() {}" >> %t/main.swift
+// RUN: %target-swift-frontend -parse -primary-file %t/main.swift -module-name index_store -index-store-path %t/idx -o %t/main.o
+// RUN: ls %t/idx/v1/records | %FileCheck -check-prefix=RECORDS-2 %s
+// RUN: cat %t/idx/v1/units/main.o-* | %FileCheck -check-prefix=UNIT-2 %s
+
+// RECORDS-2: main.swift-{{[0-9a-f]+}}
+// RECORDS-2: main.swift-{{[0-9a-f]+}}
+// UNIT-2: file {{.*}}main.swift main.swift-{{[0-9a-f]+}}
+// UNIT-2-NOT: file
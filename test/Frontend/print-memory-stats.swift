@@ -0,0 +1,27 @@
+// RUN: %target-swift-frontend -emit-ir -print-memory-stats %s -o /dev/null 2>&1 | %FileCheck %s
+
+// CHECK: "peak-rss": {{[0-9]+}}
+// CHECK: "arenas": [
+// CHECK: "name": "SIL",
+// CHECK: "name": "IRGen (peak RSS growth)",
+// CHECK: "name": "AST",
+// CHECK: "name": "AST tables",
+// CHECK: "name": "Constraint solver (peak)",
+// CHECK: "phases": [
+// CHECK: "name": "Semantic analysis",
+// CHECK-NEXT: "heap-in-use": {{[0-9]+}},
+// CHECK-NEXT: "peak-rss": {{[0-9]+}}
+// CHECK: "name": "SILGen",
+// CHECK: "name": "SIL optimization",
+// CHECK: "name": "IRGen",
+// CHECK: "largest-tables": [
+// CHECK: "entries": {{[1-9][0-9]*}},
+
+struct Point {
+  var x: Int
+  var y: Int
+}
+
+func distance(_ a: Point, _ b: Point) -> Int {
+  return abs(a.x - b.x) + abs(a.y - b.y)
+}
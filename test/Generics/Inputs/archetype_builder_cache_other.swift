@@ -0,0 +1,11 @@
+protocol Link {
+  associatedtype Value : Equatable
+  var value: Value { get }
+}
+
+protocol Chain {
+  associatedtype Head : Link
+  associatedtype Tail : Link
+  var head: Head { get }
+  var tail: Tail { get }
+}
@@ -0,0 +1,43 @@
+// REQUIRES: asserts
+
+// RUN: %target-swift-frontend -emit-ir %s %S/Inputs/archetype_builder_cache_other.swift -o /dev/null -print-stats 2>&1 | %FileCheck %s -check-prefix=STATS
+// STATS-DAG: {{[0-9]+}} ASTContext - # of archetype builders built for canonical signatures
+// STATS-DAG: {{[0-9]+}} ASTContext - # of canonical signatures whose archetype builder was reused
+// STATS-DAG: {{[0-9]+}} TypeCheckDecl - # of archetype builders created for generic declarations
+
+// RUN: %target-swift-frontend -emit-ir %s %S/Inputs/archetype_builder_cache_other.swift -o /dev/null -debug-time-compilation 2>&1 | %FileCheck %s -check-prefix=TIMER
+// TIMER-DAG: Build archetypes for canonical signatures
+// TIMER-DAG: Build archetypes for generic declarations
+
+// Building the archetypes of a signature whose associated types conform to
+// protocols from another file builds those protocols' archetypes too; only
+// the outermost build is timed, or the timer would be started twice. The
+// same holds for the generic signatures Sema builds, which can validate other
+// generic declarations while they are being built.
+// RUN: %target-swift-frontend -emit-ir -primary-file %s %S/Inputs/archetype_builder_cache_other.swift -o /dev/null -debug-time-compilation 2>&1 | %FileCheck %s -check-prefix=TIMER
+
+protocol Container {
+  associatedtype Element
+  associatedtype Index : Comparable
+  func element(at index: Index) -> Element
+}
+
+struct Wrapper<C : Container> where C.Element : Equatable {
+  var base: C
+
+  func contains(_ element: C.Element, at index: C.Index) -> Bool {
+    return base.element(at: index) == element
+  }
+
+  func same(_ other: Wrapper<C>, at index: C.Index) -> Bool {
+    return other.base.element(at: index) == base.element(at: index)
+  }
+}
+
+struct ChainWrapper<C : Chain> where C.Head.Value == C.Tail.Value {
+  var base: C
+
+  func isLinked() -> Bool {
+    return base.head.value == base.tail.value
+  }
+}
@@ -0,0 +1,41 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -O -parse-as-library -module-name main -emit-ir %s -o %t/retained.ll
+// RUN: %target-swift-frontend -O -parse-as-library -module-name main -emit-ir -release-sil-during-irgen %s -o %t/released.ll
+// RUN: diff %t/retained.ll %t/released.ll
+
+// Releasing the body of each SIL function once it has been lowered must not
+// change the IR: references emitted later, from other functions, vtables and
+// witness tables, only need the function's name and type, and static
+// initializers are still read after all functions have been emitted.
+
+public let staticallyInitialized = (1, 2.5)
+
+public protocol Shape {
+  func area() -> Double
+}
+
+public struct Square : Shape {
+  public var side: Double
+  public func area() -> Double { return side * side }
+}
+
+public class Canvas {
+  var shapes: [Shape] = []
+
+  public init() {}
+
+  public func add(_ shape: Shape) { shapes.append(shape) }
+
+  public func totalArea() -> Double {
+    return sumOfAreas(shapes)
+  }
+}
+
+@inline(never)
+private func sumOfAreas(_ shapes: [Shape]) -> Double {
+  var total = 0.0
+  for shape in shapes {
+    total += shape.area()
+  }
+  return total + Double(staticallyInitialized.0)
+}
@@ -0,0 +1,48 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-jit-run -Xfrontend -immediate-object-cache-path -Xfrontend %t/cache -Xllvm -debug-only=swift-immediate -Xfrontend -debug-time-compilation %s 2>%t/first.log | %FileCheck %s
+// RUN: %FileCheck -check-prefix=MISS %s < %t/first.log
+// RUN: ls %t/cache | %FileCheck -check-prefix=CACHE %s
+// RUN: cat %t/cache/*.deps | %FileCheck -check-prefix=DEPS %s
+
+// Running the unchanged script again with the same arguments reuses the cached
+// object file without type checking or generating any code.
+// RUN: %target-jit-run -Xfrontend -immediate-object-cache-path -Xfrontend %t/cache -Xllvm -debug-only=swift-immediate -Xfrontend -debug-time-compilation %s 2>%t/second.log | %FileCheck %s
+// RUN: %FileCheck -check-prefix=HIT -implicit-check-not="Cached object file" -implicit-check-not="Type checking" -implicit-check-not="SIL optimization" -implicit-check-not="Module to be executed" %s < %t/second.log
+// RUN: ls %t/cache | %FileCheck -check-prefix=CACHE %s
+
+// A changed script gets its own cache entry.
+// RUN: %target-jit-run -Xfrontend -immediate-object-cache-path -Xfrontend %t/cache -Xllvm -debug-only=swift-immediate -DCHANGED %s 2>%t/changed.log | %FileCheck -check-prefix=CHANGED %s
+// RUN: %FileCheck -check-prefix=MISS %s < %t/changed.log
+// RUN: ls %t/cache | %FileCheck -check-prefix=CACHE-CHANGED %s
+
+// REQUIRES: swift_interpreter
+// REQUIRES: asserts
+
+// MISS-NOT: Using cached object file
+// MISS: Cached object file {{.*}}.o
+// MISS-NOT: Using cached object file
+
+// HIT: Using cached object file {{.*}}.o
+
+// The entry records the modules the script imports and the libraries it
+// links against, which are checked before the entry is used.
+// DEPS: file {{[0-9]+}} {{[0-9]+}} {{.*}}Swift.swiftmodule
+// DEPS: library {{[01]}} {{[01]}} swiftCore
+
+// CACHE: {{^[0-9a-f]+}}.deps
+// CACHE-NEXT: {{^[0-9a-f]+}}.o
+// CACHE-NOT: {{^[0-9a-f]+}}.
+
+// CACHE-CHANGED: {{^[0-9a-f]+}}.deps
+// CACHE-CHANGED: {{^[0-9a-f]+}}.o
+// CACHE-CHANGED: {{^[0-9a-f]+}}.deps
+// CACHE-CHANGED: {{^[0-9a-f]+}}.o
+// CACHE-CHANGED-NOT: {{^[0-9a-f]+}}.
+
+#if CHANGED
+// CHANGED: changed
+print("changed")
+#else
+// CHECK: unchanged
+print("unchanged")
+#endif
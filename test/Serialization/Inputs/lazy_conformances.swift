@@ -0,0 +1,30 @@
+public protocol Shape {
+  func area() -> Int
+}
+
+public protocol Named {
+  var name: String { get }
+}
+
+public protocol Unused1 {}
+public protocol Unused2 {}
+
+public struct Square : Shape, Unused1 {
+  public var side: Int
+  public init(side: Int) { self.side = side }
+  public func area() -> Int { return side * side }
+}
+
+extension Square : Named, Unused2 {
+  public var name: String { return "square" }
+}
+
+extension Square : Equatable {}
+
+public func ==(lhs: Square, rhs: Square) -> Bool {
+  return lhs.side == rhs.side
+}
+
+public enum Color : Int {
+  case red, green, blue
+}
@@ -0,0 +1,37 @@
+public struct Point {
+  public var x: Int
+  public var y: Int
+
+  public init(x: Int, y: Int) {
+    self.x = x
+    self.y = y
+  }
+
+  public func scaled(by factor: Int) -> Point {
+    return Point(x: x * factor, y: y * factor)
+  }
+
+  public func unused1() {}
+  public func unused2() {}
+  public func unused3() {}
+}
+
+extension Point {
+  public var sum: Int { return x + y }
+
+  public func scaled(by factor: Int, offset: Int) -> Point {
+    return Point(x: x * factor + offset, y: y * factor + offset)
+  }
+
+  public func unused4() {}
+}
+
+public class Shape {
+  public init() {}
+  public func area() -> Int { return 0 }
+}
+
+public class Square : Shape {
+  public var side: Int = 0
+  public override func area() -> Int { return side * side }
+}
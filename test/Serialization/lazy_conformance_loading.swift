@@ -0,0 +1,40 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: %target-swift-frontend -emit-module -o %t %S/Inputs/lazy_conformances.swift
+// RUN: llvm-bcanalyzer %t/lazy_conformances.swiftmodule | %FileCheck -check-prefix=CHECK-BC %s
+// RUN: %target-swift-frontend -emit-sil -I %t %s -o %t/default.sil
+// RUN: %target-swift-frontend -emit-sil -I %t %s -o %t/lazy.sil -enable-lazy-conformance-loading -print-stats 2>&1 | %FileCheck -check-prefix=CHECK-STATS %s
+// RUN: diff -u %t/default.sil %t/lazy.sil
+
+// Only the conformances this file asks about are deserialized.
+// RUN: %target-swift-frontend -emit-sil -I %t %s -o /dev/null -Xllvm -debug-only=serialization 2>&1 | %FileCheck -check-prefix=CHECK-DEFAULT %s
+// RUN: %target-swift-frontend -emit-sil -I %t %s -o /dev/null -enable-lazy-conformance-loading -Xllvm -debug-only=serialization 2>&1 | %FileCheck -check-prefix=CHECK-LAZY -implicit-check-not=Unused %s
+
+// REQUIRES: asserts
+
+// CHECK-BC-NOT: UnknownCode
+// CHECK-BC: CONFORMANCES_BY_PROTOCOL
+
+// CHECK-STATS: {{[0-9]+}} Protocol conformance lookup - # of serialized conformance lists searched for one protocol
+
+// CHECK-DEFAULT-DAG: Loaded conformance of Square to Unused1
+// CHECK-DEFAULT-DAG: Loaded conformance of Square to Unused2
+
+// CHECK-LAZY-DAG: Loaded conformance of Square to Shape
+// CHECK-LAZY-DAG: Loaded conformance of Square to Named
+
+import lazy_conformances
+
+func totalArea<T : Shape>(_ shapes: [T]) -> Int {
+  return shapes.reduce(0) { $0 + $1.area() }
+}
+
+func describe<T : Named>(_ value: T) -> String {
+  return value.name
+}
+
+func test(_ squares: [Square], _ color: Color) -> Int {
+  _ = describe(squares[0])
+  _ = squares[0] == squares[1]
+  return totalArea(squares) + color.rawValue
+}
@@ -0,0 +1,23 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: %target-swift-frontend -emit-module -o %t %S/Inputs/named_lazy_members.swift
+// RUN: llvm-bcanalyzer %t/named_lazy_members.swiftmodule | %FileCheck -check-prefix=CHECK-BC %s
+// RUN: %target-swift-frontend -emit-sil -I %t %s -o %t/default.sil
+// RUN: %target-swift-frontend -emit-sil -I %t %s -o %t/named.sil -enable-named-lazy-member-loading -print-stats 2>&1 | %FileCheck -check-prefix=CHECK-STATS %s
+// RUN: diff -u %t/default.sil %t/named.sil
+
+// REQUIRES: asserts
+
+// CHECK-BC-NOT: UnknownCode
+// CHECK-BC: DECL_MEMBER_NAMES
+
+// CHECK-STATS: {{[0-9]+}} Name lookup - # of direct member lookups that loaded members by name
+
+import named_lazy_members
+
+func test(p: Point, s: Square) -> Int {
+  let q = p.scaled(by: 2)
+  let r = q.scaled(by: 2, offset: 1)
+  s.side = r.sum
+  return s.area() + Point(x: 1, y: 2).x
+}
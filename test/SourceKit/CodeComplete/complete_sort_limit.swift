@@ -0,0 +1,33 @@
+// XFAIL: broken_std_regex
+
+// Only the requested page of the top-level results is sorted; make sure the
+// page holds the same results, in the same order, as the fully sorted list.
+
+func foo1() {}
+func foo2(x: Int) {}
+struct Foo3 {}
+let foo4 = 1
+
+// RUN: %complete-test -tok=TOP_LEVEL_0 %s > %t.all
+// RUN: %complete-test -tok=TOP_LEVEL_0 %s -limit=20 > %t.page0
+// RUN: %complete-test -tok=TOP_LEVEL_0 %s -start=20 -limit=20 > %t.page1
+// RUN: sed -n -e '1,20 p' %t.all > %t.all.page0
+// RUN: sed -n -e '21,40 p' %t.all > %t.all.page1
+// RUN: diff %t.all.page0 %t.page0
+// RUN: diff %t.all.page1 %t.page1
+
+// RUN: %complete-test -tok=TOP_LEVEL_1 %s > %t.filtered.all
+// RUN: %complete-test -tok=TOP_LEVEL_1 %s -limit=5 > %t.filtered.page0
+// RUN: sed -n -e '2,6 p' %t.filtered.all > %t.filtered.all.page0
+// RUN: sed -n -e '2,6 p' %t.filtered.page0 > %t.filtered.page0.items
+// RUN: diff %t.filtered.all.page0 %t.filtered.page0.items
+// RUN: %FileCheck -check-prefix=FILTERED %s < %t.filtered.page0.items
+// FILTERED: foo
+
+func test001() {
+  #^TOP_LEVEL_0^#
+}
+
+func test002() {
+  #^TOP_LEVEL_1,f^#
+}
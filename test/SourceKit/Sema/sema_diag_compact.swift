@@ -0,0 +1,76 @@
+func foo() {
+let a = 0; unresolved
+}
+
+{
+print("x")
+
+// Diagnostics are sent to the client as a compact array; make sure their
+// ranges, fix-its and notes, and the fix-its of the notes, all survive.
+
+// RUN: %sourcekitd-test -req=open %s -- %s == -req=print-diags %s \
+// RUN: | %FileCheck %s
+
+// Parser diagnostics come first.
+
+// CHECK:      key.line: 5,
+// CHECK-NEXT: key.column: 1,
+// CHECK-NEXT: key.filepath: "{{.*}}sema_diag_compact.swift",
+// CHECK-NEXT: key.severity: source.diagnostic.severity.error,
+// CHECK-NEXT: key.description: "statement cannot begin with a closure expression",
+// CHECK-NEXT: key.diagnostic_stage: source.diagnostic.stage.swift.parse,
+// CHECK-NEXT: key.diagnostics: [
+// CHECK-NEXT:   {
+// CHECK-NEXT:     key.line: 5,
+// CHECK-NEXT:     key.column: 1,
+// CHECK-NEXT:     key.filepath: "{{.*}}sema_diag_compact.swift",
+// CHECK-NEXT:     key.severity: source.diagnostic.severity.note,
+// CHECK-NEXT:     key.description: "explicitly discard the result of the closure by assigning to '_'",
+// CHECK-NEXT:     key.fixits: [
+// CHECK-NEXT:       {
+// CHECK-NEXT:         key.offset: 38,
+// CHECK-NEXT:         key.length: 0,
+// CHECK-NEXT:         key.sourcetext: "_ = "
+// CHECK-NEXT:       }
+// CHECK-NEXT:     ]
+// CHECK-NEXT:   }
+// CHECK-NEXT: ]
+
+// CHECK:      key.description: "expected '}' at end of closure",
+// CHECK-NEXT: key.diagnostic_stage: source.diagnostic.stage.swift.parse,
+// CHECK-NEXT: key.diagnostics: [
+// CHECK-NEXT:   {
+// CHECK-NEXT:     key.line: 5,
+// CHECK-NEXT:     key.column: 1,
+// CHECK-NEXT:     key.filepath: "{{.*}}sema_diag_compact.swift",
+// CHECK-NEXT:     key.severity: source.diagnostic.severity.note,
+// CHECK-NEXT:     key.description: "to match this opening '{'"
+// CHECK-NEXT:   }
+// CHECK-NEXT: ]
+
+// CHECK:      key.line: 2,
+// CHECK-NEXT: key.column: 5,
+// CHECK-NEXT: key.filepath: "{{.*}}sema_diag_compact.swift",
+// CHECK-NEXT: key.severity: source.diagnostic.severity.warning,
+// CHECK-NEXT: key.description: "initialization of immutable value 'a'
+// CHECK-NEXT: key.diagnostic_stage: source.diagnostic.stage.swift.sema,
+// CHECK-NEXT: key.fixits: [
+// CHECK-NEXT:   {
+// CHECK-NEXT:     key.offset: 13,
+// CHECK-NEXT:     key.length: 5,
+// CHECK-NEXT:     key.sourcetext: "_"
+// CHECK-NEXT:   }
+// CHECK-NEXT: ]
+
+// CHECK:      key.line: 2,
+// CHECK-NEXT: key.column: 12,
+// CHECK-NEXT: key.filepath: "{{.*}}sema_diag_compact.swift",
+// CHECK-NEXT: key.severity: source.diagnostic.severity.error,
+// CHECK-NEXT: key.description: "use of unresolved identifier 'unresolved'",
+// CHECK-NEXT: key.diagnostic_stage: source.diagnostic.stage.swift.sema,
+// CHECK-NEXT: key.ranges: [
+// CHECK-NEXT:   {
+// CHECK-NEXT:     key.offset: 24,
+// CHECK-NEXT:     key.length: 10
+// CHECK-NEXT:   }
+// CHECK-NEXT: ]
@@ -0,0 +1,20 @@
+// An edit that leaves the text unchanged, like an edit followed by its undo,
+// reuses the AST built for the previous snapshot instead of rebuilding it.
+
+// RUN: %sourcekitd-test -req=open %s -- %s == -req=print-diags %s \
+// RUN:    == -req=edit -pos=15:1 -replace="c" -length=1 %s == -req=print-diags %s \
+// RUN:    == -req=stats | %FileCheck %s
+
+// CHECK: key.kind: source.statistic.num-ast-builds
+// CHECK-NEXT: key.description: "# ASTs built"
+// CHECK-NEXT: key.value: 1
+// CHECK: key.kind: source.statistic.num-ast-reuses
+// CHECK-NEXT: key.description: "# ASTs reused for unchanged contents"
+// CHECK-NEXT: key.value: 1
+
+class MyClass {
+}
+
+func foo() {
+  let _ = MyClass()
+}
@@ -367,6 +367,12 @@ public:
   virtual bool handleDiagnostic(const DiagnosticEntryInfo &Info) = 0;
 };
 
+struct Statistic {
+  UIdent Kind;
+  std::string Description;
+  int64_t Value;
+};
+
 class LangSupport {
   virtual void anchor();
 
@@ -488,6 +494,9 @@ public:
                           StringRef ModuleName,
                           ArrayRef<const char *> Args,
                           DocInfoConsumer &Consumer) = 0;
+
+  virtual void
+  getStatistics(std::function<void(ArrayRef<Statistic>)> Receiver) = 0;
 };
 
 } // namespace SourceKit
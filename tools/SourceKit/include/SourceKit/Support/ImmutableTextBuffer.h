@@ -21,12 +21,17 @@
 #include "llvm/Support/Mutex.h"
 #include <functional>
 #include <memory>
+#include <vector>
 
 namespace llvm {
   class MemoryBuffer;
   class SourceMgr;
 }
 
+namespace clang {
+  class RewriteRope;
+}
+
 namespace SourceKit {
 
 class ImmutableTextUpdate;
@@ -73,6 +78,11 @@ class ImmutableTextBuffer : public ImmutableTextUpdate {
   std::unique_ptr<llvm::SourceMgr> SrcMgr;
   unsigned BufId;
 
+  /// The offsets at which each line starts, computed on the first call to
+  /// getLineAndColumn().
+  mutable std::vector<unsigned> LineStarts;
+  mutable llvm::sys::Mutex LineStartsMtx;
+
 public:
   explicit ImmutableTextBuffer(std::unique_ptr<llvm::MemoryBuffer> MemBuf,
                                uint64_t Stamp);
@@ -156,10 +166,14 @@ class EditableTextBuffer : public ThreadSafeRefCountedBase<EditableTextBuffer> {
   llvm::sys::Mutex EditMtx;
   ImmutableTextBufferRef Root;
   ImmutableTextUpdateRef CurrUpd;
+  /// The text as of \c CurrUpd, kept up-to-date with every edit so that the
+  /// latest snapshot can be materialized without replaying the updates.
+  std::unique_ptr<clang::RewriteRope> CurrText;
   std::string Filename;
 
 public:
   explicit EditableTextBuffer(StringRef Filename, StringRef Text = StringRef());
+  ~EditableTextBuffer();
 
   StringRef getFilename() const { return Filename; }
 
@@ -14,6 +14,7 @@
 #include "clang/Rewrite/Core/RewriteRope.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
+#include <algorithm>
 
 using namespace SourceKit;
 using namespace llvm;
@@ -51,12 +52,32 @@ const llvm::MemoryBuffer *ImmutableTextBuffer::getInternalBuffer() const {
 
 std::pair<unsigned, unsigned>
 ImmutableTextBuffer::getLineAndColumn(unsigned ByteOffset) const {
-  auto Buf = SrcMgr->getMemoryBuffer(BufId);
-  if (ByteOffset > Buf->getBufferSize())
+  StringRef Text = getText();
+  if (ByteOffset > Text.size())
     return std::make_pair(0, 0);
 
-  SMLoc Loc = SMLoc::getFromPointer(Buf->getBufferStart() + ByteOffset);
-  return SrcMgr->getLineAndColumn(Loc, 0);
+  // Clients ask for the location of every diagnostic, so rather than having
+  // SourceMgr scan the buffer for each of them, compute the line starts once.
+  {
+    llvm::sys::ScopedLock L(LineStartsMtx);
+    if (LineStarts.empty()) {
+      LineStarts.push_back(0);
+      for (size_t I = 0, E = Text.size(); I != E; ++I)
+        if (Text[I] == '\n')
+          LineStarts.push_back(I + 1);
+    }
+  }
+
+  auto LineIt = std::upper_bound(LineStarts.begin(), LineStarts.end(),
+                                 ByteOffset);
+  unsigned Line = LineIt - LineStarts.begin();
+  unsigned LineStart = *(LineIt - 1);
+
+  // Match SourceMgr, which also starts a new column after a '\r'.
+  size_t CR = Text.slice(LineStart, ByteOffset).rfind('\r');
+  if (CR != StringRef::npos)
+    LineStart += CR + 1;
+  return std::make_pair(Line, ByteOffset - LineStart + 1);
 }
 
 ReplaceImmutableTextUpdate::ReplaceImmutableTextUpdate(
@@ -123,8 +144,12 @@ EditableTextBuffer::EditableTextBuffer(StringRef Filename, StringRef Text) {
   this->Filename = Filename;
   Root = new ImmutableTextBuffer(Filename, Text, ++Generation);
   CurrUpd = Root;
+  CurrText.reset(new RewriteRope());
+  CurrText->assign(Text.begin(), Text.end());
 }
 
+EditableTextBuffer::~EditableTextBuffer() = default;
+
 ImmutableTextSnapshotRef EditableTextBuffer::getSnapshot() const {
   return new ImmutableTextSnapshot(const_cast<EditableTextBuffer*>(this), Root,
                                    CurrUpd);
@@ -161,6 +186,12 @@ ImmutableTextSnapshotRef EditableTextBuffer::addAtomicUpdate(
 
   refresh();
 
+  if (auto ReplaceUpd = dyn_cast<ReplaceImmutableTextUpdate>(NewUpd)) {
+    CurrText->erase(ReplaceUpd->getByteOffset(), ReplaceUpd->getLength());
+    StringRef Text = ReplaceUpd->getText();
+    CurrText->insert(ReplaceUpd->getByteOffset(), Text.begin(), Text.end());
+  }
+
   assert(CurrUpd->Next == nullptr);
   CurrUpd->Next = NewUpd;
   CurrUpd = NewUpd;
@@ -198,6 +229,25 @@ ImmutableTextBufferRef EditableTextBuffer::getBufferForSnapshot(
     if (auto Buf = dyn_cast<ImmutableTextBuffer>(Next))
       return Buf;
 
+  // The latest snapshot, which is the one that is usually asked for, can be
+  // copied out of the current text directly.
+  {
+    llvm::sys::ScopedLock L(EditMtx);
+    refresh();
+    // Another thread may have materialized it in the meantime.
+    if (Snap.DiffEnd->Next == CurrUpd)
+      if (auto Buf = dyn_cast<ImmutableTextBuffer>(CurrUpd))
+        return Buf;
+    if (Snap.DiffEnd == CurrUpd) {
+      auto MemBuf = getMemBufferFromRope(getFilename(), *CurrText);
+      ImmutableTextBufferRef ImmBuf =
+          new ImmutableTextBuffer(std::move(MemBuf), Snap.getStamp());
+      CurrUpd->Next = ImmBuf;
+      refresh();
+      return ImmBuf;
+    }
+  }
+
   // Check if a buffer was created in the middle of the snapshot updates.
   ImmutableTextBufferRef StartBuf = Snap.BufferStart;
   ImmutableTextUpdateRef Upd = StartBuf;  
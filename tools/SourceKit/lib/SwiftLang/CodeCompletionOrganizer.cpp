@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "CodeCompletionOrganizer.h"
+#include "SourceKit/Support/Concurrency.h"
 #include "SourceKit/Support/FuzzyStringMatcher.h"
 #include "swift/AST/ASTContext.h"
 #include "swift/AST/Module.h"
@@ -18,9 +19,11 @@
 #include "clang/Basic/CharInfo.h"
 #include "clang/Basic/Module.h"
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/ilist.h"
 #include "llvm/ADT/ilist_node.h"
 #include <deque>
+#include <thread>
 
 using namespace SourceKit;
 using namespace CodeCompletion;
@@ -218,7 +221,7 @@ public:
                                 const FilterRules &rules,
                                 Completion *&exactMatch);
 
-  void sort(Options options);
+  void sort(Options options, unsigned limit);
 
   void groupOverloads() {
     groupStemsRecursive(
@@ -296,13 +299,14 @@ void CodeCompletionOrganizer::addCompletionsWithFilter(
                                 exactMatch);
 }
 
-void CodeCompletionOrganizer::groupAndSort(const Options &options) {
+void CodeCompletionOrganizer::groupAndSort(const Options &options,
+                                           unsigned limit) {
   if (options.groupStems)
     impl.groupStems();
   else if (options.groupOverloads)
     impl.groupOverloads();
 
-  impl.sort(options);
+  impl.sort(options, limit);
 }
 
 CodeCompletionViewRef CodeCompletionOrganizer::takeResultsView() {
@@ -506,6 +510,37 @@ bool FilterRules::hideCompletion(SwiftResult *completion, StringRef name, void *
   return hideAll;
 }
 
+/// Calls \p fn with consecutive chunks [begin, end) covering [0, count).
+/// If there are enough elements the chunks are processed concurrently and
+/// this waits for all of them to finish.
+static void forEachChunkConcurrently(
+    unsigned count, llvm::function_ref<void(unsigned, unsigned)> fn) {
+  // Below this size the cost of dispatching outweighs the parallelism.
+  const unsigned minChunkSize = 1024;
+  unsigned numThreads = std::max(std::thread::hardware_concurrency(), 1U);
+  unsigned numChunks =
+      std::min(numThreads, (count + minChunkSize - 1) / minChunkSize);
+  if (numChunks <= 1) {
+    fn(0, count);
+    return;
+  }
+
+  unsigned chunkSize = (count + numChunks - 1) / numChunks;
+  Semaphore done(0);
+  for (unsigned chunk = 1; chunk < numChunks; ++chunk) {
+    unsigned begin = chunk * chunkSize;
+    unsigned end = std::min(begin + chunkSize, count);
+    WorkQueue::dispatchConcurrent([&fn, &done, begin, end] {
+      fn(begin, end);
+      done.signal();
+    }, WorkQueue::Priority::High);
+  }
+  // Process the first chunk on this thread while the others are running.
+  fn(0, std::min(chunkSize, count));
+  for (unsigned chunk = 1; chunk < numChunks; ++chunk)
+    done.wait();
+}
+
 void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
     ArrayRef<Completion *> completions, StringRef filterText, Options options,
     const FilterRules &rules, Completion *&exactMatch) {
@@ -575,7 +610,40 @@ void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
 
   FuzzyStringMatcher pattern(filterText);
   pattern.normalize = true;
-  for (Completion *completion : completions) {
+  bool useFuzzyMatching =
+      options.fuzzyMatching && filterText.size() >= options.minFuzzyLength;
+
+  // Matching and scoring are independent for every candidate and dominate the
+  // cost of filtering large result lists (e.g. global completion with the
+  // whole SDK imported), so compute them up front in parallel. The results
+  // are then added in their original order below.
+  struct CandidateMatch {
+    bool match = false;
+    bool isExactMatch = false;
+    double score = 0.0;
+  };
+  std::vector<CandidateMatch> candidateMatches(completions.size());
+  forEachChunkConcurrently(completions.size(), [&](unsigned begin,
+                                                   unsigned end) {
+    for (unsigned i = begin; i != end; ++i) {
+      StringRef name = completions[i]->getName();
+      CandidateMatch &result = candidateMatches[i];
+      if (useFuzzyMatching)
+        result.match = pattern.matchesCandidate(name);
+      else
+        result.match = name.startswith_lower(filterText);
+      if (!result.match)
+        continue;
+      result.isExactMatch = name.equals_lower(filterText);
+      if (options.fuzzyMatching || result.isExactMatch)
+        result.score = pattern.scoreCandidate(name);
+    }
+  });
+
+  double exactMatchScore =
+      exactMatch ? pattern.scoreCandidate(exactMatch->getName()) : 0.0;
+  for (unsigned i = 0, e = completions.size(); i != e; ++i) {
+    Completion *completion = completions[i];
     if (rules.hideCompletion(completion))
       continue;
 
@@ -589,25 +657,23 @@ void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
         completion->getLiteralKind() != CodeCompletionLiteralKind::NilLiteral)
       continue;
 
-    bool match = false;
-    if (options.fuzzyMatching && filterText.size() >= options.minFuzzyLength) {
-      match = pattern.matchesCandidate(completion->getName());
-    } else {
-      match = completion->getName().startswith_lower(filterText);
-    }
-
-    bool isExactMatch = match && completion->getName().equals_lower(filterText);
+    const CandidateMatch &candidate = candidateMatches[i];
+    bool match = candidate.match;
+    bool isExactMatch = candidate.isExactMatch;
 
     if (isExactMatch) {
       if (!exactMatch) { // first match
         exactMatch = completion;
+        exactMatchScore = candidate.score;
       } else if (completion->getName() != exactMatch->getName()) {
         if (completion->getName() == filterText && // first case-sensitive match
-            exactMatch->getName() != filterText)
+            exactMatch->getName() != filterText) {
           exactMatch = completion;
-        else if (pattern.scoreCandidate(completion->getName()) > // better match
-                 pattern.scoreCandidate(exactMatch->getName()))
+          exactMatchScore = candidate.score;
+        } else if (candidate.score > exactMatchScore) { // better match
           exactMatch = completion;
+          exactMatchScore = candidate.score;
+        }
       }
 
       match = (options.addInnerResults || options.addInnerOperators)
@@ -619,7 +685,7 @@ void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
     if (match) {
       auto wrapper = make_result(completion);
       if (options.fuzzyMatching) {
-        wrapper->matchScore = pattern.scoreCandidate(completion->getName());
+        wrapper->matchScore = candidate.score;
       }
       wrapper->isExactMatch = isExactMatch;
 
@@ -946,8 +1012,12 @@ static void sortTopN(const Options &options, Group *group,
   }
 }
 
+/// Sorts the contents of \p group and of all its subgroups.
+///
+/// If \p limit is non-zero only the first \p limit items of \p group itself
+/// are guaranteed to be in order; the remaining ones are left unsorted.
 static void sortRecursive(const Options &options, Group *group,
-                          bool hasExpectedTypes) {
+                          bool hasExpectedTypes, unsigned limit = 0) {
   // Sort all of the subgroups first, and fill in the bucket for each result.
   auto &contents = group->contents;
   double best = -1.0;
@@ -975,7 +1045,8 @@ static void sortRecursive(const Options &options, Group *group,
     return;
   }
 
-  std::sort(contents.begin(), contents.end(), [=](const std::unique_ptr<Item> &a_, const std::unique_ptr<Item> &b_) {
+  auto compare = [=](const std::unique_ptr<Item> &a_,
+                     const std::unique_ptr<Item> &b_) {
     Item &a = *a_;
     Item &b = *b_;
 
@@ -1023,11 +1094,28 @@ static void sortRecursive(const Options &options, Group *group,
       return true;
 
     return compareResultName(a, b) < 0;
-  });
+  };
+
+  if (!limit || limit >= contents.size()) {
+    std::sort(contents.begin(), contents.end(), compare);
+    return;
+  }
+
+  // Only the first page of results is sent back, so avoid ordering the
+  // (typically much larger) remainder of the list.
+  std::partial_sort(contents.begin(), contents.begin() + limit, contents.end(),
+                    compare);
+
+  // sortTopN() may look past the first page when it starts with literals, so
+  // finish the job in that case.
+  auto firstBucket = getResultBucket(*contents.front(), hasExpectedTypes);
+  if (firstBucket == ResultBucket::Literal ||
+      firstBucket == ResultBucket::LiteralTypeMatch)
+    std::sort(contents.begin() + limit, contents.end(), compare);
 }
 
-void CodeCompletionOrganizer::Impl::sort(Options options) {
-  sortRecursive(options, rootGroup.get(), completionHasExpectedTypes);
+void CodeCompletionOrganizer::Impl::sort(Options options, unsigned limit) {
+  sortRecursive(options, rootGroup.get(), completionHasExpectedTypes, limit);
   if (options.showTopNonLiteralResults != 0)
     sortTopN(options, rootGroup.get(), completionHasExpectedTypes);
 }
@@ -88,7 +88,12 @@ public:
                                 StringRef filterText, const FilterRules &rules,
                                 Completion *&exactMatch);
 
-  void groupAndSort(const Options &options);
+  /// Groups and sorts the results.
+  ///
+  /// If \p limit is non-zero only the first \p limit top-level results are
+  /// guaranteed to be in their final order, which is enough when only that
+  /// many results will be returned.
+  void groupAndSort(const Options &options, unsigned limit = 0);
 
   /// Finishes the results and returns them.
   /// For convenience, this returns a shared_ptr, but it is uniquely referenced.
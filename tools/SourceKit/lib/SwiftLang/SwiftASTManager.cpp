@@ -155,8 +155,9 @@ void InvocationOptions::profile(llvm::FoldingSetNodeID &ID) const {
 
 namespace SourceKit {
   struct ASTUnit::Implementation {
-    const uint64_t Generation;
+    std::atomic<uint64_t> Generation;
     SmallVector<ImmutableTextSnapshotRef, 4> Snapshots;
+    mutable llvm::sys::Mutex SnapshotsMtx;
     EditorDiagConsumer CollectDiagConsumer;
     CompilerInstance CompInst;
     OwnedResolver TypeResolver{ nullptr, nullptr };
@@ -165,6 +166,13 @@ namespace SourceKit {
     Implementation(uint64_t Generation) : Generation(Generation) {}
 
     void consumeAsync(SwiftASTConsumerRef ASTConsumer, ASTUnitRef ASTRef);
+
+    /// Associates the AST with \p NewSnapshots, which must have the same
+    /// contents as the snapshots it was built from, and gives it a new
+    /// generation so that clients refresh the information they derived from
+    /// it.
+    void rebind(ArrayRef<ImmutableTextSnapshotRef> NewSnapshots,
+                uint64_t NewGeneration);
   };
 
   void ASTUnit::Implementation::consumeAsync(SwiftASTConsumerRef ConsumerRef,
@@ -183,6 +191,16 @@ namespace SourceKit {
     });
   }
 
+  void ASTUnit::Implementation::rebind(
+      ArrayRef<ImmutableTextSnapshotRef> NewSnapshots,
+      uint64_t NewGeneration) {
+    {
+      llvm::sys::ScopedLock L(SnapshotsMtx);
+      Snapshots.assign(NewSnapshots.begin(), NewSnapshots.end());
+    }
+    Generation = NewGeneration;
+  }
+
   ASTUnit::ASTUnit(uint64_t Generation) : Impl(*new Implementation(Generation)) {
   }
 
@@ -198,7 +216,8 @@ namespace SourceKit {
     return Impl.Generation;
   }
 
-  ArrayRef<ImmutableTextSnapshotRef> ASTUnit::getSnapshots() const {
+  SmallVector<ImmutableTextSnapshotRef, 4> ASTUnit::getSnapshots() const {
+    llvm::sys::ScopedLock L(Impl.SnapshotsMtx);
     return Impl.Snapshots;
   }
 
@@ -219,6 +238,8 @@ namespace {
 
 typedef uint64_t BufferStamp;
 
+static std::atomic<uint64_t> ASTUnitGeneration{ 0 };
+
 struct FileContent {
   ImmutableTextSnapshotRef Snapshot;
   std::unique_ptr<llvm::MemoryBuffer> Buffer;
@@ -253,8 +274,13 @@ public:
   void getASTUnitAsync(SwiftASTManager::Implementation &MgrImpl,
                        ArrayRef<ImmutableTextSnapshotRef> Snapshots,
                 std::function<void(ASTUnitRef Unit, StringRef Error)> Receiver);
+  /// Returns true if the AST needs to be rebuilt for \p Snapshots.
+  ///
+  /// \param NeedsRebind set to true if some inputs got a new stamp but still
+  /// have the same contents that the existing AST was built from.
   bool shouldRebuild(SwiftASTManager::Implementation &MgrImpl,
-                     ArrayRef<ImmutableTextSnapshotRef> Snapshots);
+                     ArrayRef<ImmutableTextSnapshotRef> Snapshots,
+                     bool &NeedsRebind);
 
   void enqueueConsumer(SwiftASTConsumerRef Consumer, const void *OncePerASTToken);
   std::vector<SwiftASTConsumerRef> popQueuedConsumers();
@@ -274,6 +300,14 @@ private:
   ASTUnitRef createASTUnit(SwiftASTManager::Implementation &MgrImpl,
                            ArrayRef<ImmutableTextSnapshotRef> Snapshots,
                            std::string &Error);
+
+  bool hasSameContents(SwiftASTManager::Implementation &MgrImpl,
+                       ArrayRef<ImmutableTextSnapshotRef> Snapshots,
+                       ArrayRef<BufferStamp> InputStamps,
+                       SmallVectorImpl<ImmutableTextSnapshotRef> &NewSnapshots);
+
+  void rebindAST(ArrayRef<ImmutableTextSnapshotRef> NewSnapshots,
+                 ArrayRef<BufferStamp> NewStamps);
 };
 
 typedef IntrusiveRefCntPtr<ASTProducer> ASTProducerRef;
@@ -317,6 +351,9 @@ struct SwiftASTManager::Implementation {
   WorkQueue ASTBuildQueue{ WorkQueue::Dequeuing::Serial,
                            "sourcekit.swift.ASTBuilding" };
 
+  std::atomic<unsigned> NumASTBuilds{ 0 };
+  std::atomic<unsigned> NumASTReuses{ 0 };
+
   ASTProducerRef getASTProducer(SwiftInvocationRef InvokRef);
   FileContent getFileContent(StringRef FilePath, std::string &Error);
   BufferStamp getBufferStamp(StringRef FilePath);
@@ -501,6 +538,12 @@ void SwiftASTManager::removeCachedAST(SwiftInvocationRef Invok) {
   Impl.ASTCache.remove(Invok->Impl.Key);
 }
 
+void SwiftASTManager::getStatistics(unsigned &NumASTBuilds,
+                                    unsigned &NumASTReuses) {
+  NumASTBuilds = Impl.NumASTBuilds;
+  NumASTReuses = Impl.NumASTReuses;
+}
+
 ASTProducerRef
 SwiftASTManager::Implementation::getASTProducer(SwiftInvocationRef InvokRef) {
   llvm::sys::ScopedLock L(CacheMtx);
@@ -578,7 +621,8 @@ void ASTProducer::getASTUnitAsync(SwiftASTManager::Implementation &MgrImpl,
 ASTUnitRef ASTProducer::getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
                                    ArrayRef<ImmutableTextSnapshotRef> Snapshots,
                                    std::string &Error) {
-  if (!AST || shouldRebuild(MgrImpl, Snapshots)) {
+  bool NeedsRebind = false;
+  if (!AST || shouldRebuild(MgrImpl, Snapshots, NeedsRebind)) {
     bool IsRebuild = AST != nullptr;
     const InvocationOptions &Opts = InvokRef->Impl.Opts;
 
@@ -593,6 +637,7 @@ ASTUnitRef ASTProducer::getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
     }
 
     auto NewAST = createASTUnit(MgrImpl, Snapshots, Error);
+    ++MgrImpl.NumASTBuilds;
     {
       // FIXME: ThreadSafeRefCntPtr is racy.
       llvm::sys::ScopedLock L(Mtx);
@@ -605,6 +650,13 @@ ASTUnitRef ASTProducer::getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
       ASTProducerRef ThisProducer = this;
       MgrImpl.ASTCache.set(InvokRef->Impl.Key, ThisProducer);
     }
+  } else if (NeedsRebind) {
+    ++MgrImpl.NumASTReuses;
+    LOG_FUNC_SECTION(InfoHighPrio) {
+      const InvocationOptions &Opts = InvokRef->Impl.Opts;
+      Log->getOS() << "AST reuse (unchanged contents): ";
+      Log->getOS() << Opts.Invok.getModuleName() << '/' << Opts.PrimaryFile;
+    }
   }
 
   return AST;
@@ -637,8 +689,10 @@ std::vector<SwiftASTConsumerRef> ASTProducer::popQueuedConsumers() {
 }
 
 bool ASTProducer::shouldRebuild(SwiftASTManager::Implementation &MgrImpl,
-                                ArrayRef<ImmutableTextSnapshotRef> Snapshots) {
+                                ArrayRef<ImmutableTextSnapshotRef> Snapshots,
+                                bool &NeedsRebind) {
   const SwiftInvocation::Implementation &Invok = InvokRef->Impl;
+  NeedsRebind = false;
 
   // Check if the inputs changed.
   SmallVector<BufferStamp, 8> InputStamps;
@@ -656,17 +710,106 @@ bool ASTProducer::shouldRebuild(SwiftASTManager::Implementation &MgrImpl,
       InputStamps.push_back(MgrImpl.getBufferStamp(File));
   }
   assert(InputStamps.size() == Invok.Opts.Invok.getInputFilenames().size());
-  if (Stamps != InputStamps)
-    return true;
 
   for (auto &Dependency : DependencyStamps) {
     if (Dependency.second != MgrImpl.getBufferStamp(Dependency.first))
       return true;
   }
 
+  if (Stamps == InputStamps)
+    return false;
+
+  // A new stamp doesn't necessarily mean new contents: an edit may have been
+  // undone, a document may have been re-opened, or a build may have touched
+  // the other files of the module. Rebuilding the AST means re-importing
+  // every module and type-checking the primary file from scratch, so check
+  // the contents before giving up on the existing AST.
+  // FIXME: Any real change still rebuilds the whole AST; reparsing and
+  // re-type-checking only the edited declarations is not implemented.
+  SmallVector<ImmutableTextSnapshotRef, 4> NewSnapshots;
+  if (!hasSameContents(MgrImpl, Snapshots, InputStamps, NewSnapshots))
+    return true;
+
+  rebindAST(NewSnapshots, InputStamps);
+  NeedsRebind = true;
   return false;
 }
 
+bool ASTProducer::hasSameContents(
+    SwiftASTManager::Implementation &MgrImpl,
+    ArrayRef<ImmutableTextSnapshotRef> Snapshots,
+    ArrayRef<BufferStamp> InputStamps,
+    SmallVectorImpl<ImmutableTextSnapshotRef> &NewSnapshots) {
+  const InvocationOptions &Opts = InvokRef->Impl.Opts;
+  SourceManager &SM = AST->getCompilerInstance().getSourceMgr();
+  auto OldSnapshots = AST->getSnapshots();
+
+  for (auto i : indices(Opts.Invok.getInputFilenames())) {
+    auto &File = Opts.Invok.getInputFilenames()[i];
+
+    ImmutableTextSnapshotRef Snapshot;
+    for (auto &Snap : Snapshots) {
+      if (Snap->getFilename() == File) {
+        Snapshot = Snap;
+        break;
+      }
+    }
+
+    if (Stamps[i] == InputStamps[i]) {
+      if (!Snapshot) {
+        for (auto &Snap : OldSnapshots) {
+          if (Snap->getFilename() == File) {
+            Snapshot = Snap;
+            break;
+          }
+        }
+      }
+      if (Snapshot)
+        NewSnapshots.push_back(Snapshot);
+      continue;
+    }
+
+    Optional<unsigned> BufferID = SM.getIDForBufferIdentifier(File);
+    if (!BufferID)
+      return false;
+    StringRef OldText =
+        SM.getLLVMSourceMgr().getMemoryBuffer(*BufferID)->getBuffer();
+
+    if (Snapshot) {
+      if (Snapshot->getBuffer()->getText() != OldText)
+        return false;
+      NewSnapshots.push_back(Snapshot);
+      continue;
+    }
+
+    std::string Error;
+    auto Content = MgrImpl.getFileContent(File, Error);
+    // If the file can't be read we would rebuild as if it was empty.
+    StringRef NewText = Content.Buffer ? Content.Buffer->getBuffer() : "";
+    if (NewText != OldText)
+      return false;
+    if (Content.Snapshot)
+      NewSnapshots.push_back(Content.Snapshot);
+  }
+
+  return true;
+}
+
+void ASTProducer::rebindAST(ArrayRef<ImmutableTextSnapshotRef> NewSnapshots,
+                            ArrayRef<BufferStamp> NewStamps) {
+  Stamps.assign(NewStamps.begin(), NewStamps.end());
+
+  // Consumers that are already queued on the AST still see the snapshots it
+  // was built from; ones that are queued after this see the new snapshots.
+  ASTUnitRef Unit = AST;
+  SmallVector<ImmutableTextSnapshotRef, 4> Snaps(NewSnapshots.begin(),
+                                                 NewSnapshots.end());
+  uint64_t Generation = ++ASTUnitGeneration;
+  Unit->performAsync([Unit, Snaps, Generation] {
+    Unit->Impl.rebind(Snaps, Generation);
+  });
+}
+
 static void collectModuleDependencies(Module *TopMod,
     llvm::SmallPtrSetImpl<Module *> &Visited,
     SmallVectorImpl<std::string> &Filenames) {
@@ -716,8 +859,6 @@ static void collectModuleDependencies(Module *TopMod,
   }
 }
 
-static std::atomic<uint64_t> ASTUnitGeneration{ 0 };
-
 ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
                                       ArrayRef<ImmutableTextSnapshotRef> Snapshots,
                                       std::string &Error) {
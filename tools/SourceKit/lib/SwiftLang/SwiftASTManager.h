@@ -16,6 +16,7 @@
 #include "SwiftInvocation.h"
 #include "SourceKit/Core/LLVM.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include <functional>
 #include <string>
@@ -53,7 +54,9 @@ public:
 
   swift::CompilerInstance &getCompilerInstance() const;
   uint64_t getGeneration() const;
-  ArrayRef<ImmutableTextSnapshotRef> getSnapshots() const;
+  /// Returns the snapshots that the AST corresponds to. An AST may be rebound
+  /// to newer snapshots that have identical contents, so a copy is returned.
+  SmallVector<ImmutableTextSnapshotRef, 4> getSnapshots() const;
   EditorDiagConsumer &getEditorDiagConsumer() const;
   swift::SourceFile &getPrimarySourceFile() const;
 
@@ -119,6 +122,10 @@ public:
 
   void removeCachedAST(SwiftInvocationRef Invok);
 
+  /// The number of ASTs that were built, and the number of times an existing
+  /// AST was reused for inputs with new stamps but unchanged contents.
+  void getStatistics(unsigned &NumASTBuilds, unsigned &NumASTReuses);
+
   struct Implementation;
 
 private:
@@ -1024,6 +1024,10 @@ static void transformAndForwardResults(
   bool hasEarlyInnerResults =
       session->getCompletionKind() == CompletionKind::PostfixExpr;
 
+  // Only the results up to the end of the requested page need to be in their
+  // final order.
+  unsigned sortLimit = maxResults ? resultOffset + maxResults : 0;
+
   if (!hasEarlyInnerResults) {
     organizer.addCompletionsWithFilter(session->getSortedCompletions(),
                                        filterText, rules, exactMatch);
@@ -1052,7 +1056,7 @@ static void transformAndForwardResults(
                                        CodeCompletion::FilterRules(), exactMatch);
   }
 
-  organizer.groupAndSort(options);
+  organizer.groupAndSort(options, sortLimit);
 
   if ((options.addInnerResults || options.addInnerOperators) &&
       exactMatch && exactMatch->getKind() == Completion::Declaration) {
@@ -1111,7 +1115,7 @@ static void transformAndForwardResults(
     CodeCompletion::Options noGroupOpts = options;
     noGroupOpts.groupStems = false;
     noGroupOpts.groupOverloads = false;
-    organizer.groupAndSort(noGroupOpts);
+    organizer.groupAndSort(noGroupOpts, sortLimit);
   }
 
   // Build the final results view.
@@ -161,6 +161,9 @@ static UIdent KindRangeMultiStatement("source.lang.swift.range.multistatement");
 
 static UIdent KindRangeInvalid("source.lang.swift.range.invalid");
 
+static UIdent KindStatNumASTBuilds("source.statistic.num-ast-builds");
+static UIdent KindStatNumASTReuses("source.statistic.num-ast-reuses");
+
 std::unique_ptr<LangSupport>
 SourceKit::createSwiftLangSupport(SourceKit::Context &SKCtx) {
   return std::unique_ptr<LangSupport>(new SwiftLangSupport(SKCtx));
@@ -735,6 +738,18 @@ bool SwiftLangSupport::printAccessorUSR(const AbstractStorageDecl *D,
   return ide::printAccessorUSR(D, AccKind, OS);
 }
 
+void SwiftLangSupport::getStatistics(
+    std::function<void(ArrayRef<Statistic>)> Receiver) {
+  unsigned NumASTBuilds, NumASTReuses;
+  ASTMgr->getStatistics(NumASTBuilds, NumASTReuses);
+  Statistic Stats[] = {
+    { KindStatNumASTBuilds, "# ASTs built", NumASTBuilds },
+    { KindStatNumASTReuses, "# ASTs reused for unchanged contents",
+      NumASTReuses },
+  };
+  Receiver(Stats);
+}
+
 std::string SwiftLangSupport::resolvePathSymlinks(StringRef FilePath) {
   std::string InputPath = FilePath;
   char full_path[MAXPATHLEN];
@@ -405,6 +405,9 @@ public:
 
   void findModuleGroups(StringRef ModuleName, ArrayRef<const char *> Args,
                std::function<void(ArrayRef<StringRef>, StringRef Error)> Receiver) override;
+
+  void getStatistics(
+      std::function<void(ArrayRef<Statistic>)> Receiver) override;
 };
 
 namespace trace {
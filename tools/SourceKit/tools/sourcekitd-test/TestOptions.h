@@ -50,6 +50,7 @@ enum class SourceKitRequest {
   PrintDiags,
   ExtractComment,
   ModuleGroups,
+  Statistics,
 };
 
 struct TestOptions {
@@ -131,6 +131,7 @@ static sourcekitd_uid_t KeySimplified;
 static sourcekitd_uid_t KeyRangeContent;
 
 static sourcekitd_uid_t RequestProtocolVersion;
+static sourcekitd_uid_t RequestStatistics;
 static sourcekitd_uid_t RequestDemangle;
 static sourcekitd_uid_t RequestMangleSimpleClass;
 static sourcekitd_uid_t RequestIndex;
@@ -250,6 +251,7 @@ static int skt_main(int argc, const char **argv) {
   NoteDocUpdate = sourcekitd_uid_get_from_cstr("source.notification.editor.documentupdate");
 
   RequestProtocolVersion = sourcekitd_uid_get_from_cstr("source.request.protocol_version");
+  RequestStatistics = sourcekitd_uid_get_from_cstr("source.request.statistics");
   RequestDemangle = sourcekitd_uid_get_from_cstr("source.request.demangle");
   RequestMangleSimpleClass = sourcekitd_uid_get_from_cstr("source.request.mangle_simple_class");
   RequestIndex = sourcekitd_uid_get_from_cstr("source.request.indexsource");
@@ -453,6 +455,10 @@ static int handleTestInvocation(ArrayRef<const char *> Args,
     sourcekitd_request_dictionary_set_uid(Req, KeyRequest, RequestProtocolVersion);
     break;
 
+  case SourceKitRequest::Statistics:
+    sourcekitd_request_dictionary_set_uid(Req, KeyRequest, RequestStatistics);
+    break;
+
   case SourceKitRequest::DemangleNames:
     prepareDemangleRequest(Req, Opts);
     break;
@@ -799,6 +805,7 @@ static bool handleResponse(sourcekitd_response_t Resp, const TestOptions &Opts,
       break;
 
     case SourceKitRequest::ProtocolVersion:
+    case SourceKitRequest::Statistics:
     case SourceKitRequest::Index:
     case SourceKitRequest::CodeComplete:
     case SourceKitRequest::CodeCompleteOpen:
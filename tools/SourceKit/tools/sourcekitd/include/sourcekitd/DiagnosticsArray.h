@@ -0,0 +1,54 @@
+//===--- DiagnosticsArray.h - -----------------------------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SOURCEKITD_DIAGNOSTICS_ARRAY_H
+#define LLVM_SOURCEKITD_DIAGNOSTICS_ARRAY_H
+
+#include "sourcekitd/Internal.h"
+
+namespace SourceKit {
+  struct DiagnosticEntryInfoBase;
+}
+
+namespace sourcekitd {
+
+VariantFunctions *getVariantFunctionsForDiagnosticsArray();
+VariantFunctions *getVariantFunctionsForDiagnosticRangesArray();
+VariantFunctions *getVariantFunctionsForDiagnosticFixitsArray();
+
+class DiagnosticsArrayBuilder {
+public:
+  DiagnosticsArrayBuilder();
+  ~DiagnosticsArrayBuilder();
+
+  /// Starts a diagnostic; diagnostics started before the matching
+  /// \c endDiagnostic() call become its notes.
+  ///
+  /// \param DiagStage the stage of the diagnostic, or an invalid UIdent if it
+  /// should not be reported.
+  void beginDiagnostic(SourceKit::UIdent Severity, SourceKit::UIdent DiagStage,
+                       const SourceKit::DiagnosticEntryInfoBase &Info);
+
+  void endDiagnostic();
+
+  bool empty() const;
+
+  std::unique_ptr<llvm::MemoryBuffer> createBuffer();
+
+private:
+  struct Implementation;
+  Implementation &impl;
+};
+
+} // end namespace sourcekitd
+
+#endif // LLVM_SOURCEKITD_DIAGNOSTICS_ARRAY_H
@@ -51,6 +51,7 @@ enum class CustomBufferKind {
   InheritedTypesArray,
   DocStructureElementArray,
   AttributesArray,
+  DiagnosticsArray,
 };
 
 class ResponseBuilder {
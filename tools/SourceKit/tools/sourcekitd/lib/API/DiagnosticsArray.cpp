@@ -0,0 +1,457 @@
+//===--- DiagnosticsArray.cpp ---------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "sourcekitd/DiagnosticsArray.h"
+#include "DictionaryKeys.h"
+#include "SourceKit/Core/LangSupport.h"
+#include "SourceKit/Core/LLVM.h"
+#include "SourceKit/Support/UIdent.h"
+#include "sourcekitd/CompactArray.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+using namespace SourceKit;
+using namespace sourcekitd;
+
+namespace {
+struct Node {
+  // Scalars
+  UIdent Severity;
+  UIdent DiagStage;
+  std::string Description;
+  unsigned Offset;
+  unsigned Line;
+  unsigned Column;
+  std::string Filename;
+  // Arrays
+  unsigned RangesOffset;
+  unsigned FixitsOffset;
+
+  // Notes
+  SmallVector<unsigned, 2> noteIndices;
+};
+}
+
+struct DiagnosticsArrayBuilder::Implementation {
+  typedef CompactArrayBuilder<unsigned, unsigned> RangesBuilder;
+  SmallVector<char, 256> rangesBuffer;
+  typedef CompactArrayBuilder<unsigned, unsigned, StringRef> FixitsBuilder;
+  SmallVector<char, 256> fixitsBuffer;
+  typedef CompactArrayBuilder<unsigned> DiagnosticArrayBuilder;
+  SmallVector<char, 256> diagnosticArrayBuffer;
+
+  CompactArrayBuilder<UIdent,              // Severity
+                      UIdent,              // DiagStage
+                      StringRef,           // Description
+                      unsigned,            // Offset
+                      unsigned,            // Line
+                      unsigned,            // Column
+                      Optional<StringRef>, // Filename
+                      unsigned,            // RangesOffset
+                      unsigned,            // FixitsOffset
+                      unsigned             // NotesOffset
+                      >
+      diagnosticsBuilder;
+
+  SmallVector<Node, 4> diagnostics;
+  SmallVector<unsigned, 16> topIndices;
+
+  unsigned addRanges(ArrayRef<std::pair<unsigned, unsigned>> ranges);
+  unsigned addFixits(ArrayRef<DiagnosticEntryInfoBase::Fixit> fixits);
+  unsigned addNotes(ArrayRef<unsigned> indices);
+
+  Implementation();
+};
+
+DiagnosticsArrayBuilder::Implementation::Implementation() {
+  // For each kind of compact array, fill in the first entry in the buffer as
+  // empty so we don't duplicate empty arrays anywhere.
+  RangesBuilder().appendTo(rangesBuffer);
+  FixitsBuilder().appendTo(fixitsBuffer);
+  DiagnosticArrayBuilder().appendTo(diagnosticArrayBuffer);
+}
+
+unsigned DiagnosticsArrayBuilder::Implementation::addRanges(
+    ArrayRef<std::pair<unsigned, unsigned>> ranges) {
+  if (ranges.empty())
+    return 0;
+
+  RangesBuilder builder;
+  for (auto &range : ranges)
+    builder.addEntry(range.first, range.second);
+
+  unsigned offset = rangesBuffer.size();
+  builder.appendTo(rangesBuffer);
+  return offset;
+}
+
+unsigned DiagnosticsArrayBuilder::Implementation::addFixits(
+    ArrayRef<DiagnosticEntryInfoBase::Fixit> fixits) {
+  if (fixits.empty())
+    return 0;
+
+  FixitsBuilder builder;
+  for (auto &fixit : fixits)
+    builder.addEntry(fixit.Offset, fixit.Length, StringRef(fixit.Text));
+
+  unsigned offset = fixitsBuffer.size();
+  builder.appendTo(fixitsBuffer);
+  return offset;
+}
+
+unsigned
+DiagnosticsArrayBuilder::Implementation::addNotes(ArrayRef<unsigned> indices) {
+  if (indices.empty())
+    return 0;
+
+  DiagnosticArrayBuilder builder;
+  for (unsigned value : indices)
+    builder.addEntry(value);
+
+  unsigned offset = diagnosticArrayBuffer.size();
+  builder.appendTo(diagnosticArrayBuffer);
+  return offset;
+}
+
+DiagnosticsArrayBuilder::DiagnosticsArrayBuilder()
+    : impl(*new Implementation()) {}
+DiagnosticsArrayBuilder::~DiagnosticsArrayBuilder() { delete &impl; }
+
+void DiagnosticsArrayBuilder::beginDiagnostic(
+    UIdent Severity, UIdent DiagStage, const DiagnosticEntryInfoBase &Info) {
+  Node node = {
+      Severity,
+      DiagStage,
+      Info.Description,
+      Info.Offset,
+      Info.Line,
+      Info.Column,
+      Info.Filename,
+      impl.addRanges(Info.Ranges),
+      impl.addFixits(Info.Fixits),
+      {}, // notes
+  };
+
+  impl.diagnostics.push_back(std::move(node));
+}
+
+void DiagnosticsArrayBuilder::endDiagnostic() {
+  Node node = impl.diagnostics.pop_back_val();
+  unsigned index = impl.diagnosticsBuilder.size();
+  if (!impl.diagnostics.empty()) {
+    impl.diagnostics.back().noteIndices.push_back(index);
+  } else {
+    impl.topIndices.push_back(index);
+  }
+
+  Optional<StringRef> filename;
+  if (!node.Filename.empty())
+    filename = StringRef(node.Filename);
+
+  impl.diagnosticsBuilder.addEntry(
+      node.Severity, node.DiagStage, StringRef(node.Description), node.Offset,
+      node.Line, node.Column, filename, node.RangesOffset, node.FixitsOffset,
+      impl.addNotes(node.noteIndices));
+}
+
+bool DiagnosticsArrayBuilder::empty() const {
+  return impl.diagnostics.empty() && impl.topIndices.empty();
+}
+
+std::unique_ptr<llvm::MemoryBuffer> DiagnosticsArrayBuilder::createBuffer() {
+  assert(impl.diagnostics.empty());
+  uint64_t topOffset = impl.addNotes(impl.topIndices);
+
+  size_t rangesBufferSize = impl.rangesBuffer.size();
+  size_t fixitsBufferSize = impl.fixitsBuffer.size();
+  size_t diagnosticArrayBufferSize = impl.diagnosticArrayBuffer.size();
+  size_t diagnosticsBufferSize = impl.diagnosticsBuilder.sizeInBytes();
+
+  // Header:
+  // * offset of each section start (4)
+  // * offset of top diagnostic array (relative to diagnostic array section) (1)
+  size_t headerSize = sizeof(uint64_t) * 5;
+
+  auto result = llvm::MemoryBuffer::getNewUninitMemBuffer(
+      rangesBufferSize + fixitsBufferSize + diagnosticArrayBufferSize +
+      diagnosticsBufferSize + headerSize);
+
+  char *start = const_cast<char *>(result->getBufferStart());
+  char *headerPtr = start;
+  char *ptr = start + headerSize;
+
+  auto addBuffer = [&](ArrayRef<char> buffer) {
+    uint64_t offset = ptr - start;
+    memcpy(headerPtr, &offset, sizeof(offset));
+    headerPtr += sizeof(offset);
+    auto bytes = sizeof(buffer[0]) * buffer.size();
+    memcpy(ptr, buffer.data(), bytes);
+    ptr += bytes;
+  };
+  addBuffer(impl.diagnosticArrayBuffer);
+  SmallVector<char, 256> diagnosticsBuffer;
+  impl.diagnosticsBuilder.appendTo(diagnosticsBuffer);
+  addBuffer(diagnosticsBuffer);
+  addBuffer(impl.rangesBuffer);
+  addBuffer(impl.fixitsBuffer);
+
+  assert(ptr == result->getBufferEnd());
+  assert(headerPtr == start + (headerSize - sizeof(topOffset)));
+  memcpy(headerPtr, &topOffset, sizeof(topOffset));
+
+  return result;
+}
+
+namespace {
+struct OutNode {
+  // Scalars
+  sourcekitd_uid_t Severity;
+  sourcekitd_uid_t DiagStage;
+  const char *Description;
+  unsigned Offset;
+  unsigned Line;
+  unsigned Column;
+  const char *Filename;
+  // Arrays
+  unsigned RangesOffset;
+  unsigned FixitsOffset;
+  unsigned NotesOffset;
+};
+
+class DiagnosticsArrayReader {
+public:
+  DiagnosticsArrayReader(void *buffer) : buffer(buffer) {}
+
+  OutNode readDiagnostic(size_t index);
+  CompactArrayReader<unsigned> readDiagnosticArray(size_t offset);
+
+  void *getRangesBuffer(size_t offset) const {
+    return (char *)getRangesBufferStart() + offset;
+  }
+  void *getFixitsBuffer(size_t offset) const {
+    return (char *)getFixitsBufferStart() + offset;
+  }
+
+private:
+  void *getDiagnosticArrayBufferStart() const { return getBufferStart(0); }
+  void *getDiagnosticsBufferStart() const { return getBufferStart(1); }
+  void *getRangesBufferStart() const { return getBufferStart(2); }
+  void *getFixitsBufferStart() const { return getBufferStart(3); }
+  size_t getTopDiagnosticArrayOffset() const { return getHeaderValue(4); }
+
+  uint64_t getHeaderValue(unsigned index) const;
+  void *getBufferStart(unsigned index) const;
+
+private:
+  void *buffer;
+
+  typedef CompactArrayReader<sourcekitd_uid_t, // Severity
+                             sourcekitd_uid_t, // DiagStage
+                             const char *,     // Description
+                             unsigned,         // Offset
+                             unsigned,         // Line
+                             unsigned,         // Column
+                             const char *,     // Filename
+                             unsigned,         // RangesOffset
+                             unsigned,         // FixitsOffset
+                             unsigned          // NotesOffset
+                             >
+      DiagnosticReader;
+};
+}
+
+OutNode DiagnosticsArrayReader::readDiagnostic(size_t index) {
+  OutNode result;
+  DiagnosticReader reader(getDiagnosticsBufferStart());
+  reader.readEntries(index, result.Severity, result.DiagStage,
+                     result.Description, result.Offset, result.Line,
+                     result.Column, result.Filename, result.RangesOffset,
+                     result.FixitsOffset, result.NotesOffset);
+  return result;
+}
+
+CompactArrayReader<unsigned>
+DiagnosticsArrayReader::readDiagnosticArray(size_t offset) {
+  if (offset == ~size_t(0))
+    offset = getTopDiagnosticArrayOffset();
+  void *arrayBuffer = (char *)getDiagnosticArrayBufferStart() + offset;
+  return CompactArrayReader<unsigned>(arrayBuffer);
+}
+
+void *DiagnosticsArrayReader::getBufferStart(unsigned index) const {
+  return (char *)buffer + getHeaderValue(index);
+}
+
+uint64_t DiagnosticsArrayReader::getHeaderValue(unsigned index) const {
+  uint64_t headerField;
+  memcpy(&headerField, (uint64_t*)buffer + index, sizeof(headerField));
+  return headerField;
+}
+
+#define APPLY(K, Ty, Field)                                                    \
+  do {                                                                         \
+    sourcekitd_uid_t key = SKDUIDFromUIdent(K);                                \
+    sourcekitd_variant_t var = make##Ty##Variant(Field);                       \
+    if (!applier(key, var))                                                    \
+      return false;                                                            \
+  } while (0)
+
+namespace {
+struct RangeReader {
+  typedef CompactArrayReader<unsigned, unsigned> CompactArrayReaderTy;
+
+  static bool
+  dictionary_apply(void *buffer, size_t index,
+                   sourcekitd_variant_dictionary_applier_t applier) {
+
+    CompactArrayReaderTy reader(buffer);
+    unsigned offset;
+    unsigned length;
+    reader.readEntries(index, offset, length);
+    APPLY(KeyOffset, Int, offset);
+    APPLY(KeyLength, Int, length);
+    return true;
+  }
+};
+
+struct FixitReader {
+  typedef CompactArrayReader<unsigned, unsigned, const char *>
+      CompactArrayReaderTy;
+
+  static bool
+  dictionary_apply(void *buffer, size_t index,
+                   sourcekitd_variant_dictionary_applier_t applier) {
+
+    CompactArrayReaderTy reader(buffer);
+    unsigned offset;
+    unsigned length;
+    const char *text;
+    reader.readEntries(index, offset, length, text);
+    APPLY(KeyOffset, Int, offset);
+    APPLY(KeyLength, Int, length);
+    APPLY(KeySourceText, String, text);
+    return true;
+  }
+};
+
+struct DiagnosticReader {
+  static bool
+  dictionary_apply(void *buffer, size_t index,
+                   sourcekitd_variant_dictionary_applier_t applier) {
+    auto reader = DiagnosticsArrayReader(buffer);
+    auto node = reader.readDiagnostic(index);
+
+    APPLY(KeySeverity, UID, node.Severity);
+    if (node.DiagStage)
+      APPLY(KeyDiagnosticStage, UID, node.DiagStage);
+    APPLY(KeyDescription, String, node.Description);
+    if (node.Line != 0) {
+      APPLY(KeyLine, Int, node.Line);
+      APPLY(KeyColumn, Int, node.Column);
+    } else {
+      APPLY(KeyOffset, Int, node.Offset);
+    }
+    if (node.Filename)
+      APPLY(KeyFilePath, String, node.Filename);
+
+#define APPLY_ARRAY(Kind, Buf, Key, Off)                                       \
+  do {                                                                         \
+    sourcekitd_uid_t key = SKDUIDFromUIdent(Key);                              \
+    sourcekitd_variant_t var = {                                               \
+        {(uintptr_t)getVariantFunctionsFor##Kind##Array(), (uintptr_t)Buf,     \
+         Off}};                                                                \
+    if (!applier(key, var))                                                    \
+      return false;                                                            \
+  } while (0)
+
+    if (node.RangesOffset) {
+      void *buf = reader.getRangesBuffer(node.RangesOffset);
+      APPLY_ARRAY(DiagnosticRanges, buf, KeyRanges, 0);
+    }
+    if (node.FixitsOffset) {
+      void *buf = reader.getFixitsBuffer(node.FixitsOffset);
+      APPLY_ARRAY(DiagnosticFixits, buf, KeyFixits, 0);
+    }
+    if (node.NotesOffset) {
+      APPLY_ARRAY(Diagnostics, buffer, KeyDiagnostics, node.NotesOffset);
+    }
+    return true;
+  }
+};
+
+// data[0] = DiagnosticsArrayFuncs::funcs
+// data[1] = buffer for DiagnosticsArrayReader
+// data[2] = diagnostic array offset
+struct DiagnosticsArrayFuncs {
+  static sourcekitd_variant_type_t get_type(sourcekitd_variant_t var) {
+    return SOURCEKITD_VARIANT_TYPE_ARRAY;
+  }
+
+  static size_t array_get_count(sourcekitd_variant_t array) {
+    void *buffer = (void *)array.data[1];
+    size_t offset = array.data[2];
+    return DiagnosticsArrayReader(buffer)
+        .readDiagnosticArray(offset)
+        .getCount();
+  }
+
+  static sourcekitd_variant_t array_get_value(sourcekitd_variant_t array,
+                                              size_t index) {
+    void *buffer = (void *)array.data[1];
+    size_t offset = array.data[2];
+
+    auto reader = DiagnosticsArrayReader(buffer).readDiagnosticArray(offset);
+    assert(index < reader.getCount());
+    unsigned diagnosticIndex;
+    reader.readEntries(index, diagnosticIndex);
+
+    return {{(uintptr_t)&CompactVariantFuncs<DiagnosticReader>::Funcs,
+             (uintptr_t)buffer, diagnosticIndex}};
+  }
+
+  static VariantFunctions funcs;
+};
+} // end anonymous namespace
+
+VariantFunctions DiagnosticsArrayFuncs::funcs = {
+    get_type,
+    nullptr /*AnnotArray_array_apply*/,
+    nullptr /*AnnotArray_array_get_bool*/,
+    array_get_count,
+    nullptr /*AnnotArray_array_get_int64*/,
+    nullptr /*AnnotArray_array_get_string*/,
+    nullptr /*AnnotArray_array_get_uid*/,
+    array_get_value,
+    nullptr /*AnnotArray_bool_get_value*/,
+    nullptr /*AnnotArray_dictionary_apply*/,
+    nullptr /*AnnotArray_dictionary_get_bool*/,
+    nullptr /*AnnotArray_dictionary_get_int64*/,
+    nullptr /*AnnotArray_dictionary_get_string*/,
+    nullptr /*AnnotArray_dictionary_get_value*/,
+    nullptr /*AnnotArray_dictionary_get_uid*/,
+    nullptr /*AnnotArray_string_get_length*/,
+    nullptr /*AnnotArray_string_get_ptr*/,
+    nullptr /*AnnotArray_int64_get_value*/,
+    nullptr /*AnnotArray_uid_get_value*/
+};
+
+VariantFunctions *sourcekitd::getVariantFunctionsForDiagnosticRangesArray() {
+  return &CompactArrayFuncs<RangeReader>::Funcs;
+}
+
+VariantFunctions *sourcekitd::getVariantFunctionsForDiagnosticFixitsArray() {
+  return &CompactArrayFuncs<FixitReader>::Funcs;
+}
+
+VariantFunctions *sourcekitd::getVariantFunctionsForDiagnosticsArray() {
+  return &DiagnosticsArrayFuncs::funcs;
+}
@@ -120,6 +120,7 @@ extern SourceKit::UIdent KeyTypeInterface;
 extern SourceKit::UIdent KeyTypeUsr;
 extern SourceKit::UIdent KeyContainerTypeUsr;
 extern SourceKit::UIdent KeyModuleGroups;
+extern SourceKit::UIdent KeyValue;
 
 extern SourceKit::UIdent KeyRangeContent;
 /// \brief Used for determining the printing order of dictionary keys.
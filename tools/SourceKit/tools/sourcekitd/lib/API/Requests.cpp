@@ -12,6 +12,7 @@
 
 #include "DictionaryKeys.h"
 #include "sourcekitd/CodeCompletionResultsArray.h"
+#include "sourcekitd/DiagnosticsArray.h"
 #include "sourcekitd/DocStructureArray.h"
 #include "sourcekitd/DocSupportAnnotationArray.h"
 #include "sourcekitd/TokenAnnotationsArray.h"
@@ -63,6 +64,7 @@ public:
 static LazySKDUID RequestProtocolVersion("source.request.protocol_version");
 
 static LazySKDUID RequestCrashWithExit("source.request.crash_exit");
+static LazySKDUID RequestStatistics("source.request.statistics");
 
 static LazySKDUID RequestDemangle("source.request.demangle");
 static LazySKDUID RequestMangleSimpleClass("source.request.mangle_simple_class");
@@ -246,8 +248,8 @@ editorFindModuleGroups(StringRef ModuleName, ArrayRef<const char *> Args);
 
 static bool isSemanticEditorDisabled();
 
-static void fillDictionaryForDiagnosticInfo(
-    ResponseBuilder::Dictionary Elem, const DiagnosticEntryInfoBase &Info);
+static void addDiagnostic(DiagnosticsArrayBuilder &Builder,
+                          const DiagnosticEntryInfo &Info, UIdent DiagStage);
 
 static void handleRequestImpl(sourcekitd_object_t Req,
                               ResponseReceiver Receiver);
@@ -330,6 +332,22 @@ void handleRequestImpl(sourcekitd_object_t ReqObj, ResponseReceiver Rec) {
     ::exit(1);
   }
 
+  if (ReqUID == RequestStatistics) {
+    LangSupport &Lang = getGlobalContext().getSwiftLangSupport();
+    Lang.getStatistics([&](ArrayRef<Statistic> Stats) {
+      ResponseBuilder RB;
+      auto Results = RB.getDictionary().setArray(KeyResults);
+      for (auto &Stat : Stats) {
+        auto Entry = Results.appendDictionary();
+        Entry.set(KeyKind, Stat.Kind);
+        Entry.set(KeyDescription, Stat.Description);
+        Entry.set(KeyValue, Stat.Value);
+      }
+      Rec(RB.createResponse());
+    });
+    return;
+  }
+
   if (ReqUID == RequestDemangle) {
     SmallVector<const char *, 8> MangledNames;
     bool Failed = Req.getStringArray(KeyNames, MangledNames, /*isOptional=*/true);
@@ -986,7 +1004,7 @@ class SKDocConsumer : public DocInfoConsumer {
   SmallVector<Entity, 6> EntitiesStack;
 
   ResponseBuilder::Dictionary TopDict;
-  ResponseBuilder::Array Diags;
+  DiagnosticsArrayBuilder Diags;
 
   DocSupportAnnotationArrayBuilder AnnotationsBuilder;
 
@@ -1019,6 +1037,11 @@ public:
     TopDict.setCustomBuffer(KeyAnnotations,
         CustomBufferKind::DocSupportAnnotationArray,
         AnnotationsBuilder.createBuffer());
+    if (!Diags.empty()) {
+      TopDict.setCustomBuffer(KeyDiagnostics,
+          CustomBufferKind::DiagnosticsArray,
+          Diags.createBuffer());
+    }
     return RespBuilder.createResponse();
   }
 
@@ -1267,33 +1290,7 @@ bool SKDocConsumer::finishSourceEntity(UIdent Kind) {
 }
 
 bool SKDocConsumer::handleDiagnostic(const DiagnosticEntryInfo &Info) {
-  ResponseBuilder::Array &Arr = Diags;
-  if (Arr.isNull())
-    Arr = TopDict.setArray(KeyDiagnostics);
-
-  auto Elem = Arr.appendDictionary();
-  UIdent SeverityUID;
-  switch (Info.Severity) {
-  case DiagnosticSeverityKind::Warning:
-    SeverityUID = DiagKindWarning;
-    break;
-  case DiagnosticSeverityKind::Error:
-    SeverityUID = DiagKindError;
-    break;
-  }
-
-  Elem.set(KeySeverity, SeverityUID);
-  fillDictionaryForDiagnosticInfo(Elem, Info);
-
-  if (!Info.Notes.empty()) {
-    auto NotesArr = Elem.setArray(KeyDiagnostics);
-    for (auto &NoteDiag : Info.Notes) {
-      auto NoteElem = NotesArr.appendDictionary();
-      NoteElem.set(KeySeverity, DiagKindNote);
-      fillDictionaryForDiagnosticInfo(NoteElem, NoteDiag);
-    }
-  }
-
+  addDiagnostic(Diags, Info, /*DiagStage=*/UIdent());
   return true;
 }
 
@@ -1740,8 +1737,8 @@ class SKEditorConsumer : public EditorConsumer {
   DocStructureArrayBuilder DocStructure;
   TokenAnnotationsArrayBuilder SyntaxMap;
   TokenAnnotationsArrayBuilder SemanticAnnotations;
+  DiagnosticsArrayBuilder Diagnostics;
 
-  ResponseBuilder::Array Diags;
   sourcekitd_response_t Error = nullptr;
 
   bool EnableSyntaxMap;
@@ -1959,6 +1956,10 @@ sourcekitd_response_t SKEditorConsumer::createResponse() {
     Dict.setCustomBuffer(KeySubStructure, CustomBufferKind::DocStructureArray,
                          DocStructure.createBuffer());
   }
+  if (!Diagnostics.empty()) {
+    Dict.setCustomBuffer(KeyDiagnostics, CustomBufferKind::DiagnosticsArray,
+                         Diagnostics.createBuffer());
+  }
 
   return RespBuilder.createResponse();
 }
@@ -2048,37 +2049,24 @@ bool SKEditorConsumer::recordFormattedText(StringRef Text) {
   return true;
 }
 
-static void fillDictionaryForDiagnosticInfo(
-    ResponseBuilder::Dictionary Elem, const DiagnosticEntryInfoBase &Info) {
-
-  Elem.set(KeyDescription, Info.Description);
-  if (Info.Line != 0) {
-    Elem.set(KeyLine, Info.Line);
-    Elem.set(KeyColumn, Info.Column);
-  } else {
-    Elem.set(KeyOffset, Info.Offset);
-  }
-  if (!Info.Filename.empty())
-    Elem.set(KeyFilePath, Info.Filename);
-
-  if (!Info.Ranges.empty()) {
-    auto RangesArr = Elem.setArray(KeyRanges);
-    for (auto R : Info.Ranges) {
-      auto RangeElem = RangesArr.appendDictionary();
-      RangeElem.set(KeyOffset, R.first);
-      RangeElem.set(KeyLength, R.second);
-    }
+static void addDiagnostic(DiagnosticsArrayBuilder &Builder,
+                          const DiagnosticEntryInfo &Info, UIdent DiagStage) {
+  UIdent SeverityUID;
+  switch (Info.Severity) {
+  case DiagnosticSeverityKind::Warning:
+    SeverityUID = DiagKindWarning;
+    break;
+  case DiagnosticSeverityKind::Error:
+    SeverityUID = DiagKindError;
+    break;
   }
 
-  if (!Info.Fixits.empty()) {
-    auto FixitsArr = Elem.setArray(KeyFixits);
-    for (auto F : Info.Fixits) {
-      auto FixitElem = FixitsArr.appendDictionary();
-      FixitElem.set(KeyOffset, F.Offset);
-      FixitElem.set(KeyLength, F.Length);
-      FixitElem.set(KeySourceText, F.Text);
-    }
+  Builder.beginDiagnostic(SeverityUID, DiagStage, Info);
+  for (auto &NoteDiag : Info.Notes) {
+    Builder.beginDiagnostic(DiagKindNote, UIdent(), NoteDiag);
+    Builder.endDiagnostic();
   }
+  Builder.endDiagnostic();
 }
 
 bool SKEditorConsumer::setDiagnosticStage(UIdent DiagStage) {
@@ -2091,34 +2079,7 @@ bool SKEditorConsumer::handleDiagnostic(const DiagnosticEntryInfo &Info,
   if (!EnableDiagnostics)
     return true;
 
-  ResponseBuilder::Array &Arr = Diags;
-  if (Arr.isNull())
-    Arr = Dict.setArray(KeyDiagnostics);
-
-  auto Elem = Arr.appendDictionary();
-  UIdent SeverityUID;
-  switch (Info.Severity) {
-  case DiagnosticSeverityKind::Warning:
-    SeverityUID = DiagKindWarning;
-    break;
-  case DiagnosticSeverityKind::Error:
-    SeverityUID = DiagKindError;
-    break;
-  }
-
-  Elem.set(KeySeverity, SeverityUID);
-  Elem.set(KeyDiagnosticStage, DiagStage);
-  fillDictionaryForDiagnosticInfo(Elem, Info);
-
-  if (!Info.Notes.empty()) {
-    auto NotesArr = Elem.setArray(KeyDiagnostics);
-    for (auto &NoteDiag : Info.Notes) {
-      auto NoteElem = NotesArr.appendDictionary();
-      NoteElem.set(KeySeverity, DiagKindNote);
-      fillDictionaryForDiagnosticInfo(NoteElem, NoteDiag);
-    }
-  }
-
+  addDiagnostic(Diagnostics, Info, DiagStage);
   return true;
 }
 
@@ -135,6 +135,7 @@ UIdent sourcekitd::KeyTypeInterface("key.typeinterface");
 UIdent sourcekitd::KeyTypeUsr("key.typeusr");
 UIdent sourcekitd::KeyContainerTypeUsr("key.containertypeusr");
 UIdent sourcekitd::KeyModuleGroups("key.modulegroups");
+UIdent sourcekitd::KeyValue("key.value");
 
 /// \brief Order for the keys to use when emitting the debug description of
 /// dictionaries.
@@ -229,6 +230,7 @@ static UIdent *OrderedKeys[] = {
   &KeyTypeUsr,
   &KeyContainerTypeUsr,
   &KeyModuleGroups,
+  &KeyValue,
 };
 
 static unsigned findPrintOrderForDictKey(UIdent Key) {
@@ -14,6 +14,8 @@
 #include "sourcekitd/sourcekitd.h"
 #include "sourcekitd/Internal.h"
 #include "sourcekitd/CodeCompletionResultsArray.h"
+#include "sourcekitd/DiagnosticsArray.h"
+#include "sourcekitd/DocStructureArray.h"
 #include "sourcekitd/DocSupportAnnotationArray.h"
 #include "sourcekitd/TokenAnnotationsArray.h"
 #include "sourcekitd/Logging.h"
@@ -249,6 +251,11 @@ public:
       case CustomBufferKind::TokenAnnotationsArray:
       case CustomBufferKind::DocSupportAnnotationArray:
       case CustomBufferKind::CodeCompletionResultsArray:
+      case CustomBufferKind::DocStructureArray:
+      case CustomBufferKind::InheritedTypesArray:
+      case CustomBufferKind::DocStructureElementArray:
+      case CustomBufferKind::AttributesArray:
+      case CustomBufferKind::DiagnosticsArray:
         return SOURCEKITD_VARIANT_TYPE_ARRAY;
     }
     llvm::report_fatal_error("sourcekitd object did not resolve to a known type");
@@ -927,6 +934,21 @@ static sourcekitd_variant_t variantFromSKDObject(SKDObjectRef Object) {
       case CustomBufferKind::CodeCompletionResultsArray:
         return {{ (uintptr_t)getVariantFunctionsForCodeCompletionResultsArray(),
           (uintptr_t)DataObject->getDataPtr(), 0 }};
+      case CustomBufferKind::DocStructureArray:
+        return {{ (uintptr_t)getVariantFunctionsForDocStructureArray(),
+          (uintptr_t)DataObject->getDataPtr(), ~size_t(0) }};
+      case CustomBufferKind::InheritedTypesArray:
+        return {{ (uintptr_t)getVariantFunctionsForInheritedTypesArray(),
+          (uintptr_t)DataObject->getDataPtr(), 0 }};
+      case CustomBufferKind::DocStructureElementArray:
+        return {{ (uintptr_t)getVariantFunctionsForDocStructureElementArray(),
+          (uintptr_t)DataObject->getDataPtr(), 0 }};
+      case CustomBufferKind::AttributesArray:
+        return {{ (uintptr_t)getVariantFunctionsForAttributesArray(),
+          (uintptr_t)DataObject->getDataPtr(), 0 }};
+      case CustomBufferKind::DiagnosticsArray:
+        return {{ (uintptr_t)getVariantFunctionsForDiagnosticsArray(),
+          (uintptr_t)DataObject->getDataPtr(), ~size_t(0) }};
     }
   }
   
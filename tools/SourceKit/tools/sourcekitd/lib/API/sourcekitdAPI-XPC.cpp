@@ -12,6 +12,7 @@
 
 #include "DictionaryKeys.h"
 #include "sourcekitd/CodeCompletionResultsArray.h"
+#include "sourcekitd/DiagnosticsArray.h"
 #include "sourcekitd/DocStructureArray.h"
 #include "sourcekitd/DocSupportAnnotationArray.h"
 #include "sourcekitd/TokenAnnotationsArray.h"
@@ -598,6 +599,7 @@ static sourcekitd_variant_type_t XPCVar_get_type(sourcekitd_variant_t var) {
     case CustomBufferKind::InheritedTypesArray:
     case CustomBufferKind::DocStructureElementArray:
     case CustomBufferKind::AttributesArray:
+    case CustomBufferKind::DiagnosticsArray:
       return SOURCEKITD_VARIANT_TYPE_ARRAY;
     }
   }
@@ -746,6 +748,9 @@ static sourcekitd_variant_t variantFromXPCObject(xpc_object_t obj) {
     case CustomBufferKind::AttributesArray:
       return {{ (uintptr_t)getVariantFunctionsForAttributesArray(),
                 (uintptr_t)CUSTOM_BUF_START(obj), 0 }};
+    case CustomBufferKind::DiagnosticsArray:
+      return {{ (uintptr_t)getVariantFunctionsForDiagnosticsArray(),
+                (uintptr_t)CUSTOM_BUF_START(obj), ~size_t(0) }};
     }
   }
 
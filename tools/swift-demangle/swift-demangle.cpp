@@ -15,16 +15,25 @@
 //===----------------------------------------------------------------------===//
 
 #include "swift/Basic/DemangleWrappers.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Regex.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdlib>
+#include <functional>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
 #include <unistd.h>
 #else
@@ -55,6 +64,26 @@ static llvm::cl::opt<bool>
 Simplified("simplified",
            llvm::cl::desc("Don't display module names or implicit self types"));
 
+static llvm::cl::opt<unsigned>
+BenchmarkIterations("benchmark",
+           llvm::cl::desc("Demangle the input symbols <N> times and report the throughput instead of printing them"),
+           llvm::cl::value_desc("N"), llvm::cl::init(0));
+
+static llvm::cl::opt<unsigned>
+NumThreads("j",
+           llvm::cl::desc("Demangle the input with <N> threads, preserving the order of lines"),
+           llvm::cl::value_desc("N"), llvm::cl::init(1));
+
+static llvm::cl::opt<std::string>
+InputFilename("input-file",
+           llvm::cl::desc("Read the text to demangle from <file> instead of stdin"),
+           llvm::cl::value_desc("file"));
+
+static llvm::cl::opt<unsigned>
+ChunkSize("chunk-size",
+           llvm::cl::desc("The number of bytes of input each thread demangles at a time"),
+           llvm::cl::init(1 << 20), llvm::cl::Hidden);
+
 static llvm::cl::list<std::string>
 InputNames(llvm::cl::Positional, llvm::cl::desc("[mangled name...]"),
                llvm::cl::ZeroOrMore);
@@ -70,6 +99,7 @@ static llvm::StringRef substrAfter(llvm::StringRef whole,
 }
 
 static void demangle(llvm::raw_ostream &os, llvm::StringRef name,
+                     swift::Demangle::Context &ctx,
                      const swift::Demangle::DemangleOptions &options) {
   bool hadLeadingUnderscore = false;
   if (name.startswith("__")) {
@@ -77,34 +107,35 @@ static void demangle(llvm::raw_ostream &os, llvm::StringRef name,
     name = name.substr(1);
   }
   swift::Demangle::NodePointer pointer =
-      swift::demangle_wrappers::demangleSymbolAsNode(name);
+      swift::demangle_wrappers::demangleSymbolAsNode(ctx, name);
   if (ExpandMode || TreeOnly) {
-    llvm::outs() << "Demangling for " << name << '\n';
-    swift::demangle_wrappers::NodeDumper(pointer).print(llvm::outs());
+    os << "Demangling for " << name << '\n';
+    swift::demangle_wrappers::NodeDumper(pointer).print(os);
   }
   if (RemangleMode) {
-    if (hadLeadingUnderscore) llvm::outs() << '_';
+    if (hadLeadingUnderscore) os << '_';
     // Just reprint the original mangled name if it didn't demangle.
     // This makes it easier to share the same database between the
     // mangling and demangling tests.
     if (!pointer) {
-      llvm::outs() << name;
+      os << name;
     } else {
-      llvm::outs() << swift::Demangle::mangleNode(pointer);
+      os << swift::Demangle::mangleNode(pointer);
     }
     return;
   }
   if (!TreeOnly) {
     std::string string = swift::Demangle::nodeToString(pointer, options);
     if (!CompactMode)
-      llvm::outs() << name << " ---> ";
-    llvm::outs() << (string.empty() ? name : llvm::StringRef(string));
+      os << name << " ---> ";
+    os << (string.empty() ? name : llvm::StringRef(string));
   }
 }
 
 static int demangleSTDIN(const swift::Demangle::DemangleOptions &options) {
   // This doesn't handle Unicode symbols, but maybe that's okay.
   llvm::Regex maybeSymbol("_T[_a-zA-Z0-9$]+");
+  swift::Demangle::Context ctx;
 
   while (true) {
     char *inputLine = NULL;
@@ -121,7 +152,7 @@ static int demangleSTDIN(const swift::Demangle::DemangleOptions &options) {
     llvm::SmallVector<llvm::StringRef, 1> matches;
     while (maybeSymbol.match(inputContents, &matches)) {
       llvm::outs() << substrBefore(inputContents, matches.front());
-      demangle(llvm::outs(), matches.front(), options);
+      demangle(llvm::outs(), matches.front(), ctx, options);
       inputContents = substrAfter(inputContents, matches.front());
     }
 
@@ -132,6 +163,204 @@ static int demangleSTDIN(const swift::Demangle::DemangleOptions &options) {
   return EXIT_SUCCESS;
 }
 
+namespace {
+/// Demangles the symbols in parts of the input, remembering the output for
+/// the symbols it has seen before.
+class BatchWorker {
+  const swift::Demangle::DemangleOptions &Options;
+  swift::Demangle::Context Ctx;
+  llvm::Regex MaybeSymbol{"_T[_a-zA-Z0-9$]+"};
+  llvm::StringMap<std::string> Cache;
+
+  /// The cache is dropped when it gets bigger than this, so that a huge
+  /// input with few repeated symbols does not use unbounded memory.
+  static const unsigned MaxCacheEntries = 1 << 16;
+
+public:
+  /// The demangled text of the last part that was processed.
+  std::string Output;
+
+  explicit BatchWorker(const swift::Demangle::DemangleOptions &options)
+    : Options(options) {}
+
+  void process(llvm::StringRef inputContents) {
+    Output.clear();
+    llvm::raw_string_ostream os(Output);
+    llvm::SmallVector<llvm::StringRef, 1> matches;
+    while (MaybeSymbol.match(inputContents, &matches)) {
+      llvm::StringRef symbol = matches.front();
+      os << substrBefore(inputContents, symbol);
+
+      auto known = Cache.find(symbol);
+      if (known != Cache.end()) {
+        os << known->getValue();
+      } else {
+        std::string demangled;
+        llvm::raw_string_ostream symbolOS(demangled);
+        demangle(symbolOS, symbol, Ctx, Options);
+        symbolOS.flush();
+        os << demangled;
+        if (Cache.size() >= MaxCacheEntries)
+          Cache.clear();
+        Cache[symbol] = std::move(demangled);
+      }
+      inputContents = substrAfter(inputContents, symbol);
+    }
+    os << inputContents;
+    os.flush();
+  }
+};
+} // end anonymous namespace
+
+/// Demangles the symbols in \p input, splitting it into chunks of whole lines
+/// that are processed by \p workers in parallel. The output is written in the
+/// order of the input.
+static void
+demangleBatch(llvm::raw_ostream &os, llvm::StringRef input,
+              llvm::ArrayRef<std::unique_ptr<BatchWorker>> workers) {
+  auto nextChunk = [&]() -> llvm::StringRef {
+    size_t end = input.find('\n', std::min<size_t>(ChunkSize, input.size()));
+    end = (end == llvm::StringRef::npos) ? input.size() : end + 1;
+    llvm::StringRef chunk = input.substr(0, end);
+    input = input.substr(end);
+    return chunk;
+  };
+
+  while (!input.empty()) {
+    llvm::SmallVector<llvm::StringRef, 8> chunks;
+    while (chunks.size() < workers.size() && !input.empty())
+      chunks.push_back(nextChunk());
+
+    // Demangle the first chunk on this thread while the others run.
+    std::vector<std::thread> threads;
+    for (unsigned i = 1, e = chunks.size(); i != e; ++i) {
+      BatchWorker *worker = workers[i].get();
+      llvm::StringRef chunk = chunks[i];
+      threads.emplace_back([worker, chunk] { worker->process(chunk); });
+    }
+    workers[0]->process(chunks[0]);
+    for (auto &thread : threads)
+      thread.join();
+
+    for (unsigned i = 0, e = chunks.size(); i != e; ++i)
+      os << workers[i]->Output;
+  }
+}
+
+static int demangleInputBatch(const swift::Demangle::DemangleOptions &options) {
+  // Large input files are mapped rather than read.
+  auto input = InputFilename.empty()
+      ? llvm::MemoryBuffer::getSTDIN()
+      : llvm::MemoryBuffer::getFile(InputFilename, /*FileSize=*/-1,
+                                    /*RequiresNullTerminator=*/false);
+  if (!input) {
+    llvm::errs() << "error: cannot read "
+                 << (InputFilename.empty() ? "stdin" : InputFilename.c_str())
+                 << ": " << input.getError().message() << '\n';
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::unique_ptr<BatchWorker>> workers;
+  for (unsigned i = 0, e = std::max(1u, unsigned(NumThreads)); i != e; ++i)
+    workers.emplace_back(new BatchWorker(options));
+  demangleBatch(llvm::outs(), input.get()->getBuffer(), workers);
+  return EXIT_SUCCESS;
+}
+
+static int readSymbolsFromSTDIN(std::vector<std::string> &symbols) {
+  llvm::Regex maybeSymbol("_T[_a-zA-Z0-9$]+");
+
+  auto input = llvm::MemoryBuffer::getSTDIN();
+  if (!input) {
+    llvm::errs() << "error: cannot read stdin: " << input.getError().message()
+                 << '\n';
+    return EXIT_FAILURE;
+  }
+
+  llvm::StringRef inputContents = input.get()->getBuffer();
+  llvm::SmallVector<llvm::StringRef, 1> matches;
+  while (maybeSymbol.match(inputContents, &matches)) {
+    symbols.push_back(matches.front());
+    inputContents = substrAfter(inputContents, matches.front());
+  }
+  return EXIT_SUCCESS;
+}
+
+/// Demangles \p symbols \p iterations times, once with a fresh allocation for
+/// every node, once with a reused demangling context and once in batch mode,
+/// and reports the throughput of each.
+static int benchmark(llvm::ArrayRef<std::string> symbols, unsigned iterations,
+                     const swift::Demangle::DemangleOptions &options) {
+  typedef std::chrono::steady_clock Clock;
+
+  auto report = [&](llvm::StringRef label, double seconds) {
+    double count = double(symbols.size()) * iterations;
+    llvm::outs() << "  " << label << ": ";
+    llvm::outs().indent(16 - label.size());
+    llvm::outs() << llvm::format("%.3fs (%.0f symbols/s)\n", seconds,
+                                 seconds > 0 ? count / seconds : 0.0);
+  };
+
+  // Runs \p demangle on every symbol and stores the results of the last
+  // iteration in \p results.
+  auto run = [&](llvm::StringRef label,
+                 std::function<std::string(llvm::StringRef)> demangle,
+                 std::vector<std::string> &results) {
+    results.resize(symbols.size());
+    auto start = Clock::now();
+    for (unsigned i = 0; i < iterations; ++i) {
+      for (size_t j = 0, e = symbols.size(); j != e; ++j)
+        results[j] = demangle(symbols[j]);
+    }
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+    report(label, elapsed.count());
+  };
+
+  llvm::outs() << "Demangled " << symbols.size() << " symbols x "
+               << iterations << " iterations:\n";
+
+  std::vector<std::string> oneShotResults;
+  run("one-shot", [&](llvm::StringRef symbol) {
+    return swift::Demangle::demangleSymbolAsString(symbol.data(),
+                                                   symbol.size(), options);
+  }, oneShotResults);
+
+  swift::Demangle::Context ctx;
+  std::vector<std::string> contextResults;
+  run("reused context", [&](llvm::StringRef symbol) {
+    return ctx.demangleSymbolAsString(symbol, options);
+  }, contextResults);
+
+  for (size_t i = 0, e = symbols.size(); i != e; ++i) {
+    if (oneShotResults[i] == contextResults[i])
+      continue;
+    llvm::errs() << "error: demangling " << symbols[i]
+                 << " with a context produced different results:\n"
+                 << "  one-shot:       " << oneShotResults[i] << '\n'
+                 << "  reused context: " << contextResults[i] << '\n';
+    return EXIT_FAILURE;
+  }
+
+  // Batch mode, on the symbols as lines of text.
+  std::string text;
+  for (llvm::StringRef symbol : symbols) {
+    text += symbol;
+    text += '\n';
+  }
+  std::vector<std::unique_ptr<BatchWorker>> workers;
+  for (unsigned i = 0, e = std::max(1u, unsigned(NumThreads)); i != e; ++i)
+    workers.emplace_back(new BatchWorker(options));
+  std::string label = "batch (-j " + std::to_string(workers.size()) + ")";
+  auto start = Clock::now();
+  for (unsigned i = 0; i < iterations; ++i) {
+    llvm::raw_null_ostream os;
+    demangleBatch(os, text, workers);
+  }
+  std::chrono::duration<double> elapsed = Clock::now() - start;
+  report(label, elapsed.count());
+  return EXIT_SUCCESS;
+}
+
 int main(int argc, char **argv) {
 #if defined(__CYGWIN__)
   // Cygwin clang 3.5.2 with '-O3' generates CRASHING BINARY,
@@ -145,12 +374,23 @@ int main(int argc, char **argv) {
   if (Simplified)
     options = swift::Demangle::DemangleOptions::SimplifiedUIDemangleOptions();
 
+  if (BenchmarkIterations) {
+    std::vector<std::string> symbols(InputNames.begin(), InputNames.end());
+    if (symbols.empty())
+      if (int result = readSymbolsFromSTDIN(symbols))
+        return result;
+    return benchmark(symbols, BenchmarkIterations, options);
+  }
+
   if (InputNames.empty()) {
     CompactMode = true;
+    if (NumThreads > 1 || !InputFilename.empty())
+      return demangleInputBatch(options);
     return demangleSTDIN(options);
   } else {
+    swift::Demangle::Context ctx;
     for (llvm::StringRef name : InputNames) {
-      demangle(llvm::outs(), name, options);
+      demangle(llvm::outs(), name, ctx, options);
       llvm::outs() << '\n';
     }
 
@@ -0,0 +1,132 @@
+//===--- swift-lexer-bench.cpp - Lexer throughput benchmark ---------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures the throughput of the lexer over a corpus of Swift source files.
+//
+// Each file is lexed repeatedly without a diagnostic engine, the way the
+// parser drives the lexer. The tool reports the bytes and tokens per second
+// for the whole corpus.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/LangOptions.h"
+#include "swift/Basic/SourceManager.h"
+#include "swift/Parse/Lexer.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/LineIterator.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <string>
+#include <vector>
+
+using namespace swift;
+
+static llvm::cl::list<std::string>
+InputNames(llvm::cl::Positional, llvm::cl::desc("<input files...>"),
+           llvm::cl::ZeroOrMore);
+
+static llvm::cl::opt<std::string>
+FileList("filelist",
+         llvm::cl::desc("File containing the list of input files"));
+
+static llvm::cl::opt<unsigned>
+Iterations("iterations", llvm::cl::desc("Number of times each file is lexed"),
+           llvm::cl::init(10));
+
+static llvm::cl::opt<bool>
+KeepComments("keep-comments",
+             llvm::cl::desc("Return comments as tokens"));
+
+/// Lex the whole buffer and return the number of tokens.
+static unsigned lexBuffer(const LangOptions &LangOpts,
+                          const SourceManager &SM, unsigned BufferID) {
+  Lexer L(LangOpts, SM, BufferID, /*Diags=*/nullptr, /*InSILMode=*/false,
+          KeepComments ? CommentRetentionMode::ReturnAsTokens
+                       : CommentRetentionMode::None);
+  unsigned NumTokens = 0;
+  Token Tok;
+  do {
+    L.lex(Tok);
+    ++NumTokens;
+  } while (Tok.isNot(tok::eof));
+  return NumTokens;
+}
+
+int main(int argc, char **argv) {
+  llvm::sys::PrintStackTraceOnErrorSignal(argv[0]);
+  llvm::PrettyStackTraceProgram X(argc, argv);
+  llvm::cl::ParseCommandLineOptions(argc, argv, "Swift lexer benchmark\n");
+
+  std::vector<std::string> Inputs(InputNames.begin(), InputNames.end());
+  if (!FileList.empty()) {
+    auto ListOrErr = llvm::MemoryBuffer::getFile(FileList);
+    if (!ListOrErr) {
+      llvm::errs() << "error: cannot open '" << FileList
+                   << "': " << ListOrErr.getError().message() << '\n';
+      return 1;
+    }
+    for (llvm::line_iterator I(*ListOrErr.get()), E; I != E; ++I)
+      Inputs.push_back(*I);
+  }
+  if (Inputs.empty()) {
+    llvm::errs() << "error: no input files\n";
+    return 1;
+  }
+
+  LangOptions LangOpts;
+  SourceManager SM;
+  std::vector<unsigned> BufferIDs;
+  uint64_t TotalBytes = 0;
+  for (auto &Input : Inputs) {
+    auto BufferOrErr = llvm::MemoryBuffer::getFile(Input);
+    if (!BufferOrErr) {
+      llvm::errs() << "error: cannot open '" << Input
+                   << "': " << BufferOrErr.getError().message() << '\n';
+      return 1;
+    }
+    TotalBytes += BufferOrErr.get()->getBufferSize();
+    BufferIDs.push_back(SM.addNewSourceBuffer(std::move(BufferOrErr.get())));
+  }
+
+  // Lex everything once to warm up the caches and to count the tokens.
+  uint64_t TotalTokens = 0;
+  for (unsigned BufferID : BufferIDs)
+    TotalTokens += lexBuffer(LangOpts, SM, BufferID);
+
+  llvm::TimeRecord Start = llvm::TimeRecord::getCurrentTime(/*Start=*/true);
+  for (unsigned i = 0; i < Iterations; ++i) {
+    for (unsigned BufferID : BufferIDs)
+      lexBuffer(LangOpts, SM, BufferID);
+  }
+  llvm::TimeRecord End = llvm::TimeRecord::getCurrentTime(/*Start=*/false);
+  double Seconds = End.getWallTime() - Start.getWallTime();
+  if (Seconds <= 0)
+    Seconds = 1e-9;
+
+  double MBytes = double(TotalBytes) * Iterations / (1024 * 1024);
+  double MTokens = double(TotalTokens) * Iterations / 1e6;
+  llvm::outs() << "files:      " << BufferIDs.size() << '\n'
+               << "bytes:      " << TotalBytes << '\n'
+               << "tokens:     " << TotalTokens << '\n'
+               << "iterations: " << Iterations << '\n'
+               << "time:       " << llvm::format("%.3f s", Seconds) << '\n'
+               << "throughput: " << llvm::format("%.1f MB/s", MBytes / Seconds)
+               << ", " << llvm::format("%.2f Mtokens/s", MTokens / Seconds)
+               << '\n';
+  return 0;
+}
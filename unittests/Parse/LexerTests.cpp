@@ -111,6 +111,60 @@ TEST_F(LexerTest, StringLiteralWithNUL1) {
   EXPECT_EQ(Toks[1].getLength(), 0U);
 }
 
+// The following tests use tokens which are longer than 16 bytes, so that the
+// delimiters are found by the block-wise scanning.
+
+TEST_F(LexerTest, LongComments) {
+  const char *Source =
+      "// a line comment which is longer than a block\n"
+      "a /* outer block comment /* nested comment which is long */ */ b\n"
+      "/* comment with a non-ASCII character after 16 bytes: \u00e9 */ c";
+  std::vector<tok> ExpectedTokens{
+    tok::comment, tok::identifier, tok::comment, tok::identifier,
+    tok::comment, tok::identifier
+  };
+  std::vector<Token> Toks = checkLex(Source, ExpectedTokens,
+                                     /*KeepComments=*/true);
+  EXPECT_EQ("a", Toks[1].getText());
+  EXPECT_TRUE(Toks[1].isAtStartOfLine());
+  EXPECT_EQ("b", Toks[3].getText());
+  EXPECT_TRUE(Toks[4].isAtStartOfLine());
+  EXPECT_EQ("c", Toks[5].getText());
+}
+
+TEST_F(LexerTest, LongStringLiterals) {
+  const char *Source =
+      "\"a string literal which is longer than a block\" "
+      "\"an escaped \\\" quote and an escaped \\\\ backslash\" "
+      "\"a non-ASCII character after more than 16 bytes: \u00e9\"";
+  std::vector<tok> ExpectedTokens{
+    tok::string_literal, tok::string_literal, tok::string_literal
+  };
+  std::vector<Token> Toks = checkLex(Source, ExpectedTokens);
+  EXPECT_EQ(47U, Toks[0].getLength());
+}
+
+TEST_F(LexerTest, LongStringLiteralWithNewline) {
+  const char *Source = "\"a string literal which is broken\nafter";
+  std::vector<tok> ExpectedTokens{ tok::unknown, tok::identifier };
+  std::vector<Token> Toks = checkLex(Source, ExpectedTokens);
+  EXPECT_EQ(33U, Toks[0].getLength());
+}
+
+TEST_F(LexerTest, LongIdentifiers) {
+  const char *Source =
+      "an_identifier_which_is_longer_than_a_block "
+      "an_identifier_with_a_dollar_sign$inside "
+      "identifier_with_non_ASCII_character_\u00e9_in_it+";
+  std::vector<tok> ExpectedTokens{
+    tok::identifier, tok::identifier, tok::identifier, tok::oper_postfix
+  };
+  std::vector<Token> Toks = checkLex(Source, ExpectedTokens);
+  EXPECT_EQ("an_identifier_which_is_longer_than_a_block", Toks[0].getText());
+  EXPECT_EQ("identifier_with_non_ASCII_character_\u00e9_in_it",
+            Toks[2].getText());
+}
+
 TEST_F(LexerTest, RestoreBasic) {
   const char *Source = "aaa \t\0 bbb ccc";
 
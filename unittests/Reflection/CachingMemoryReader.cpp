@@ -0,0 +1,151 @@
+//===--- CachingMemoryReader.cpp - CachingMemoryReader tests --------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Remote/CachingMemoryReader.h"
+#include "gtest/gtest.h"
+
+using namespace swift;
+using namespace remote;
+
+namespace {
+
+/// A MemoryReader over a buffer at a fake address, which counts the reads
+/// that reach it.
+class BufferMemoryReader final : public MemoryReader {
+  const uint64_t Base;
+  std::vector<uint8_t> Buffer;
+
+public:
+  unsigned NumReads = 0;
+
+  BufferMemoryReader(uint64_t base, std::vector<uint8_t> buffer)
+    : Base(base), Buffer(std::move(buffer)) {}
+
+  uint8_t getPointerSize() override { return sizeof(void *); }
+  uint8_t getSizeSize() override { return sizeof(size_t); }
+
+  RemoteAddress getSymbolAddress(const std::string &name) override {
+    return RemoteAddress(nullptr);
+  }
+
+  bool readBytes(RemoteAddress address, uint8_t *dest,
+                 uint64_t size) override {
+    ++NumReads;
+    uint64_t addr = address.getAddressData();
+    if (addr < Base || addr + size > Base + Buffer.size())
+      return false;
+    std::memcpy(dest, Buffer.data() + (addr - Base), size);
+    return true;
+  }
+
+  bool readString(RemoteAddress address, std::string &dest) override {
+    ++NumReads;
+    uint64_t addr = address.getAddressData();
+    if (addr < Base || addr >= Base + Buffer.size())
+      return false;
+    auto begin = Buffer.begin() + (addr - Base);
+    auto nul = std::find(begin, Buffer.end(), 0);
+    if (nul == Buffer.end())
+      return false;
+    dest.assign(begin, nul);
+    return true;
+  }
+};
+
+} // end anonymous namespace
+
+static std::vector<uint8_t> makeBuffer(size_t size) {
+  std::vector<uint8_t> buffer(size);
+  for (size_t i = 0; i < size; ++i)
+    buffer[i] = uint8_t(i % 251) + 1;
+  return buffer;
+}
+
+TEST(CachingMemoryReaderTest, ReadsEachBlockOnce) {
+  auto underlying = std::make_shared<BufferMemoryReader>(0x1000,
+                                                         makeBuffer(0x400));
+  CachingMemoryReader reader(underlying, /*blockSize=*/0x100);
+
+  uint8_t bytes[0x10];
+  for (unsigned i = 0; i < 4; ++i) {
+    EXPECT_TRUE(reader.readBytes(RemoteAddress(uint64_t(0x1010 + i * 0x10)),
+                                 bytes, sizeof(bytes)));
+    EXPECT_EQ(bytes[0], uint8_t((0x10 + i * 0x10) % 251) + 1);
+  }
+  EXPECT_EQ(underlying->NumReads, 1U);
+  EXPECT_EQ(reader.getNumHits(), 3U);
+  EXPECT_EQ(reader.getNumMisses(), 1U);
+
+  // A read that crosses into the next block reads just that block.
+  EXPECT_TRUE(reader.readBytes(RemoteAddress(uint64_t(0x10F8)),
+                               bytes, sizeof(bytes)));
+  EXPECT_EQ(bytes[0], uint8_t(0xF8 % 251) + 1);
+  EXPECT_EQ(bytes[8], uint8_t(0x100 % 251) + 1);
+  EXPECT_EQ(underlying->NumReads, 2U);
+
+  reader.clear();
+  EXPECT_TRUE(reader.readBytes(RemoteAddress(uint64_t(0x1010)),
+                               bytes, sizeof(bytes)));
+  EXPECT_EQ(underlying->NumReads, 3U);
+}
+
+TEST(CachingMemoryReaderTest, EvictsLeastRecentlyUsedBlock) {
+  auto underlying = std::make_shared<BufferMemoryReader>(0x1000,
+                                                         makeBuffer(0x400));
+  CachingMemoryReader reader(underlying, /*blockSize=*/0x100,
+                             /*maxBlocks=*/2);
+
+  uint8_t byte;
+  EXPECT_TRUE(reader.readBytes(RemoteAddress(uint64_t(0x1000)), &byte, 1));
+  EXPECT_TRUE(reader.readBytes(RemoteAddress(uint64_t(0x1100)), &byte, 1));
+  EXPECT_TRUE(reader.readBytes(RemoteAddress(uint64_t(0x1000)), &byte, 1));
+  EXPECT_TRUE(reader.readBytes(RemoteAddress(uint64_t(0x1200)), &byte, 1));
+  EXPECT_EQ(underlying->NumReads, 3U);
+
+  // 0x1100 was evicted; 0x1000 was not.
+  EXPECT_TRUE(reader.readBytes(RemoteAddress(uint64_t(0x1000)), &byte, 1));
+  EXPECT_EQ(underlying->NumReads, 3U);
+  EXPECT_TRUE(reader.readBytes(RemoteAddress(uint64_t(0x1100)), &byte, 1));
+  EXPECT_EQ(underlying->NumReads, 4U);
+}
+
+TEST(CachingMemoryReaderTest, ReadsPartialBlocksDirectly) {
+  // The buffer ends halfway through its second block.
+  auto underlying = std::make_shared<BufferMemoryReader>(0x1000,
+                                                         makeBuffer(0x180));
+  CachingMemoryReader reader(underlying, /*blockSize=*/0x100);
+
+  uint8_t bytes[0x10];
+  EXPECT_TRUE(reader.readBytes(RemoteAddress(uint64_t(0x1170)),
+                               bytes, sizeof(bytes)));
+  EXPECT_EQ(bytes[0], uint8_t(0x170 % 251) + 1);
+  EXPECT_FALSE(reader.readBytes(RemoteAddress(uint64_t(0x1178)),
+                                bytes, sizeof(bytes)));
+}
+
+TEST(CachingMemoryReaderTest, ReadsStringsAcrossBlocks) {
+  auto buffer = makeBuffer(0x400);
+  buffer[0x120] = 0;
+  buffer[0x3F0] = 0;
+  auto underlying = std::make_shared<BufferMemoryReader>(0x1000, buffer);
+  CachingMemoryReader reader(underlying, /*blockSize=*/0x100);
+
+  std::string string;
+  EXPECT_TRUE(reader.readString(RemoteAddress(uint64_t(0x10F0)), string));
+  EXPECT_EQ(string.size(), 0x30U);
+  EXPECT_EQ(uint8_t(string[0]), uint8_t(0xF0 % 251) + 1);
+  EXPECT_EQ(underlying->NumReads, 2U);
+
+  EXPECT_TRUE(reader.readString(RemoteAddress(uint64_t(0x1110)), string));
+  EXPECT_EQ(string.size(), 0x10U);
+  EXPECT_EQ(underlying->NumReads, 2U);
+}
@@ -43,3 +43,48 @@ TEST(EditableTextBuffer, Updates) {
 
   EXPECT_EQ(Buf->getFilename(), "/a/test");
 }
+
+TEST(EditableTextBuffer, TypingSession) {
+  std::string Expected;
+  for (unsigned I = 0; I != 20000; ++I)
+    Expected += "let value = compute(x, y) // line\n";
+
+  EditableTextBufferManager BufMgr;
+  EditableTextBufferRef EdBuf = BufMgr.getOrCreateBuffer("/a/test", Expected);
+
+  // Type a word in the middle of the file and take a snapshot after every
+  // keystroke, the way the editor does.
+  unsigned Offset = Expected.size() / 2;
+  ImmutableTextSnapshotRef First = EdBuf->getSnapshot();
+  for (char C : StringRef("print(value)")) {
+    EdBuf->insert(Offset, StringRef(&C, 1));
+    Expected.insert(Offset, 1, C);
+    ++Offset;
+    EXPECT_EQ(EdBuf->getBuffer()->getText(), Expected);
+  }
+  // ...then delete it again.
+  for (unsigned I = 0; I != 12; ++I) {
+    --Offset;
+    EdBuf->erase(Offset, 1);
+    Expected.erase(Offset, 1);
+  }
+  EXPECT_EQ(EdBuf->getBuffer()->getText(), Expected);
+
+  // Older snapshots still see their own text.
+  EXPECT_EQ(First->getBuffer()->getText(), Expected);
+  EXPECT_TRUE(First->precedesOrSame(EdBuf->getSnapshot()));
+}
+
+TEST(ImmutableTextBuffer, LineAndColumn) {
+  ImmutableTextBufferRef Buf =
+      new ImmutableTextBuffer("/a/test", "ab\ncd\r\nef", /*Stamp=*/0);
+
+  EXPECT_EQ(Buf->getLineAndColumn(0), std::make_pair(1u, 1u));
+  EXPECT_EQ(Buf->getLineAndColumn(2), std::make_pair(1u, 3u));
+  EXPECT_EQ(Buf->getLineAndColumn(3), std::make_pair(2u, 1u));
+  EXPECT_EQ(Buf->getLineAndColumn(6), std::make_pair(2u, 1u));
+  EXPECT_EQ(Buf->getLineAndColumn(7), std::make_pair(3u, 1u));
+  EXPECT_EQ(Buf->getLineAndColumn(8), std::make_pair(3u, 2u));
+  EXPECT_EQ(Buf->getLineAndColumn(9), std::make_pair(3u, 3u));
+  EXPECT_EQ(Buf->getLineAndColumn(10), std::make_pair(0u, 0u));
+}
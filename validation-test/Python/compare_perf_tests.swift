@@ -0,0 +1 @@
+// RUN: %{python} -m unittest discover -s %utils/../benchmark/scripts